@@ -0,0 +1,227 @@
+#ifndef AIRDATA_H
+#define AIRDATA_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include "simdfloat4.h"
+#include "telemetrysample.h"
+#include "telemetrysnapshot.h"
+
+// Air data derived from one vehicle's sample stream, once per sample on the
+// way to the display, so paint functions only read the results from
+// TelemetrySnapshot: the altitude at the QNH set, density altitude, vertical
+// speed, turn rate and the QNH in both units.
+//
+// The altitude a sample carries is taken as pressure altitude, what an
+// altimeter set to 1013.25 hPa reads. Under the ISA troposphere the altitude
+// at any other setting is an affine function of it, one multiply-add per
+// sample; density altitude costs one power per sample. Both hold up to the
+// tropopause, 36,089 ft. Vertical speed and turn rate are the difference
+// quotients of the stream, low-passed.
+//
+// addBatch() runs whole arrays four samples to a SIMD register, for replays
+// and analysis of long logs; add() is the same arithmetic one sample at a time.
+class AirData {
+public:
+    // ISA sea level and troposphere; lengths in feet
+    static constexpr double seaLevelPressureHpa = 1013.25;
+    static constexpr double seaLevelTemperatureK = 288.15;
+    static constexpr double kelvinAtZeroCelsius = 273.15;
+    static constexpr double lapseRatePerFoot = 0.0065 * 0.3048;  // K
+    static constexpr double scaleHeight = seaLevelTemperatureK / lapseRatePerFoot;  // 145,442 ft
+    static constexpr double pressureExponent = 0.190263;  // R * lapse rate / g0
+    static constexpr double hpaPerInHg = 33.8638866667;
+
+    // Time constants of the derivatives' low-pass
+    static constexpr float verticalSpeedSmoothingSeconds = 1.0f;
+    static constexpr float turnRateSmoothingSeconds = 0.5f;
+
+    // Longer gaps restart a derivative rather than spanning it
+    static constexpr float maxGapSeconds = 1.0f;
+
+    struct Values {
+        float baroAltitude = 0.0f;     // feet, at the QNH set
+        float densityAltitude = 0.0f;  // feet, at the OAT set
+        float verticalSpeed = 0.0f;    // feet per minute, climb positive
+        float turnRate = 0.0f;         // degrees per second, clockwise positive
+    };
+
+    AirData() { updateCoefficients(); }
+
+    // Altimeter setting; the unit conversion is done here, once
+    void setQnhInHg(float inHg) { setQnhHpa(static_cast<float>(inHg * hpaPerInHg)); }
+
+    void setQnhHpa(float hpa) {
+        if (hpa == qnh || !(hpa > 0.0f)) return;
+        qnh = hpa;
+        updateCoefficients();
+    }
+
+    float qnhHpa() const { return qnh; }
+    float qnhInHg() const { return static_cast<float>(qnh / hpaPerInHg); }
+
+    void setOutsideAirTemperature(float celsius) {
+        if (celsius == oat || !(celsius > -kelvinAtZeroCelsius)) return;
+        oat = celsius;
+        updateCoefficients();
+    }
+
+    float outsideAirTemperature() const { return oat; }
+
+    // Off runs addBatch() through the portable kernel, for bench/airdata_bench.cpp
+    void setVectorized(bool enabled) { vectorized = enabled; }
+
+    // The sender's clock when the sample carries it, arrival time otherwise
+    static std::int64_t sampleTimeNs(const TelemetrySample &sample) {
+        return sample.sensorTimeMs ? sample.sensorTimeMs * std::int64_t(1'000'000) : sample.timestampNs;
+    }
+
+    // Whatever of altitude and heading the sample carries
+    void add(const TelemetrySample &sample) {
+        const float none = std::numeric_limits<float>::quiet_NaN();
+        float heading = none;
+        if (sample.has(HORUS_FIELD_HEADING)) heading = sample.heading;
+        else if (sample.has(HORUS_FIELD_FUSED)) heading = sample.yaw;
+        add(sampleTimeNs(sample), sample.has(HORUS_FIELD_ALTITUDE) ? sample.altitude : none, heading);
+    }
+
+    // NaN for a value this sample does not have
+    void add(std::int64_t timeNs, float pressureAltitude, float heading) {
+        differentiate(altitudeRate, timeNs, pressureAltitude, 60.0f, verticalSpeedSmoothingSeconds, false);
+        differentiate(headingRate, timeNs, heading, 1.0f, turnRateSmoothingSeconds, true);
+        updateValues();
+    }
+
+    // count samples in time order, as arrays, NaN where a sample has no
+    // altitude or heading. Derived values go to the output arrays, NaN
+    // where there was no altitude. The derivatives carry on from the
+    // previous call, so a log can go through in chunks.
+    void addBatch(const std::int64_t *timeNs, const float *pressureAltitude, const float *heading, std::size_t count,
+                  float *baroAltitude, float *densityAltitude, float *verticalSpeed, float *turnRate) {
+        std::size_t i = 0;
+        if (vectorized) {
+            for (; i + 4 <= count; i += 4) {
+                altitudes<SimdFloat4>(pressureAltitude + i, baroAltitude + i, densityAltitude + i);
+            }
+        }
+        for (; i < count; i += 4) {
+            const std::size_t lanes = std::min<std::size_t>(4, count - i);
+            float in[4] = {}, baro[4], density[4];
+            std::copy(pressureAltitude + i, pressureAltitude + i + lanes, in);
+            altitudes<ScalarFloat4>(in, baro, density);
+            std::copy(baro, baro + lanes, baroAltitude + i);
+            std::copy(density, density + lanes, densityAltitude + i);
+        }
+
+        // Each derivative depends on the one before: sample by sample
+        for (i = 0; i < count; i++) {
+            differentiate(altitudeRate, timeNs[i], pressureAltitude[i], 60.0f, verticalSpeedSmoothingSeconds, false);
+            differentiate(headingRate, timeNs[i], heading[i], 1.0f, turnRateSmoothingSeconds, true);
+            verticalSpeed[i] = altitudeRate.rate;
+            turnRate[i] = headingRate.rate;
+        }
+        updateValues();
+    }
+
+    // For the newest altitude and heading added
+    const Values &values() const { return latest; }
+
+    // Hands the results to the PFD
+    void fill(TelemetrySnapshot &t) const {
+        t.qnh = qnhInHg();
+        t.qnhHpa = qnh;
+        t.oat = oat;
+        t.baroAltitude = latest.baroAltitude;
+        t.densityAltitude = latest.densityAltitude;
+        t.verticalSpeed = latest.verticalSpeed;
+        t.turnRate = latest.turnRate;
+    }
+
+    // Forgets the stream, e.g. for another vehicle; the settings stay
+    void reset() {
+        altitudeRate = Derivative();
+        headingRate = Derivative();
+        updateValues();
+    }
+
+private:
+    struct Derivative {
+        bool started = false;
+        std::int64_t timeNs = 0;
+        float value = 0.0f;
+        float rate = 0.0f;  // Low-passed, per second times the channel's scale
+    };
+
+    // Per-setting constants of the per-sample formulas, in double once so
+    // the kernels need no more than float:
+    //   baro     = baroScale * pa + baroOffset, baroScale = (p0 / QNH)^k
+    //   density  = H - densityScale * theta^(1 / (1 - k)), theta = 1 - pa / H,
+    //              densityScale = H * (T0 / T)^(k / (1 - k))
+    // with H the scale height and k the pressure exponent
+    void updateCoefficients() {
+        const double scale = std::pow(seaLevelPressureHpa / qnh, pressureExponent);
+        baroScale = static_cast<float>(scale);
+        baroOffset = static_cast<float>(scaleHeight * (1.0 - scale));
+        const double temperatureRatio = seaLevelTemperatureK / (oat + kelvinAtZeroCelsius);
+        densityScale = static_cast<float>(scaleHeight * std::pow(temperatureRatio, pressureExponent / (1.0 - pressureExponent)));
+        updateValues();
+    }
+
+    template <typename F>
+    void altitudes(const float *pressureAltitude, float *baroAltitude, float *densityAltitude) const {
+        const F altitude = F::load(pressureAltitude);
+        (F(baroScale) * altitude + F(baroOffset)).store(baroAltitude);
+
+        F theta = F(1.0f) - altitude * F(static_cast<float>(1.0 / scaleHeight));
+        theta = selectPositive(theta - F(0.01f), theta, F(0.01f));  // Past 143,000 ft the model is long gone
+        const F power = laneExp2(F(static_cast<float>(1.0 / (1.0 - pressureExponent))) * laneLog2(theta));
+        const F density = F(static_cast<float>(scaleHeight)) - F(densityScale) * power;
+        // The power of a NaN is not NaN; adding altitude - altitude makes it one
+        (density + (altitude - altitude)).store(densityAltitude);
+    }
+
+    // First-order low-pass over the difference quotient. Heading differences
+    // are taken the short way round.
+    static void differentiate(Derivative &d, std::int64_t timeNs, float value, float scale, float smoothingSeconds,
+                              bool degrees) {
+        if (std::isnan(value)) return;
+        if (d.started) {
+            const float dt = (timeNs - d.timeNs) / 1e9f;
+            if (dt <= 0.0f) return;  // Same instant or out of order: the earlier sample stands
+            if (dt <= maxGapSeconds) {
+                float delta = value - d.value;
+                if (degrees) delta = std::remainder(delta, 360.0f);
+                d.rate += (delta / dt * scale - d.rate) * (dt / (smoothingSeconds + dt));
+            } else {
+                d.rate = 0.0f;
+            }
+        }
+        d.started = true;
+        d.timeNs = timeNs;
+        d.value = value;
+    }
+
+    void updateValues() {
+        float in[4] = {altitudeRate.value}, baro[4], density[4];
+        altitudes<ScalarFloat4>(in, baro, density);
+        latest.baroAltitude = baro[0];
+        latest.densityAltitude = density[0];
+        latest.verticalSpeed = altitudeRate.rate;
+        latest.turnRate = headingRate.rate;
+    }
+
+    float qnh = static_cast<float>(seaLevelPressureHpa);
+    float oat = 15.0f;
+    float baroScale = 1.0f;
+    float baroOffset = 0.0f;
+    float densityScale = static_cast<float>(scaleHeight);
+    bool vectorized = true;
+    Derivative altitudeRate;
+    Derivative headingRate;
+    Values latest;
+};
+
+#endif // AIRDATA_H
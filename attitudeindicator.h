@@ -4,92 +4,346 @@
 #include <QWidget>
 #include <QPainter>
 #include <QPaintEvent>
+#include <QResizeEvent>
 #include <QPainterPath>
+#include <QImage>
+#include <QPixmap>
+#include <QEvent>
+#include <QtMath>
+#include <QFontMetricsF>
+#include <QRegion>
+#include <QTransform>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThreadPool>
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include "frametimegovernor.h"
+#include "glyphatlas.h"
+#include "latencystats.h"
+#include "tape.h"
+#include "telemetrysnapshot.h"
 
 class AttitudeIndicator : public QWidget {
     Q_OBJECT
 
 public:
     explicit AttitudeIndicator(QWidget *parent = nullptr)
-    : QWidget(parent), pitch(0.0f), roll(0.0f),
+    : QWidget(parent),
       customFontFamily("Courier"), nimbusMono("Arial") {
         setMinimumSize(1000, 1000);
+        resolveFonts();
+
+        registerInstruments();
+        layoutInstruments();
+        instrumentClock.start();
+        throttleTimer.setSingleShot(true);
+        connect(&throttleTimer, &QTimer::timeout, this, &AttitudeIndicator::refreshInstruments);
     }
 
 
-    void setAttitude(float pitchDeg, float rollDeg, float altFt, float speedKts, float headingDeg,float qnhVal, std::string fltMode, std::string timeCurr, const int rpmVal[4], float batteryStateVal, float batteryLevelVal,int propQuantityVal, float
-        oatVal) {
-        pitch = -pitchDeg;
-        roll = rollDeg;
-        altitude = altFt;
-        speed = speedKts;
-        heading = headingDeg;
-        flightMode = fltMode;
-        currTime = timeCurr;
-        batteryLevel = batteryLevelVal;
-        QNH = qnhVal;
-        OAT = oatVal;
-        for (int i = 0; i < 4; i++) {
-            rpm[i] = rpmVal[i];
+    // Repaints only the instruments that would render differently at the
+    // current size and pixel density; see registerInstruments().
+    void setTelemetry(const TelemetrySnapshot &next) {
+        if (next.flightMode != telemetry.flightMode) {
+            flightModeText.setText(QString::fromStdString(next.flightMode));
+            flightModeRevision++;
+        }
+        if (next.propQuantity != telemetry.propQuantity) {
+            staticLayerDirty = true;  // Gauge arcs and labels are static
+            update();
         }
-        batteryState = batteryStateVal;
-        propQuantity = propQuantityVal;
-        update(); // Trigger repaint
+        telemetry = next;  // Strings reuse their capacity
+        refreshInstruments();
+    }
+
+    // Paint completion of each new sample is recorded here; nullptr to stop
+    void setLatencyStats(LatencyStats *stats) {
+        latencyStats = stats;
+    }
+
+    void setLatencyOverlayVisible(bool visible) {
+        latencyOverlayVisible = visible;
+        refreshInstruments();
+    }
+
+    bool isLatencyOverlayVisible() const { return latencyOverlayVisible; }
+
+    // Off trades edge quality for fill rate on weak GPUs and software rendering.
+    // Glyph atlases stay antialiased.
+    void setAntialiasing(bool enabled) {
+        if (antialiasing == enabled) return;
+        antialiasing = enabled;
+        staticLayerDirty = true;
+        ladderStripDirty = true;
+        invalidateTiles();
+        update();
+    }
+
+    // Off paints every instrument straight onto the widget on the GUI thread,
+    // as a baseline for bench/render_bench.cpp; see renderTiles()
+    void setParallelRendering(bool enabled) {
+        if (parallelRendering == enabled) return;
+        parallelRendering = enabled;
+        invalidateTiles();
+        update();
+    }
+
+    bool isParallelRendering() const { return parallelRendering; }
+
+    // Render quality follows paint time against this rate's frame budget;
+    // see FrameTimeGovernor. Holding back low-priority instruments needs tiles.
+    void setTargetFrameRate(double hz) { governor.setTargetFrameRate(hz); }
+
+    // Off holds the current quality level
+    void setAdaptiveQuality(bool enabled) { governor.setAdaptive(enabled); }
+
+    void setRenderQuality(FrameTimeGovernor::Quality quality) {
+        governor.setQuality(quality);
+        applyRenderQuality();
+    }
+
+    const FrameTimeGovernor &frameTimeGovernor() const { return governor; }
+
+    // Instruments in paint order, for profiling one at a time (bench/render_bench.cpp)
+    int instrumentCount() const { return static_cast<int>(instruments.size()); }
+    const char *instrumentName(int index) const { return instruments[index].name; }
+
+    // Paints a single instrument into painter exactly as paintEvent() would
+    void renderInstrument(QPainter &painter, int index) {
+        warmUp();
+        painter.save();
+        painter.setRenderHint(QPainter::Antialiasing, antialiasing);
+        applyViewport(painter);
+        (this->*instruments[index].draw)(painter);
+        painter.restore();
     }
 
     void setCustomFonts(const QString &font1, const QString &font2) {
         customFontFamily = font1;
         nimbusMono = font2;
+        resolveFonts();
+        staticLayerDirty = true;
+        ladderStripDirty = true;
+        textCacheDirty = true;
+        invalidateTiles();
         update();
     }
 
+    // Builds the glyph atlases, static layer and ladder strip the next
+    // paintEvent() would otherwise build, e.g. right after setCustomFonts(),
+    // so no frame pays for them. GUI thread, between frames.
+    void warmUp() {
+        ensureStaticLayer();
+        ensureTextCache();
+        ensureLadderStrip();
+    }
+
+signals:
+    // Once, when the first paintEvent() finishes; paintedNs on monotonicNowNs()
+    void firstFramePainted(qint64 paintedNs);
 
 protected:
     float zoom = 6.0f;
     void paintEvent(QPaintEvent *event) override {
-        Q_UNUSED(event);
+        const std::int64_t paintStartNs = monotonicNowNs();
+        warmUp();
 
         QPainter painter(this);
-        painter.setRenderHint(QPainter::Antialiasing);
-        // Fill entire widget with black
-        painter.fillRect(rect(), Qt::black);
+        painter.setRenderHint(QPainter::Antialiasing, antialiasing);
+        const QRegion &dirty = event->region();
+
+        if (parallelRendering) {
+            renderTiles(dirty);
+
+            // The horizon tile is opaque and normally covers the whole widget
+            if (!instruments.front().region.contains(event->rect())) {
+                painter.fillRect(event->rect(), Qt::black);
+            }
+            // Tiles composite in paint order, in widget pixels
+            for (const Instrument &instrument : instruments) {
+                if (!dirty.intersects(instrument.region)) continue;
+                if (instrument.key) {
+                    // The opaque bottom tile is copied rather than blended
+                    const bool bottom = &instrument == &instruments.front();
+                    if (bottom) painter.setCompositionMode(QPainter::CompositionMode_Source);
+                    painter.drawImage(instrument.region.topLeft(), instrument.tile);
+                    if (bottom) painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+                } else {
+                    painter.save();
+                    applyViewport(painter);
+                    (this->*instrument.draw)(painter);
+                    painter.restore();
+                }
+            }
+        } else {
+            // Painting is clipped to the invalidated region
+            painter.fillRect(event->rect(), Qt::black);
+            applyViewport(painter);
+
+            // Only the instruments that overlap what needs repainting
+            for (const Instrument &instrument : instruments) {
+                if (dirty.intersects(instrument.region)) {
+                    (this->*instrument.draw)(painter);
+                }
+            }
+        }
+
+        /*drawCrosshair(painter);*/
+
+        // A sample is shown by the frame that repaints the horizon for it; frames
+        // that only touch other instruments, and samples that leave the horizon
+        // where it was, present nothing
+        const bool attitudePainted = attitudeRepaintPending && dirty.intersects(instruments.front().region);
+        if (attitudePainted) attitudeRepaintPending = false;
+        if (latencyStats && attitudePainted && telemetry.sampleHandoffNs != presentedHandoffNs) {
+            presentedHandoffNs = telemetry.sampleHandoffNs;
+            latencyStats->recordPresented(telemetry.sampleArrivedNs, telemetry.sampleHandoffNs,
+                                          telemetry.sampleSensorTimeMs, monotonicNowNs());
+        }
+
+        // A new level takes effect from the next frame, over the whole widget
+        const std::int64_t paintEndNs = monotonicNowNs();
+        if (governor.recordFrame(paintEndNs - paintStartNs)) {
+            QMetaObject::invokeMethod(this, &AttitudeIndicator::applyRenderQuality, Qt::QueuedConnection);
+        }
+        if (!firstFrameDone) {
+            firstFrameDone = true;
+            emit firstFramePainted(paintEndNs);
+        }
+    }
+
+    void resizeEvent(QResizeEvent *event) override {
+        staticLayerDirty = true;
+        layoutInstruments();  // Regions and key resolution follow the pixel size
+        QWidget::resizeEvent(event);
+    }
+
+    void changeEvent(QEvent *event) override {
+        if (event->type() == QEvent::FontChange) {
+            staticLayerDirty = true;
+            ladderStripDirty = true;
+            textCacheDirty = true;
+            invalidateTiles();
+        }
+        QWidget::changeEvent(event);
+    }
+
+private:
+    // 200x200 logical units, centred, in the largest square that fits.
+    // origin: widget pixel that lands at the painter's (0, 0), for tiles.
+    void applyViewport(QPainter &painter, const QPoint &origin = QPoint()) const {
         int side = qMin(width(), height());
-        painter.setViewport((width() - side) / 2, (height() - side) / 2, side, side);
+        painter.setViewport((width() - side) / 2 - origin.x(), (height() - side) / 2 - origin.y(), side, side);
         painter.setWindow(-100, -100, 200, 200);
+    }
 
-        // Draw sky and ground
-        drawHorizon(painter);
+    // Instrument fonts are resolved once, not per draw call
+    void resolveFonts() {
+        customFont = QFont(customFontFamily, 3);
+        monoFont = QFont(nimbusMono, 3);
+        flightModeText.setTextFormat(Qt::PlainText);
+        flightModeText.setPerformanceHint(QStaticText::AggressiveCaching);
+    }
 
-        // Draw pitch ladder
-        drawPitchLadder(painter);
+    // Glyph atlases for every readout that changes at run time.
+    // Rebuilt on resize, DPI change or font change.
+    void ensureTextCache() {
+        int side = qMin(width(), height());
+        const qreal scale = side / 200.0 * devicePixelRatioF();
+        if (!textCacheDirty && textCacheScale == scale) return;
+
+        monoAscent = QFontMetricsF(monoFont, this).ascent();
+        customAscent = QFontMetricsF(customFont, this).ascent();
+        monoGreenGlyphs.build(monoFont, Qt::green, scale, this);
+        customWhiteGlyphs.build(customFont, Qt::white, scale, this);
+        customYellowGlyphs.build(customFont, Qt::yellow, scale, this);
+
+        textCacheScale = scale;
+        textCacheDirty = false;
+    }
+
+    // Rebuilt only on resize, DPI change, font change or a new prop count
+    void ensureStaticLayer() {
+        const qreal dpr = devicePixelRatioF();
+        if (!staticLayerDirty && staticLayer.devicePixelRatio() == dpr) return;
+
+        staticLayer = QPixmap(size() * dpr);
+        staticLayer.setDevicePixelRatio(dpr);
+        staticLayer.fill(Qt::transparent);
 
-        // Draw roll indicator
-        drawRollIndicator(painter);
+        QPainter painter(&staticLayer);
+        painter.setRenderHint(QPainter::Antialiasing, antialiasing);
+        applyViewport(painter);
 
-        // Draw center aircraft symbol
+        drawRollScale(painter);
         drawAircraftSymbol(painter);
+        drawTapeFrames(painter);
+        drawStaticLabels(painter);
 
-        drawAltitudeTape(painter);
+        staticLayerDirty = false;
+    }
 
-        drawSpeedTape(painter);
+    void drawTapeFrames(QPainter &painter) {
+        painter.save();
+        painter.setPen(QPen(Qt::green, 0.5));
 
-        drawHeadingTape(painter);
+        // Altitude tape: left, bottom and top lines
+        const float altHalf = altitudeTape.config().halfExtent;
+        painter.drawLine(QPointF(altTapeX-5, altHalf), QPointF(altTapeX-5, -altHalf));
+        painter.drawLine(QPointF(altTapeX-5, altHalf), QPointF(altTapeX+sideTapeWidth, altHalf));
+        painter.drawLine(QPointF(altTapeX-5, -altHalf), QPointF(altTapeX+sideTapeWidth, -altHalf));
 
-        drawFlightMode(painter);
+        // Speed tape: right, bottom and top lines
+        const float speedHalf = speedTape.config().halfExtent;
+        painter.drawLine(QPointF(-speedTapeX+5, speedHalf), QPointF(-speedTapeX+5, -speedHalf));
+        painter.drawLine(QPointF(-speedTapeX+5, speedHalf), QPointF(-speedTapeX-sideTapeWidth, speedHalf));
+        painter.drawLine(QPointF(-speedTapeX+5, -speedHalf), QPointF(-speedTapeX-sideTapeWidth, -speedHalf));
+        // Current speed tick
+        painter.drawLine(QPointF(-speedTapeX + 4.5, 0), QPointF(-speedTapeX, 0));
 
-        drawClock(painter);
+        // Heading tape: top line
+        painter.drawLine(-headingTapeX+5, -headingTapeY, headingTapeX-5, -headingTapeY);
 
-        drawGauges(painter);
+        painter.restore();
+    }
 
-        drawQNH(painter);
+    void drawStaticLabels(QPainter &painter) {
+        painter.save();
 
-        /*drawCrosshair(painter);*/
+        painter.setPen(QPen(Qt::green, 0.5));
+        painter.setFont(monoFont);
+        painter.drawText(altTapeX-3, -62, "BARO ALT (FEET)");
+        painter.drawText(-speedTapeX - 10, -62, "SPEED KTS");
 
-        drawBattery(painter);
+        painter.setFont(customFont);
+        painter.setPen(QPen(Qt::white, 0.5));
+        painter.drawText(-70, 90 - 8, "CLK (GMT)");
+        painter.drawText(55, 70, "INHG");
+        painter.drawText(55, 75, "HPA");
+        painter.drawText(60, -70, "BATTERY:");
+
+        // RPM gauge arcs and captions
+        const int radius = 8;
+        int oldPos = -47.5;
+        for (int i=1; i<=telemetry.propQuantity; i++) {
+            painter.setPen(QPen(Qt::red, 0.5));
+            painter.drawArc(-95, oldPos, 2*radius, 2*radius, 180 * 16, 270 * 16);
+            painter.setPen(QPen(Qt::yellow, 0.5));
+            painter.drawText(-92.5, oldPos + 20, "RPM #" + QString::number(i));
+            oldPos += 25;
+        }
+
+        painter.restore();
     }
 
-private:
     void drawCrosshair(QPainter &painter) {
         painter.save();
 
@@ -113,10 +367,10 @@ private:
         painter.save();
 
         // Rotate for roll
-        painter.rotate(-roll);
+        painter.rotate(-telemetry.roll);
 
         // Calculate vertical offset for pitch (pixels per degree)
-        float pitchOffset = pitch * zoom;
+        float pitchOffset = -telemetry.pitch * zoom;
 
         // Draw horizon line extending across entire display
         painter.setPen(QPen(Qt::green, 1));
@@ -128,53 +382,78 @@ private:
         painter.restore();
     }
 
-    void drawPitchLadder(QPainter &painter) {
+    // The whole -90..+90 ladder lives in one offscreen strip in "ladder space":
+    // x in logical units, y = -angle * zoom, rendered at device resolution.
+    static constexpr float ladderHalfWidth = 34.0f;  // Rungs, ticks and labels
+    static constexpr float ladderMargin = 6.0f;      // Ticks and labels past the end rungs
+    static constexpr float ladderVisibleTop = -75.0f;
+    static constexpr float ladderVisibleBottom = 100.0f;
+
+    QRectF ladderStripRect() const {
+        float halfHeight = 90 * zoom + ladderMargin;
+        return QRectF(-ladderHalfWidth, -halfHeight, 2 * ladderHalfWidth, 2 * halfHeight);
+    }
+
+    // Rebuilt on resize, DPI change, font change or a new zoom
+    void ensureLadderStrip() {
+        int side = qMin(width(), height());
+        const qreal scale = side / 200.0 * devicePixelRatioF();
+        if (!ladderStripDirty && ladderStripScale == scale && ladderStripZoom == zoom) return;
+
+        const QRectF strip = ladderStripRect();
+        ladderStrip = QImage(qCeil(strip.width() * scale), qCeil(strip.height() * scale),
+                             QImage::Format_ARGB32_Premultiplied);
+        ladderStrip.fill(Qt::transparent);
+
+        QPainter painter(&ladderStrip);
+        painter.setRenderHint(QPainter::Antialiasing, antialiasing);
+        painter.scale(scale, scale);
+        painter.translate(-strip.left(), -strip.top());
+        drawLadderRungs(painter);
+
+        ladderStripScale = scale;
+        ladderStripZoom = zoom;
+        ladderStripDirty = false;
+    }
+
+    void drawLadderRungs(QPainter &painter) {
         painter.save();
 
-        // Rotate for roll
-        painter.rotate(-roll);
+        painter.setFont(customFont);
 
-        painter.setPen(QPen(Qt::green, 0.5));
-        painter.setFont(QFont(customFontFamily, 3));
+        QPen posPen(Qt::green, 0.5);
+        posPen.setStyle(Qt::SolidLine);
+        QPen negDashPen(Qt::green, 0.5);
+        negDashPen.setStyle(Qt::DashLine);
+        negDashPen.setDashPattern({2.0,4.0});
 
-        // Draw pitch lines every 5 degrees
-        for (int angle = -90; angle <= 90; angle += 5) {
+        // Draw pitch lines every 5 degrees, 10 when sparse
+        const int spacing = renderQuality >= FrameTimeGovernor::SparseLadder ? 10 : 5;
+        for (int angle = -90; angle <= 90; angle += spacing) {
             if (angle == 0) continue; // Skip horizon line
 
-            // The ladder is fixed in world space
             // Positive angles are above horizon (negative y), negative angles below
-            float y = - (angle * zoom + pitch * zoom);
-
-            // Only draw if visible
-            if (y < -75 || y > 100) continue;
+            float y = -angle * zoom;
+            QString text = QString::number(angle);
 
             if (angle > 0) {
-                QPen posPen(Qt::green, 0.5);
-                posPen.setStyle(Qt::SolidLine);
                 painter.setPen(posPen);
                 painter.drawLine(-15, y, -30, y);
                 painter.drawLine(15, y, 30, y);
                 painter.drawLine(-30, y, -30, y+3);
                 painter.drawLine(30, y, 30, y+3);
                 // Draw angle text
-                QString text = QString::number(angle);
                 painter.drawText(-27, y + 3.05, text);
                 painter.drawText(25, y + 3.05, text);
             }
             else {
-                QPen negPen(Qt::green, 0.5);
-                negPen.setStyle(Qt::DashLine);
-                negPen.setDashPattern({2.0,4.0});
-                painter.setPen(negPen);
-
+                painter.setPen(negDashPen);
                 painter.drawLine(-15, y, -30, y+2);
                 painter.drawLine(15, y, 30, y+2);
-                negPen.setStyle(Qt::SolidLine);
-                painter.setPen(negPen);
+                painter.setPen(posPen);
                 painter.drawLine(-15, y, -15, y-3);
                 painter.drawLine(15, y, 15, y-3);
                 // Draw angle text
-                QString text = QString::number(angle);
                 painter.drawText(-21, y-0.5, text);
                 painter.drawText(16, y-0.5, text);
             }
@@ -183,14 +462,45 @@ private:
         painter.restore();
     }
 
-    void drawRollIndicator(QPainter &painter) {
+    void drawPitchLadder(QPainter &painter) {
         painter.save();
 
-        const int radius = 42;
+        // Rotate for roll
+        painter.rotate(-telemetry.roll);
+
+        // The ladder is fixed in world space: shift it by the pitch
+        const float pitchOffset = -telemetry.pitch * zoom;
+        painter.translate(0, -pitchOffset);
+
+        // Only the window that lands inside the visible band, in ladder space
+        const QRectF strip = ladderStripRect();
+        float top = qMax<float>(strip.top(), ladderVisibleTop - ladderMargin + pitchOffset);
+        float bottom = qMin<float>(strip.bottom(), ladderVisibleBottom + ladderMargin + pitchOffset);
+        if (top < bottom) {
+            QRectF target(strip.left(), top, strip.width(), bottom - top);
+            QRectF source((target.left() - strip.left()) * ladderStripScale,
+                          (target.top() - strip.top()) * ladderStripScale,
+                          target.width() * ladderStripScale,
+                          target.height() * ladderStripScale);
+
+            painter.setRenderHint(QPainter::SmoothPixmapTransform, renderQuality < FrameTimeGovernor::SparseLadder);
+            painter.drawImage(target, ladderStrip, source);
+        }
+
+        painter.restore();
+    }
+
+    // Shared by the cached roll scale and the live roll pointer
+    static constexpr int rollRadius = 42;
+    static constexpr int rollPointerHeight = 3;
+
+    void drawRollScale(QPainter &painter) {
+        painter.save();
+
+        const int radius = rollRadius;
         const int tickLong = 2;     // (long ticks)
         const int tickShort = 1;  //  (short ticks)
-        const int pointerHeight = 3;
-        const float pointerWidth = 2.5f;
+        const int pointerHeight = rollPointerHeight;
         const float centerMarkWidth = 2.5f;
         const int centerMarkHeight = 6;
 
@@ -222,11 +532,32 @@ private:
             painter.restore();
         }
 
+        // Draw center reference mark (flipped vertically)
+        QPainterPath centerMark;
+        centerMark.moveTo(0, radius - pointerHeight/2);
+        centerMark.lineTo(-centerMarkWidth + 1.5, radius - pointerHeight / 2 - centerMarkHeight + 3);
+        centerMark.lineTo(centerMarkWidth - 1.5, radius - pointerHeight / 2 - centerMarkHeight + 3);
+        centerMark.closeSubpath();
+
+        painter.setBrush(Qt::transparent);
+        painter.drawPath(centerMark);
+
+        painter.restore();
+    }
+
+    void drawRollIndicator(QPainter &painter) {
+        painter.save();
+
+        const int radius = rollRadius;
+        const int pointerHeight = rollPointerHeight;
+        const float pointerWidth = 2.5f;
+
+        painter.setPen(QPen(Qt::green, 0.5));
+
         //Limit roll to 45 degrees
-        double clampedRoll = std::clamp(static_cast<double>(roll), -45.0, 45.0);
+        double clampedRoll = std::clamp(static_cast<double>(telemetry.roll), -45.0, 45.0);
 
         // Draw roll pointer
-        painter.save();
         painter.rotate(-clampedRoll);
 
         QPainterPath triangleSmall;
@@ -244,23 +575,10 @@ private:
         triangleOuter.closeSubpath();
         painter.setBrush(Qt::transparent);
         painter.drawPath(triangleOuter);
-        painter.restore();
-
-        // Draw center reference mark (flipped vertically)
-        QPainterPath centerMark;
-        centerMark.moveTo(0, radius - pointerHeight/2);
-        centerMark.lineTo(-centerMarkWidth + 1.5, radius - pointerHeight / 2 - centerMarkHeight + 3);
-        centerMark.lineTo(centerMarkWidth - 1.5, radius - pointerHeight / 2 - centerMarkHeight + 3);
-        centerMark.closeSubpath();
-
-        painter.setBrush(Qt::transparent);
-        painter.drawPath(centerMark);
 
         painter.restore();
     }
 
-
-
     void drawAircraftSymbol(QPainter &painter) {
         painter.save();
 
@@ -278,68 +596,406 @@ private:
         painter.restore();
     }
 
-    int calculateBaroAltitudeInt() {
-        float hpaQNH = QNH * 33.865;
-        float baroAlt = altitude + (hpaQNH - 1013.25f) * 30.0f;
-        float ISA = 15.0f;
-        float ISA_Temp = ISA - 2.0f * (baroAlt / 1000.0f);
-        float ISA_Dev = OAT - ISA_Temp;
-        float densityAltitude = (4.0f * (baroAlt / 1000.0f) * ISA_Dev) + baroAlt;
+    // --- Tape layout, shared by the static frames and the live ticks ---
+    static constexpr int altTapeX = 60;       // Altitude tape tick line
+    static constexpr int speedTapeX = 60;     // Speed tape tick line (mirrored left)
+    static constexpr int sideTapeWidth = 12;  // Frame width of both side tapes
+    static constexpr int headingTapeY = 70;   // Heading tape top line (above centre)
+    static constexpr int headingTapeX = 45;   // Heading frame half width + 5
+
+    static QString numberLabel(int value) {
+        return QString::number(value);
+    }
+
+    static QString headingLabel(int value) {
+        if (value == 0) return "N";    // North
+        if (value == 90) return "E";   // East
+        if (value == 180) return "S";  // South
+        if (value == 270) return "W";  // West
+        return QString("%1").arg(value / 10, 2, 10, QChar('0'));
+    }
+
+    static TapeConfig altitudeTapeConfig() {
+        TapeConfig c;
+        c.step = 100;          // Feet per tick
+        c.labelStep = 500;     // Label every 500 ft
+        c.tickSpacing = 10;    // Logical units between 100 ft ticks
+        c.halfExtent = 60;     // Visible range above/below center
+        c.direction = -1;      // Higher altitudes are drawn above
+        c.minValue = -90000;
+        c.maxValue = 90000;
+        c.modulus = 0;
+        c.labelText = &numberLabel;
+        return c;
+    }
+
+    static TapeConfig speedTapeConfig() {
+        TapeConfig c;
+        c.step = 10;           // Knots per tick
+        c.labelStep = 10;      // Label every tick
+        c.tickSpacing = 10;
+        c.halfExtent = 60;
+        c.direction = -1;
+        c.minValue = 0;
+        c.maxValue = 350;
+        c.modulus = 0;
+        c.labelText = &numberLabel;
+        return c;
+    }
+
+    static TapeConfig headingTapeConfig() {
+        TapeConfig c;
+        c.step = 5;            // Degrees per tick
+        c.labelStep = 10;      // Label every 10 degrees
+        c.tickSpacing = 10;
+        c.halfExtent = 40;     // Visible range left/right center
+        c.direction = 1;       // Higher headings are drawn to the right
+        c.minValue = 0;
+        c.maxValue = 0;
+        c.modulus = 360;
+        c.labelText = &headingLabel;
+        return c;
+    }
+
+    // QStaticText is positioned by its top-left corner, drawText by the baseline
+    static void drawLabel(QPainter &painter, qreal x, qreal baseline, qreal ascent, const QStaticText &text) {
+        painter.drawStaticText(QPointF(x, baseline - ascent), text);
+    }
+
+    static float wrapHeading(float heading) {
+        float wrapped = std::fmod(heading, 360.0f);
+        return wrapped < 0 ? wrapped + 360.0f : wrapped;
+    }
+
+    // --- Instruments ---
+    // Each instrument owns a region of the display, a refresh interval and a
+    // key: its inputs quantised to the resolution they are drawn at (readouts
+    // by the digits they show, moving geometry by half a device pixel of
+    // travel). Equal keys paint the same pixels, so only instruments whose key
+    // changed invalidate their region, and no more often than their interval.
+    using InstrumentKey = std::array<std::int64_t, 5>;
+
+    struct Instrument {
+        const char *name;
+        QRectF bounds;               // Logical units, see applyViewport()
+        int refreshIntervalMs;       // Minimum time between repaints, 0 for every change
+        void (AttitudeIndicator::*draw)(QPainter &);
+        InstrumentKey (AttitudeIndicator::*key)(const TelemetrySnapshot &) const;  // nullptr: static
+        bool lowPriority = false;    // Held back at FrameTimeGovernor::Essential
+        QRect region;                // bounds in widget pixels, see layoutInstruments()
+        InstrumentKey shownKey = {};
+        qint64 lastRepaintMs = 0;
+        QImage tile;                 // Device resolution, see renderTiles()
+        InstrumentKey tileKey = {};  // Key the tile was rendered at
+        bool tileValid = false;
+    };
+
+    // Registration order is paint order
+    void registerInstruments() {
+        using AI = AttitudeIndicator;
+        const QRectF everywhere(-200, -200, 400, 400);  // The horizon reaches past the square
+        instruments = {
+            {"attitude", everywhere, 0, &AI::drawAttitude, &AI::attitudeKey},
+            {"static", everywhere, 0, &AI::drawStaticLayer, nullptr},
+            {"roll pointer", QRectF(-40, 24, 80, 27), 0, &AI::drawRollIndicator, &AI::rollPointerKey},
+            {"altitude tape", QRectF(altTapeX - 6, -64, 106 - altTapeX, 132), 0, &AI::drawAltitudeTape, &AI::altitudeTapeKey},
+            {"speed tape", QRectF(-100, -64, 106 - speedTapeX, 128), 0, &AI::drawSpeedTape, &AI::speedTapeKey},
+            {"heading tape", QRectF(-headingTapeX - 2, -84, 2 * headingTapeX + 4, 15), 0, &AI::drawHeadingTape, &AI::headingTapeKey},
+            {"flight mode", QRectF(-100, -90, 200, 7), 0, &AI::drawFlightMode, &AI::flightModeKey},
+            {"clock", QRectF(-72, 82, 26, 7), 1000, &AI::drawClock, &AI::clockKey, true},
+            {"gauges", QRectF(-92, -42, 16, 82), 100, &AI::drawGauges, &AI::gaugesKey, true},
+            {"qnh", QRectF(63, 65, 20, 12), 1000, &AI::drawQNH, &AI::qnhKey, true},
+            {"battery", QRectF(58, -85, 30, 17), 1000, &AI::drawBattery, &AI::batteryKey},
+            {"latency", QRectF(-42, 53, 84, 42.5), 500, &AI::drawLatencyOverlay, &AI::latencyOverlayKey},
+            {"stale data", QRectF(-21, -31, 42, 13), 100, &AI::drawStaleWarning, &AI::staleWarningKey},
+        };
+
+        tileJobs.clear();
+        for (std::size_t i = 0; i < instruments.size(); i++) {
+            tileJobs.emplace_back(new TileJob(*this, static_cast<int>(i)));
+        }
+        staleTiles.reserve(instruments.size());
+    }
+
+    // Maps every instrument's bounds to widget pixels for the current size
+    void layoutInstruments() {
+        const int side = qMin(width(), height());
+        QTransform toWidget;
+        toWidget.translate((width() - side) / 2, (height() - side) / 2);
+        toWidget.scale(side / 200.0, side / 200.0);
+        toWidget.translate(100, 100);
+
+        for (Instrument &instrument : instruments) {
+            // One pixel of slack for antialiasing
+            instrument.region = toWidget.mapRect(instrument.bounds).toAlignedRect()
+                                    .adjusted(-1, -1, 1, 1).intersected(rect());
+            if (instrument.key) {
+                instrument.shownKey = (this->*instrument.key)(telemetry);
+            }
+        }
+    }
+
+    // Invalidates the regions of instruments whose key changed since they
+    // were last invalidated. Changes inside an instrument's refresh interval
+    // are picked up again by throttleTimer.
+    void refreshInstruments() {
+        const qint64 now = instrumentClock.elapsed();
+        qint64 nextDue = -1;
+
+        for (Instrument &instrument : instruments) {
+            if (!instrument.key) continue;
+            const InstrumentKey key = (this->*instrument.key)(telemetry);
+            if (key == instrument.shownKey) continue;
+
+            const qint64 interval = heldBack(instrument) ? qMax(instrument.refreshIntervalMs, lowPriorityIntervalMs)
+                                                         : instrument.refreshIntervalMs;
+            const qint64 due = instrument.lastRepaintMs + interval;
+            if (now < due) {
+                nextDue = nextDue < 0 ? due : qMin(nextDue, due);
+                continue;
+            }
+            instrument.shownKey = key;
+            instrument.lastRepaintMs = now;
+            if (&instrument == &instruments.front()) attitudeRepaintPending = true;
+            update(instrument.region);
+        }
+
+        if (nextDue >= 0 && (!throttleTimer.isActive() || throttleTimer.remainingTime() > nextDue - now)) {
+            throttleTimer.start(int(nextDue - now));
+        }
+    }
+
+    // Low-priority instruments repaint no faster than this at the lowest quality
+    static constexpr int lowPriorityIntervalMs = 1000;
+
+    bool heldBack(const Instrument &instrument) const {
+        return instrument.lowPriority && renderQuality >= FrameTimeGovernor::Essential;
+    }
+
+    // GUI thread, between frames: tiles and the ladder strip follow the level
+    void applyRenderQuality() {
+        const FrameTimeGovernor::Quality next = governor.quality();
+        if (next == renderQuality) return;
+        if ((next >= FrameTimeGovernor::SparseLadder) != (renderQuality >= FrameTimeGovernor::SparseLadder)) {
+            ladderStripDirty = true;
+        }
+        renderQuality = next;
+        invalidateTiles();
+        update();
+    }
+
+    // --- Tiles ---
+    // With parallel rendering every instrument that has a key paints into its
+    // own QImage tile at device resolution, and paintEvent() composites the
+    // tiles in paint order. A tile is re-rendered only when it is dirty and
+    // its key moved on, so a tape update reuses the horizon and the other way
+    // round. Stale tiles render concurrently on the global QThreadPool while
+    // the GUI thread takes the first one (the horizon, the largest).
+    //
+    // Workers only read shared state: paintEvent() builds the caches first,
+    // and each tape belongs to a single tile.
+    class TileJob : public QRunnable {
+    public:
+        TileJob(AttitudeIndicator &owner, int index)
+        : owner(owner), index(index) {
+            setAutoDelete(false);  // Started again every frame it is stale
+        }
+
+        void run() override {
+            owner.renderTile(owner.instruments[index]);
+            owner.tilesDone.release();
+        }
+
+    private:
+        AttitudeIndicator &owner;
+        const int index;
+    };
+
+    void renderTiles(const QRegion &dirty) {
+        const qreal dpr = devicePixelRatioF();
+
+        staleTiles.clear();
+        for (std::size_t i = 0; i < instruments.size(); i++) {
+            Instrument &instrument = instruments[i];
+            if (!instrument.key || !dirty.intersects(instrument.region)) continue;
+
+            const QSize pixels = instrument.region.size() * dpr;
+            if (instrument.tile.size() != pixels || instrument.tile.devicePixelRatio() != dpr) {
+                instrument.tile = QImage(pixels, QImage::Format_ARGB32_Premultiplied);
+                instrument.tile.setDevicePixelRatio(dpr);
+                instrument.tileValid = false;
+            }
+            // Held-back tiles follow shownKey, which refreshInstruments() throttles;
+            // the horizon invalidates their region every frame regardless
+            const InstrumentKey key = heldBack(instrument) ? instrument.shownKey
+                                                           : (this->*instrument.key)(telemetry);
+            if (instrument.tileValid && instrument.tileKey == key) continue;
+
+            instrument.tileKey = key;
+            instrument.tileValid = true;
+            staleTiles.push_back(static_cast<int>(i));
+        }
+        if (staleTiles.empty()) return;
+
+        QThreadPool *pool = QThreadPool::globalInstance();
+        for (std::size_t n = 1; n < staleTiles.size(); n++) {
+            pool->start(tileJobs[staleTiles[n]].get());
+        }
+        renderTile(instruments[staleTiles.front()]);
+        tilesDone.acquire(static_cast<int>(staleTiles.size()) - 1);
+    }
+
+    // Any thread
+    void renderTile(Instrument &instrument) {
+        QImage &tile = instrument.tile;
+        if (tile.isNull()) return;
+
+        // The bottom tile stands in for the background fill
+        tile.fill(&instrument == &instruments.front() ? Qt::black : Qt::transparent);
+        QPainter painter(&tile);
+        painter.setRenderHint(QPainter::Antialiasing, antialiasing);
+        applyViewport(painter, instrument.region.topLeft());
+        (this->*instrument.draw)(painter);
+    }
+
+    // Fonts, antialiasing or the rendering mode changed under every tile
+    void invalidateTiles() {
+        for (Instrument &instrument : instruments) instrument.tileValid = false;
+    }
 
-        return static_cast<int>(densityAltitude);
+    // Half device pixels per logical unit: the finest movement that shows
+    double halfPixelsPerUnit() const {
+        const int side = qMin(width(), height());
+        return 2.0 * side / 200.0 * devicePixelRatioF();
+    }
+
+    InstrumentKey attitudeKey(const TelemetrySnapshot &t) const {
+        const double halfPixels = halfPixelsPerUnit();
+        const double horizonReach = 100.0;  // Logical units from the centre to the display edge
+        return {std::llround(t.pitch * zoom * halfPixels),
+                std::llround(qDegreesToRadians(double(t.roll)) * horizonReach * halfPixels)};
+    }
+
+    InstrumentKey rollPointerKey(const TelemetrySnapshot &t) const {
+        const double clampedRoll = std::clamp(static_cast<double>(t.roll), -45.0, 45.0);
+        const double tipRadius = rollRadius + rollPointerHeight + 2;
+        return {std::llround(qDegreesToRadians(clampedRoll) * tipRadius * halfPixelsPerUnit())};
+    }
+
+    InstrumentKey altitudeTapeKey(const TelemetrySnapshot &t) const {
+        // The tape is positioned by the integer baro altitude, like the readout
+        return {int(t.baroAltitude), int(t.altitude)};
+    }
+
+    InstrumentKey speedTapeKey(const TelemetrySnapshot &t) const {
+        const float shownSpeed = qMax(t.speed, 0.0f);
+        const float unitsPerKnot = speedTape.config().tickSpacing / speedTape.config().step;
+        return {std::llround(shownSpeed * unitsPerKnot * halfPixelsPerUnit()), int(shownSpeed)};
+    }
+
+    InstrumentKey headingTapeKey(const TelemetrySnapshot &t) const {
+        const float unitsPerDegree = headingTape.config().tickSpacing / headingTape.config().step;
+        return {std::llround(wrapHeading(t.heading) * unitsPerDegree * halfPixelsPerUnit()), int(t.heading)};
+    }
+
+    InstrumentKey flightModeKey(const TelemetrySnapshot &) const {
+        return {flightModeRevision};
+    }
+
+    InstrumentKey clockKey(const TelemetrySnapshot &t) const {
+        std::int64_t packed = 0;  // HH:MM:SS fits in eight bytes
+        std::memcpy(&packed, t.clock, qMin(sizeof(packed), std::strlen(t.clock)));
+        return {packed};
+    }
+
+    InstrumentKey gaugesKey(const TelemetrySnapshot &t) const {
+        InstrumentKey key = {};
+        for (int i = 0; i < 4; i++) {
+            key[i] = i < t.propQuantity ? t.rpm[i] : 0;
+        }
+        key[4] = t.propQuantity;
+        return key;
+    }
+
+    InstrumentKey qnhKey(const TelemetrySnapshot &t) const {
+        return {std::llround(double(t.qnhHpa) * 100), std::llround(double(t.qnh) * 100)};
+    }
+
+    InstrumentKey batteryKey(const TelemetrySnapshot &t) const {
+        return {std::llround(double(t.batteryVolts) * 10),
+                std::llround(double(t.batteryLevel) * 1000),
+                std::llround(25 * t.batteryLevel * halfPixelsPerUnit())};
+    }
+
+    InstrumentKey latencyOverlayKey(const TelemetrySnapshot &) const {
+        if (!latencyOverlayVisible || !latencyStats) return {};
+        return {1, static_cast<std::int64_t>(latencyStats->presentedCount()),
+                static_cast<std::int64_t>(governor.windowsCompleted()), governor.quality(),
+                static_cast<std::int64_t>(latencyStats->droppedCount())};
+    }
+
+    InstrumentKey staleWarningKey(const TelemetrySnapshot &t) const {
+        return {t.staleMs > 0, t.staleMs / 100};
+    }
+
+    void drawAttitude(QPainter &painter) {
+        // Draw sky and ground
+        drawHorizon(painter);
+
+        // Draw pitch ladder
+        drawPitchLadder(painter);
+    }
+
+    // Everything that never moves, pre-rendered at device resolution
+    void drawStaticLayer(QPainter &painter) {
+        painter.save();
+        painter.resetTransform();
+        painter.drawPixmap(0, 0, staticLayer);
+        painter.restore();
+    }
+
+    // Ticks are axis-aligned hairlines: below full quality they go without
+    // antialiasing. Called with false before the ticks and true after.
+    void setTickAntialiasing(QPainter &painter, bool on) const {
+        if (renderQuality < FrameTimeGovernor::PlainTicks) return;
+        painter.setRenderHint(QPainter::Antialiasing, on && antialiasing);
     }
 
     void drawAltitudeTape(QPainter &painter) {
         painter.save();
-        // --- Layout constants ---
-        const int tapeX = 60;         // Horizontal position
-        const int tapeWidth = 12;     // Width of the tape
-        const int tickSpacing = 10;    // Pixel distance between 100 ft ticks
-        const int stepFt = 100;       // Feet per tick
-        const int labelStep = 500;    // Label every 500 ft
-        const int visibleRangeFt = 600; // Visible range above/below center
+        const int tapeX = altTapeX;
 
         // --- Appearance ---
         painter.setPen(QPen(Qt::green, 0.5));
-        painter.setFont(QFont(nimbusMono, 3));
+        painter.setFont(monoFont);
+        const qreal ascent = monoAscent;
 
-        // --- Background ---
+        // Frame lines and caption live in the static layer
         painter.setBrush(Qt::transparent);
-        int tapeHeight = (visibleRangeFt / stepFt) * tickSpacing * 2;
-
-        painter.setPen(QPen(Qt::green, 0.5));
-
-        // Left line
-        painter.drawLine(tapeX-5, tapeHeight/2, tapeX-5, -tapeHeight/2);
-        // Bottom Line
-        painter.drawLine(tapeX-5, tapeHeight/2, tapeX+tapeWidth, tapeHeight/2);
-        // Top Line
-        painter.drawLine(tapeX-5, -tapeHeight/2, tapeX+tapeWidth, -tapeHeight/2);
-        int baroAltitude = calculateBaroAltitudeInt();
-        for (int alt = -90000; alt <= 90000; alt += stepFt) {
-            float y = (baroAltitude - alt) * (tickSpacing / (float)stepFt);
-
-            if (y < -60 || y > 60) continue;
 
+        const int baroAltitude = int(telemetry.baroAltitude);
+        altitudeTape.setValue(baroAltitude);
+        setTickAntialiasing(painter, false);
+        for (const Tape::Tick &tick : altitudeTape) {
             // Draw tick
-            painter.drawLine(tapeX - 4.5, y, tapeX, y);
+            painter.drawLine(tapeX - 4.5, tick.offset, tapeX, tick.offset);
 
             // Label only every 500 ft
-            if (alt % labelStep == 0 and (alt != int(baroAltitude) || alt != int(baroAltitude-1))) {
-                QString text = QString::number(alt);
-                painter.drawText(tapeX + 2, y+1, text);
+            if (tick.label) {
+                drawLabel(painter, tapeX + 2, tick.offset + 1, ascent, *tick.label);
             }
         }
+        setTickAntialiasing(painter, true);
 
+        char text[32];
+        int length;
         if (baroAltitude >= 0) {
             // --- Draw current altitude box ---
             QRectF box(tapeX + 2, -3, 15, 6);
             painter.setBrush(Qt::black);
             painter.setPen(QPen(Qt::red, 0.5));
             painter.drawRect(box);
-            painter.setPen(QPen(Qt::green, 0.5));
-            QString text = QString::number(int(baroAltitude));
-            painter.drawText(tapeX + 4, 1, text);
+            length = textformat::appendInt(text, baroAltitude);
         }
         else {
             // --- Draw current altitude box ---
@@ -347,187 +1003,129 @@ private:
             painter.setBrush(Qt::black);
             painter.setPen(QPen(Qt::red, 0.5));
             painter.drawRect(box);
-            painter.setPen(QPen(Qt::green, 0.5));
-            QString text = QString::number(abs(int(baroAltitude)));
-            painter.drawText(tapeX + 4, 1, "NEG " + text);
+            length = textformat::appendText(text, "NEG ");
+            length += textformat::appendInt(text + length, -static_cast<long long>(baroAltitude));
         }
-        painter.drawText(tapeX-3, -62, "BARO ALT (FEET)");
-        painter.drawText(55, 65, "ALT AGL: " + QString::number(int(altitude)) + "FT");
+        monoGreenGlyphs.draw(painter, tapeX + 4, 1, text, length);
+
+        length = textformat::appendText(text, "ALT AGL: ");
+        length += textformat::appendInt(text + length, int(telemetry.altitude));
+        length += textformat::appendText(text + length, "FT");
+        monoGreenGlyphs.draw(painter, 55, 65, text, length);
         painter.restore();
     }
 
     void drawSpeedTape(QPainter &painter) {
         painter.save();
-        // --- Layout constants ---
-        const int tapeX = 60;         // Horizontal position
-        const int tapeWidth = 12;     // Width of the tape
-        const int tickSpacing = 10;    // Pixel distance between 100 ft ticks
-        const int stepKts = 10;       // Feet per tick
-        const int labelStep = 500;    // Label every 500 ft
-        const int visibleRangeKts = 60; // Visible range above/below center
+        const int tapeX = speedTapeX;
+        const float shownSpeed = qMax(telemetry.speed, 0.0f);
 
         // --- Appearance ---
         painter.setPen(QPen(Qt::green, 0.5));
-        painter.setFont(QFont(nimbusMono, 3));
+        painter.setFont(monoFont);
+        const qreal ascent = monoAscent;
 
-        // --- Background ---
+        // Frame lines, current speed tick and caption live in the static layer
         painter.setBrush(Qt::transparent);
-        int tapeHeight = (visibleRangeKts / stepKts) * tickSpacing * 2;
-
-        painter.setPen(QPen(Qt::green, 0.5));
-
-        // right line
-        painter.drawLine(-tapeX+5, tapeHeight/2, -tapeX+5, -tapeHeight/2);
-        // Bottom Line
-        painter.drawLine(-tapeX+5, tapeHeight/2, -tapeX-tapeWidth, tapeHeight/2);
-        // Top Line
-        painter.drawLine(-tapeX+5, -tapeHeight/2, -tapeX-tapeWidth, -tapeHeight/2);
-
-        for (int spd = 0; spd <= 350; spd += stepKts) {
-            float y = (speed - spd) * (tickSpacing / (float)stepKts);
-            if (speed < 0) {
-                speed = 0;
-            }
-            if (y < -60 || y > 60) continue;
-
-            if (speed >= 0) {
-                // Draw tick
-                painter.drawLine(-tapeX + 4.5, y, -tapeX, y);
-            }
 
-            // Draw Current speed tick
-            painter.drawLine(-tapeX + 4.5, 0, -tapeX, 0);
+        speedTape.setValue(shownSpeed);
+        setTickAntialiasing(painter, false);
+        for (const Tape::Tick &tick : speedTape) {
+            // Draw tick
+            painter.drawLine(-tapeX + 4.5, tick.offset, -tapeX, tick.offset);
 
-            // Label only every 500 ft
-            if (int(speed-3) > spd || spd > int(speed+3)) {
-                QString text = QString::number(spd);
-                painter.drawText(-tapeX - 7, y+1, text);
+            // Keep labels clear of the current speed box
+            if (tick.label && (int(shownSpeed-3) > tick.value || tick.value > int(shownSpeed+3))) {
+                drawLabel(painter, -tapeX - 7, tick.offset + 1, ascent, *tick.label);
             }
         }
+        setTickAntialiasing(painter, true);
 
-        // --- Draw current altitude box ---
+        // --- Draw current speed box ---
         QRectF box(-tapeX - 16, -3, 15, 6);
         painter.setBrush(Qt::black);
         painter.setPen(QPen(Qt::red, 0.5));
         painter.drawRect(box);
-        painter.setPen(QPen(Qt::green, 0.5));
-        QString text = QString::number(int(speed));
-        painter.drawText(-tapeX - 7, 1, text);
-        painter.drawText(-tapeX - 10, -62, "SPEED KTS");
+        char text[16];
+        int length = textformat::appendInt(text, int(shownSpeed));
+        monoGreenGlyphs.draw(painter, -tapeX - 7, 1, text, length);
         painter.restore();
     }
 
     void drawHeadingTape(QPainter &painter) {
-    painter.save();
-    // --- Layout constants ---
-    const int tapeX = 45;         // Horizontal position
-    const int tapeWidth = 90;     // Width of the tape
-    const int tickSpacing = 10;    // Pixel distance between ticks
-    const int stepDeg = 5;       // Degrees per tick
-    const int labelStep = 10;    // Label every 10 degrees
-    const int visibleRangeDeg = 50; // Visible range left/right center
-
-    // --- Appearance ---
-    painter.setPen(QPen(Qt::green, 0.5));
-    painter.setFont(QFont(nimbusMono, 3));
-
-    // --- Background ---
-    painter.setBrush(Qt::transparent);
-    int tapeHeight = 70;
-
-    painter.setPen(QPen(Qt::green, 0.5));
-
-    // Top Line
-    painter.drawLine(-tapeX+5, -tapeHeight, tapeX-5, -tapeHeight);
-
-    // Draw ticks
-    for (int hdg = -visibleRangeDeg; hdg <= 360 + visibleRangeDeg; hdg += stepDeg) {
-        // Normalize heading to 0-360 range
-        int normalizedHdg = hdg % 360;
-        if (normalizedHdg < 0) normalizedHdg += 360;
-
-        // Calculate position relative to current heading
-        float diff = normalizedHdg - heading;
-
-        // Handle wrapping (shortest angular distance)
-        if (diff > 180) diff -= 360;
-        if (diff < -180) diff += 360;
-
-        float x = diff * (tickSpacing / (float)stepDeg);
-
-        // Only draw if visible
-        if (x < -40 || x > 40) continue;
+        painter.save();
 
-        float y = -tapeHeight;
+        // --- Appearance ---
+        painter.setPen(QPen(Qt::green, 0.5));
+        painter.setFont(monoFont);
+        const qreal ascent = monoAscent;
 
-        // Draw tick
-        painter.drawLine(x, y, x, y - 5);
+        // Top line lives in the static layer
+        painter.setBrush(Qt::transparent);
+        const int tapeHeight = headingTapeY;
+        const float y = -tapeHeight;
 
-        // Label only every 10 degrees
-        if (normalizedHdg % labelStep == 0) {
-            QString text = QString("%1").arg(normalizedHdg / 10, 2, 10, QChar('0'));
+        // Normalize heading to 0-360 range
+        const float wrappedHeading = wrapHeading(telemetry.heading);
 
-            if (normalizedHdg / 10 == 0) text = "N";       // North
-            else if (normalizedHdg == 90) text = "E";      // East
-            else if (normalizedHdg == 180) text = "S";     // South
-            else if (normalizedHdg == 270) text = "W";     // West
+        headingTape.setValue(wrappedHeading);
+        setTickAntialiasing(painter, false);
+        for (const Tape::Tick &tick : headingTape) {
+            // Draw tick
+            painter.drawLine(tick.offset, y, tick.offset, y - 5);
 
-            painter.drawText(x - 2, y - 7, text);
+            // Label only every 10 degrees
+            if (tick.label) {
+                drawLabel(painter, tick.offset - 2, y - 7, ascent, *tick.label);
+            }
         }
-    }
+        setTickAntialiasing(painter, true);
 
-    // --- Draw current heading box ---
-    QRectF box(-5, -tapeHeight - 12, 9.5, 6);
-    painter.setBrush(QColor(0, 0, 0, 200));
-    painter.setPen(QPen(Qt::red, 0.5));
-    painter.drawRect(box);
-    painter.setPen(QPen(Qt::green, 0.5));
+        // --- Draw current heading box ---
+        QRectF box(-5, -tapeHeight - 12, 9.5, 6);
+        painter.setBrush(QColor(0, 0, 0, 200));
+        painter.setPen(QPen(Qt::red, 0.5));
+        painter.drawRect(box);
 
-    // Normalize displayed heading
-    int displayHeading = int(heading) % 360;
-    if (displayHeading < 0) displayHeading += 360;
+        // Normalize displayed heading
+        int displayHeading = int(telemetry.heading) % 360;
+        if (displayHeading < 0) displayHeading += 360;
 
-    QString text = QString::number(displayHeading);
-    text = text.rightJustified(3, '0');
-    painter.drawText(-3, -tapeHeight - 8, text);
+        char text[8];
+        int length = textformat::appendInt(text, displayHeading, 3);
+        monoGreenGlyphs.draw(painter, -3, -tapeHeight - 8, text, length);
 
-    painter.restore();
-}
+        painter.restore();
+    }
 
     void drawFlightMode(QPainter &painter) {
         painter.save();
 
         painter.setPen(QPen(Qt::yellow, 0.5));
-        painter.setFont(QFont(customFontFamily, 3));
-        painter.drawText(-(flightMode.length()), -85, QString::fromStdString(flightMode));
+        painter.setFont(customFont);
+        // Re-laid out only when the mode string changes
+        drawLabel(painter, -qreal(telemetry.flightMode.length()), -85, customAscent, flightModeText);
+
+        painter.restore();
     }
 
     void drawClock(QPainter &painter) {
         painter.save();
 
-        painter.setPen(QPen(Qt::white, 0.5));
-        painter.setFont(QFont(customFontFamily, 3));
-        painter.drawText(-70, 90 - 8, "CLK (GMT)");
-        painter.setPen(QPen(Qt::yellow, 0.5));
-        painter.drawText(-69.75, 95 - 8, QString::fromLatin1(currTime));
+        customYellowGlyphs.draw(painter, -69.75, 95 - 8, telemetry.clock, int(std::strlen(telemetry.clock)));
+
+        painter.restore();
     }
 
     void drawGauges(QPainter &painter) {
         painter.save();
 
-        const int radius = 8;
-
-
+        // Arcs and "RPM #n" captions live in the static layer
         int oldPos = -47.5;
-        for (int i=1; i<=propQuantity; i++) {
-            painter.setPen(QPen(Qt::red, 0.5));
-            painter.drawArc(-95, oldPos, 2*radius, 2*radius, 180 * 16, 270 * 16);
-            painter.setPen(QPen(Qt::yellow, 0.5));
-            painter.setFont(QFont(customFontFamily, 3));
-            QString textRpm = QString::number(int(rpm[i-1]));
-            painter.drawText(-92.5, oldPos + 20, "RPM #" + QString::number(i));
-            painter.setPen(QPen(Qt::white, 0.5));
-            painter.drawText(-90, oldPos + 10, textRpm);
+        for (int i=1; i<=telemetry.propQuantity; i++) {
+            char textRpm[16];
+            int length = textformat::appendInt(textRpm, telemetry.rpm[i-1]);
+            customWhiteGlyphs.draw(painter, -90, oldPos + 10, textRpm, length);
 
             oldPos += 25;
         }
@@ -539,63 +1137,198 @@ private:
             painter.drawLine(75, -40, 70, -40); // short ticks 10,20
             painter.restore();
         }*/
+
+        painter.restore();
     }
 
     void drawBattery(QPainter &painter) {
         painter.save();
 
-        QString textBattery = QString::number(float(batteryState), 'f',1);
-        painter.drawText(60, -70, "BATTERY:");
+        char text[16];
+        int length = textformat::appendFixed(text, telemetry.batteryVolts, 1);
+        length += textformat::appendText(text + length, "V");
+        customWhiteGlyphs.draw(painter, 75, -70, text, length);
+
         painter.setPen(QPen(Qt::white, 0.5));
-        painter.drawText(75, -70, textBattery + "V");
 
         QRectF box(60, -71 - 12, 25, 6);
         painter.setBrush(QColor(0, 0, 0, 200));
         painter.drawRect(box);
 
-        const float width = 25 * batteryLevel;
+        const float width = 25 * telemetry.batteryLevel;
 
         QRectF fill(60, -71 - 12, width, 6);
         painter.fillRect(fill, "#ffffffff");
-        painter.setPen(QPen(Qt::yellow, 0.5));
-        painter.drawText(60, -74, QString::number(float(batteryLevel * 100), 'f',1) + "%");
+        length = textformat::appendFixed(text, telemetry.batteryLevel * 100, 1);
+        length += textformat::appendText(text + length, "%");
+        customYellowGlyphs.draw(painter, 60, -74, text, length);
+        painter.restore();
+    }
+
+    // Debug table of LatencyStats, toggled with setLatencyOverlayVisible()
+    void drawLatencyOverlay(QPainter &painter) {
+        if (!latencyOverlayVisible || !latencyStats) return;
+        painter.save();
+
+        QRectF box(-42, 53, 84, 42.5);
+        painter.setBrush(QColor(0, 0, 0, 200));
+        painter.setPen(QPen(Qt::green, 0.3));
+        painter.drawRect(box);
+
+        // Fixed columns in the monospaced font: name, p50, p99, max
+        auto pad = [](char *line, int length, int column) {
+            while (length < column) line[length++] = ' ';
+            return length;
+        };
+        auto appendMs = [&](char *line, int length, int column, std::int64_t ns) {
+            char value[16];
+            int valueLength = textformat::appendFixed(value, ns / 1e6, 1);
+            length = pad(line, length, column - valueLength);
+            for (int i = 0; i < valueLength; i++) line[length++] = value[i];
+            return length;
+        };
+
+        const qreal lineHeight = 4.5;
+        qreal baseline = 57.5;
+        char line[48];
+        int length = textformat::appendText(line, "LATENCY ms       p50   p99   max");
+        monoGreenGlyphs.draw(painter, -40, baseline, line, length);
+
+        for (int stage = 0; stage < LatencyStats::StageCount; stage++) {
+            const LatencyHistogram &h = latencyStats->histogram(stage);
+            baseline += lineHeight;
+            length = textformat::appendText(line, LatencyStats::stageName(stage));
+            length = appendMs(line, length, 20, h.percentileNs(0.50));
+            length = appendMs(line, length, 26, h.percentileNs(0.99));
+            length = appendMs(line, length, 32, h.maxValueNs());
+            monoGreenGlyphs.draw(painter, -40, baseline, line, length);
+        }
+
+        // Paint time per frame, and the quality level it bought
+        const LatencyHistogram &paint = governor.paintTimes();
+        baseline += lineHeight;
+        length = textformat::appendText(line, "paint");
+        length = appendMs(line, length, 20, paint.percentileNs(0.50));
+        length = appendMs(line, length, 26, paint.percentileNs(0.99));
+        length = appendMs(line, length, 32, paint.maxValueNs());
+        monoGreenGlyphs.draw(painter, -40, baseline, line, length);
+
+        baseline += lineHeight;
+        length = textformat::appendText(line, FrameTimeGovernor::qualityName(governor.quality()));
+        if (!governor.isAdaptive()) length += textformat::appendText(line + length, " (HELD)");
+        length = pad(line, length, 20);
+        length += textformat::appendText(line + length, "budget");
+        length = appendMs(line, length, 32, governor.budgetNs());
+        monoGreenGlyphs.draw(painter, -40, baseline, line, length);
+
+        // Samples that never made it to a frame
+        baseline += lineHeight;
+        length = textformat::appendText(line, "dropped ");
+        length += textformat::appendInt(line + length, static_cast<long long>(latencyStats->droppedCount()));
+        length = pad(line, length, 20);
+        length += textformat::appendText(line + length, "coalesced ");
+        length += textformat::appendInt(line + length, static_cast<long long>(latencyStats->coalescedCount()));
+        monoGreenGlyphs.draw(painter, -40, baseline, line, length);
+
+        painter.restore();
+    }
+
+    // Over the attitude, so nobody flies on a frozen horizon: how long ago
+    // the newest data arrived, once that is longer than staleAfterNs
+    void drawStaleWarning(QPainter &painter) {
+        if (telemetry.staleMs <= 0) return;
+        painter.save();
+
+        QRectF box(-20, -30, 40, 11);
+        painter.setBrush(QColor(0, 0, 0, 200));
+        painter.setPen(QPen(Qt::red, 0.8));
+        painter.drawRect(box);
+
+        painter.setFont(customFont);
+        painter.drawText(QRectF(-20, -30, 40, 5.5), Qt::AlignCenter, "NO DATA");
+
+        char text[16];
+        int length = textformat::appendFixed(text, telemetry.staleMs / 1000.0, 1);
+        length += textformat::appendText(text + length, " S");
+        customYellowGlyphs.draw(painter, -length * 0.9, -21, text, length);
+
         painter.restore();
     }
 
     void drawQNH(QPainter &painter) {
         painter.save();
 
-        painter.setPen(QPen(Qt::white, 0.5));
-        QString textQNH = QString::number(float(QNH*33.865), 'f',2);
-        painter.drawText(55, 70, "INHG");
-        painter.setPen(QPen(Qt::yellow, 0.5));
-        painter.drawText(65, 70, textQNH);
+        // "INHG"/"HPA" captions live in the static layer
+        char text[16];
+        int length = textformat::appendFixed(text, telemetry.qnh, 2);
+        customYellowGlyphs.draw(painter, 65, 70, text, length);
 
-        painter.setPen(QPen(Qt::white, 0.5));
-        QString textHPa = QString::number(float(QNH), 'f',2);
-        painter.drawText(55, 75, "HPA");
-        painter.setPen(QPen(Qt::yellow, 0.5));
-        painter.drawText(65, 75, textHPa);
+        length = textformat::appendFixed(text, telemetry.qnhHpa, 2);
+        customYellowGlyphs.draw(painter, 65, 75, text, length);
 
         painter.restore();
     }
 
 private:
-    float pitch; // degrees
-    float roll;  // degrees
-    float altitude;
-    float speed;
-    float heading;
-    int rpm[4];
-    float batteryState;
-    float batteryLevel;
-    int propQuantity;
-    float QNH;
-    float OAT;
-    std::string flightMode;
-    std::string currTime;
+    TelemetrySnapshot telemetry;  // Latest values; instruments may lag by their refresh interval
+    std::int64_t flightModeRevision = 0;
+
+    bool antialiasing = true;
+
+    // Adaptive render quality, see setTargetFrameRate(). Tiles read
+    // renderQuality, which changes only between frames.
+    FrameTimeGovernor governor;
+    FrameTimeGovernor::Quality renderQuality = FrameTimeGovernor::Full;
+
+    // Latency measurement, see setLatencyStats()
+    LatencyStats *latencyStats = nullptr;
+    bool latencyOverlayVisible = false;
+    std::int64_t presentedHandoffNs = 0;
+    bool attitudeRepaintPending = false;  // The horizon moved since the last paint
+    bool firstFrameDone = false;  // See firstFramePainted()
+
+    // Instrument registry, see registerInstruments()
+    std::vector<Instrument> instruments;
+    QElapsedTimer instrumentClock;
+    QTimer throttleTimer;  // Catches up changes held back by a refresh interval
     QString customFontFamily;  // Custom font name
     QString nimbusMono;  // Custom font name
+
+    // Instrument tiles, see renderTiles()
+    bool parallelRendering = true;
+    std::vector<std::unique_ptr<TileJob>> tileJobs;
+    std::vector<int> staleTiles;
+    QSemaphore tilesDone;
+
+    // Pre-rendered instrument geometry and captions that never move
+    QPixmap staticLayer;
+    bool staticLayerDirty = true;
+
+    // Fonts resolved once in resolveFonts()
+    QFont customFont;
+    QFont monoFont;
+
+    // Glyph atlases and metrics for live readouts, see ensureTextCache()
+    GlyphAtlas monoGreenGlyphs;
+    GlyphAtlas customWhiteGlyphs;
+    GlyphAtlas customYellowGlyphs;
+    qreal monoAscent = 0;
+    qreal customAscent = 0;
+    qreal textCacheScale = 0;
+    bool textCacheDirty = true;
+    QStaticText flightModeText;
+
+    // Scrolling tapes with cached tick labels
+    Tape altitudeTape{altitudeTapeConfig()};
+    Tape speedTape{speedTapeConfig()};
+    Tape headingTape{headingTapeConfig()};
+
+    // Pre-rendered pitch ladder, see ensureLadderStrip(). A QImage, as the
+    // horizon tile draws it on a worker thread.
+    QImage ladderStrip;
+    qreal ladderStripScale = 0;
+    float ladderStripZoom = 0;
+    bool ladderStripDirty = true;
 };
 
 #endif // ATTITUDEINDICATOR_H
\ No newline at end of file
@@ -0,0 +1,113 @@
+#ifndef ATTITUDEINTERPOLATOR_H
+#define ATTITUDEINTERPOLATOR_H
+
+#include <cmath>
+#include <cstdint>
+#include "telemetrysample.h"
+
+// Turns ~50 Hz attitude samples into a value for any display frame time.
+// Frames are evaluated at (now - renderDelay): between the last two samples
+// the attitude is interpolated, past the newest one it is extrapolated along
+// their slope for at most maxExtrapolation, after which the newest sample is
+// shown as is. The default render delay, autoRenderDelay, is one measured
+// sample period: interpolation while samples arrive on time, at the cost of
+// that period in latency. Zero gives the lowest latency, always extrapolating.
+class AttitudeInterpolator {
+public:
+    struct Attitude {
+        float pitch = 0.0f;  // degrees
+        float roll = 0.0f;   // degrees
+    };
+
+    static constexpr std::int64_t autoRenderDelay = -1;
+    static constexpr std::int64_t defaultMaxExtrapolationNs = 40'000'000;  // Two sample periods at 50 Hz
+
+    void setMaxExtrapolationNs(std::int64_t ns) { maxExtrapolationNs = ns; }
+    void setRenderDelayNs(std::int64_t ns) { renderDelayNs = ns; }
+    std::int64_t maxExtrapolation() const { return maxExtrapolationNs; }
+
+    // The delay in effect: with autoRenderDelay, the smoothed sample period
+    std::int64_t renderDelay() const {
+        return renderDelayNs >= 0 ? renderDelayNs : static_cast<std::int64_t>(smoothedIntervalNs);
+    }
+
+    void addSample(const TelemetrySample &sample) {
+        previous = newest;
+        newest.timestampNs = sample.timestampNs;
+        newest.sensorTimeMs = sample.sensorTimeMs;
+        newest.pitch = sample.pitch;
+        newest.roll = sample.roll;
+        count = count < 2 ? count + 1 : 2;
+
+        // Averaged over about eight samples, so a USB transfer bunching two
+        // together does not swing the delay
+        const double interval = count == 2 ? sampleIntervalNs() : 0.0;
+        if (interval > 0 && interval < maxSampleIntervalNs) {
+            smoothedIntervalNs = smoothedIntervalNs > 0 ? smoothedIntervalNs + (interval - smoothedIntervalNs) / 8
+                                                         : interval;
+        }
+    }
+
+    bool hasSample() const { return count > 0; }
+
+    Attitude at(std::int64_t nowNs) const {
+        Attitude result;
+        if (count == 0) return result;
+
+        result.pitch = newest.pitch;
+        result.roll = newest.roll;
+        if (count < 2) return result;
+
+        const std::int64_t t = nowNs - renderDelay();
+        const std::int64_t ahead = t - newest.timestampNs;
+        if (ahead > maxExtrapolationNs) return result;  // Stale: no guessing
+
+        // Fraction of one sample interval past the newest sample, negative
+        // while still between the two.
+        const double interval = sampleIntervalNs();
+        if (interval <= 0) return result;
+        double fraction = ahead / interval;
+        if (fraction < -1.0) fraction = -1.0;
+
+        result.pitch = static_cast<float>(newest.pitch + (newest.pitch - previous.pitch) * fraction);
+        result.roll = wrap180(static_cast<float>(newest.roll + wrap180(newest.roll - previous.roll) * fraction));
+        return result;
+    }
+
+private:
+    // Longer is a gap in the stream, not its rate
+    static constexpr std::int64_t maxSampleIntervalNs = 1'000'000'000;
+
+    struct Stamped {
+        std::int64_t timestampNs = 0;
+        std::uint32_t sensorTimeMs = 0;
+        float pitch = 0.0f;
+        float roll = 0.0f;
+    };
+
+    // Sender clock when both samples carry it: arrival times bunch up when
+    // the USB bridge delivers two samples in one transfer.
+    double sampleIntervalNs() const {
+        if (newest.sensorTimeMs != 0 && previous.sensorTimeMs != 0) {
+            std::uint32_t ms = newest.sensorTimeMs - previous.sensorTimeMs;
+            if (ms > 0 && ms < maxSampleIntervalNs / 1'000'000) return ms * 1e6;
+        }
+        return static_cast<double>(newest.timestampNs - previous.timestampNs);
+    }
+
+    // Roll crosses +-180 when inverted
+    static float wrap180(float degrees) {
+        degrees = std::fmod(degrees + 180.0f, 360.0f);
+        if (degrees < 0) degrees += 360.0f;
+        return degrees - 180.0f;
+    }
+
+    Stamped previous;
+    Stamped newest;
+    int count = 0;
+    std::int64_t maxExtrapolationNs = defaultMaxExtrapolationNs;
+    std::int64_t renderDelayNs = autoRenderDelay;
+    double smoothedIntervalNs = 0;  // 0 until two samples have arrived
+};
+
+#endif // ATTITUDEINTERPOLATOR_H
@@ -0,0 +1,203 @@
+// Derived air data benchmark for AirData.
+//
+// Flies a synthetic climb, cruise and descent with steady turns at --rate
+// for --samples samples, with the pressure altitude as arrays, as a replay
+// or log analysis would hold them. It derives the air data one sample at a
+// time through add(), as the display does, and in --chunk sized batches
+// through addBatch(), with SIMD lanes and with the portable kernel. For each
+// it reports ns per sample and the worst error of the altitudes against the
+// ISA in double precision, and of vertical speed and turn rate against the
+// flight's own once the low-pass has settled. Exits 1 if an altitude is off
+// by more than a foot.
+//
+//   airdata_bench [--samples 4000000] [--rate 50] [--chunk 4096]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "airdata.h"
+
+namespace {
+
+struct Options {
+    long long samples = 4'000'000;
+    double rate = 50.0;
+    std::size_t chunk = 4096;
+};
+
+struct Flight {
+    std::vector<std::int64_t> timeNs;
+    std::vector<float> pressureAltitude;
+    std::vector<float> heading;
+    std::vector<float> verticalSpeed;  // Truth, ft/min
+    std::vector<float> turnRate;       // Truth, deg/s
+};
+
+struct RunResult {
+    double sampleNs = 0;
+    double baroError = 0;      // ft
+    double densityError = 0;   // ft
+    double verticalSpeedError = 0;  // ft/min
+    double turnRateError = 0;  // deg/s
+};
+
+bool parseOptions(int argc, char **argv, Options &options) {
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (value && std::strcmp(arg, "--samples") == 0) {
+            options.samples = std::atoll(value); i++;
+        } else if (value && std::strcmp(arg, "--rate") == 0) {
+            options.rate = std::atof(value); i++;
+        } else if (value && std::strcmp(arg, "--chunk") == 0) {
+            options.chunk = static_cast<std::size_t>(std::atoll(value)); i++;
+        } else {
+            std::fprintf(stderr, "usage: %s [--samples N] [--rate HZ] [--chunk N]\n", argv[0]);
+            return false;
+        }
+    }
+    return options.samples > 0 && options.rate > 0 && options.chunk > 0;
+}
+
+// Ten minute cycles between 500 and 12,500 ft at up to 2,000 ft/min, turning
+// at up to 3 deg/s
+Flight fly(const Options &options) {
+    Flight flight;
+    const std::size_t count = static_cast<std::size_t>(options.samples);
+    flight.timeNs.resize(count);
+    flight.pressureAltitude.resize(count);
+    flight.heading.resize(count);
+    flight.verticalSpeed.resize(count);
+    flight.turnRate.resize(count);
+
+    const double pi = 3.14159265358979323846;
+    const double cycle = 2 * pi / 600.0;
+    for (std::size_t i = 0; i < count; i++) {
+        const double t = i / options.rate;
+        flight.timeNs[i] = static_cast<std::int64_t>(t * 1e9);
+        flight.pressureAltitude[i] = static_cast<float>(6500.0 - 6000.0 * std::cos(t * cycle));
+        flight.verticalSpeed[i] = static_cast<float>(6000.0 * cycle * std::sin(t * cycle) * 60.0);
+        flight.heading[i] = static_cast<float>(std::fmod(3.0 * 600.0 / (2 * pi) * (1.0 - std::cos(t * cycle)), 360.0));
+        flight.turnRate[i] = static_cast<float>(3.0 * std::sin(t * cycle));
+    }
+    return flight;
+}
+
+double isaBaroAltitude(double pressureAltitude, double qnhHpa) {
+    const double h = AirData::scaleHeight, k = AirData::pressureExponent;
+    const double pressure = AirData::seaLevelPressureHpa * std::pow(1.0 - pressureAltitude / h, 1.0 / k);
+    return h * (1.0 - std::pow(pressure / qnhHpa, k));
+}
+
+double isaDensityAltitude(double pressureAltitude, double oatCelsius) {
+    const double h = AirData::scaleHeight, k = AirData::pressureExponent;
+    const double pressureRatio = std::pow(1.0 - pressureAltitude / h, 1.0 / k);
+    const double densityRatio = pressureRatio * AirData::seaLevelTemperatureK / (oatCelsius + AirData::kelvinAtZeroCelsius);
+    return h * (1.0 - std::pow(densityRatio, k / (1.0 - k)));
+}
+
+// Worst errors over every 97th sample past the first minute
+void measureErrors(const Options &options, const Flight &flight, const AirData &airData,
+                   const std::vector<float> &baro, const std::vector<float> &density,
+                   const std::vector<float> &verticalSpeed, const std::vector<float> &turnRate, RunResult &result) {
+    const std::size_t settled = static_cast<std::size_t>(60 * options.rate);
+    for (std::size_t i = settled; i < baro.size(); i += 97) {
+        const double altitude = flight.pressureAltitude[i];
+        result.baroError = std::max(result.baroError, std::fabs(baro[i] - isaBaroAltitude(altitude, airData.qnhHpa())));
+        result.densityError = std::max(result.densityError,
+            std::fabs(density[i] - isaDensityAltitude(altitude, airData.outsideAirTemperature())));
+        result.verticalSpeedError = std::max(result.verticalSpeedError,
+                                             std::fabs(double(verticalSpeed[i]) - flight.verticalSpeed[i]));
+        result.turnRateError = std::max(result.turnRateError, std::fabs(double(turnRate[i]) - flight.turnRate[i]));
+    }
+}
+
+AirData configured() {
+    AirData airData;
+    airData.setQnhHpa(1021.0f);
+    airData.setOutsideAirTemperature(28.0f);
+    return airData;
+}
+
+RunResult runStreaming(const Options &options, const Flight &flight) {
+    AirData airData = configured();
+    const std::size_t count = flight.timeNs.size();
+    std::vector<float> baro(count), density(count), verticalSpeed(count), turnRate(count);
+
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < count; i++) {
+        airData.add(flight.timeNs[i], flight.pressureAltitude[i], flight.heading[i]);
+        const AirData::Values &values = airData.values();
+        baro[i] = values.baroAltitude;
+        density[i] = values.densityAltitude;
+        verticalSpeed[i] = values.verticalSpeed;
+        turnRate[i] = values.turnRate;
+    }
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    RunResult result;
+    result.sampleNs = 1e9 * elapsed / count;
+    measureErrors(options, flight, airData, baro, density, verticalSpeed, turnRate, result);
+    return result;
+}
+
+RunResult runBatch(const Options &options, const Flight &flight, bool vectorized) {
+    AirData airData = configured();
+    airData.setVectorized(vectorized);
+    const std::size_t count = flight.timeNs.size();
+    std::vector<float> baro(count), density(count), verticalSpeed(count), turnRate(count);
+
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t at = 0; at < count; at += options.chunk) {
+        const std::size_t n = std::min(options.chunk, count - at);
+        airData.addBatch(&flight.timeNs[at], &flight.pressureAltitude[at], &flight.heading[at], n,
+                         &baro[at], &density[at], &verticalSpeed[at], &turnRate[at]);
+    }
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    RunResult result;
+    result.sampleNs = 1e9 * elapsed / count;
+    measureErrors(options, flight, airData, baro, density, verticalSpeed, turnRate, result);
+    return result;
+}
+
+const char *simdName() {
+#if HORUS_SIMD_SSE
+    return "SSE";
+#elif HORUS_SIMD_NEON
+    return "NEON";
+#else
+    return "none";
+#endif
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) return 2;
+
+    const Flight flight = fly(options);
+    std::printf("%lld samples at %.0f Hz (%.1f h), batches of %zu, SIMD: %s\n", options.samples, options.rate,
+                options.samples / options.rate / 3600, options.chunk, simdName());
+    std::printf("path       ns/sample   baro ft   density ft   vs ft/min   turn deg/s\n");
+
+    const struct { const char *name; RunResult result; } runs[] = {
+        {"add", runStreaming(options, flight)},
+        {"batch", runBatch(options, flight, true)},
+        {"portable", runBatch(options, flight, false)},
+    };
+    bool accurate = true;
+    for (const auto &run : runs) {
+        const RunResult &r = run.result;
+        std::printf("%-10s %9.2f %9.3f %12.3f %11.1f %12.3f\n", run.name, r.sampleNs, r.baroError, r.densityError,
+                    r.verticalSpeedError, r.turnRateError);
+        accurate = accurate && r.baroError < 1.0 && r.densityError < 1.0;
+    }
+    std::printf("altitudes within a foot of ISA: %s\n", accurate ? "yes" : "NO");
+    return accurate ? 0 : 1;
+}
@@ -0,0 +1,67 @@
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+// Counts heap allocations made by the whole process. Include from exactly one
+// translation unit of a benchmark executable.
+//
+// With glibc, malloc/calloc/realloc are interposed, which also catches Qt's
+// containers (they allocate with malloc, not operator new). Elsewhere only
+// operator new is counted, and allocationCounterKind() says so.
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace benchalloc {
+inline std::atomic<std::uint64_t> &counter() {
+    static std::atomic<std::uint64_t> count{0};
+    return count;
+}
+} // namespace benchalloc
+
+inline std::uint64_t allocationCount() {
+    return benchalloc::counter().load(std::memory_order_relaxed);
+}
+
+#if defined(__GLIBC__)
+
+extern "C" {
+void *__libc_malloc(std::size_t size);
+void *__libc_calloc(std::size_t count, std::size_t size);
+void *__libc_realloc(void *pointer, std::size_t size);
+
+void *malloc(std::size_t size) noexcept {
+    benchalloc::counter().fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void *calloc(std::size_t count, std::size_t size) noexcept {
+    benchalloc::counter().fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *pointer, std::size_t size) noexcept {
+    benchalloc::counter().fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(pointer, size);
+}
+}
+
+inline const char *allocationCounterKind() { return "malloc"; }
+
+#else
+
+void *operator new(std::size_t size) {
+    benchalloc::counter().fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *pointer) noexcept { std::free(pointer); }
+void operator delete(void *pointer, std::size_t) noexcept { std::free(pointer); }
+
+inline const char *allocationCounterKind() { return "operator new"; }
+
+#endif
+
+#endif // ALLOCATIONCOUNTER_H
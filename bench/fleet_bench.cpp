@@ -0,0 +1,255 @@
+// Multi-vehicle load test for FleetWindow.
+//
+// Every vehicle is a pseudo-terminal fed binary frames at --rate by a
+// simulated flight controller; FleetWindow opens the slave ends exactly as it
+// would real ports and paints all PFDs on the offscreen QPA platform. For
+// fleets of 1, 2, 4, ... up to --vehicles it reports the process CPU time
+// (without the simulated vehicles' own), samples delivered against samples
+// sent, ring drops and display ticks per second, then checks that the largest
+// fleet kept up within the machine's cores.
+//
+//   fleet_bench [--vehicles 16] [--rate 50] [--seconds 10] [--size 1920x1080]
+
+#include <QApplication>
+#include <QEventLoop>
+#include <QStringList>
+#include <QTimer>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <termios.h>
+#include <unistd.h>
+#include "fleetwindow.h"
+
+namespace {
+
+struct Options {
+    int vehicles = 16;
+    double rate = 50.0;
+    double seconds = 10.0;
+    int width = 1920;
+    int height = 1080;
+};
+
+struct RunResult {
+    int vehicles = 0;
+    double cpuPercent = 0;       // Of one core
+    double deliveredPercent = 0;
+    std::uint64_t dropped = 0;
+    double ticksPerSecond = 0;
+};
+
+bool parseOptions(int argc, char **argv, Options &options) {
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (value && std::strcmp(arg, "--vehicles") == 0) {
+            options.vehicles = std::atoi(value); i++;
+        } else if (value && std::strcmp(arg, "--rate") == 0) {
+            options.rate = std::atof(value); i++;
+        } else if (value && std::strcmp(arg, "--seconds") == 0) {
+            options.seconds = std::atof(value); i++;
+        } else if (value && std::strcmp(arg, "--size") == 0) {
+            if (std::sscanf(value, "%dx%d", &options.width, &options.height) != 2) return false;
+            i++;
+        } else {
+            std::fprintf(stderr, "usage: %s [--vehicles N] [--rate HZ] [--seconds S] [--size WxH]\n", argv[0]);
+            return false;
+        }
+    }
+    return options.vehicles > 0 && options.rate > 0 && options.seconds > 0 && options.width > 0 && options.height > 0;
+}
+
+double processCpuSeconds() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+double threadCpuSeconds() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+void runEventLoop(int milliseconds) {
+    QEventLoop loop;
+    QTimer::singleShot(milliseconds, &loop, &QEventLoop::quit);
+    loop.exec();
+}
+
+// The simulated vehicles: one frame per vehicle per period, each on its own pty
+class Feeder {
+public:
+    explicit Feeder(double rate) : periodNs(static_cast<std::int64_t>(1e9 / rate)) {}
+
+    ~Feeder() {
+        stop();
+        for (int fd : masters) close(fd);
+    }
+
+    // Returns the slave path for FleetWindow, or an empty string
+    QString addVehicle() {
+        int master = posix_openpt(O_RDWR | O_NOCTTY);
+        if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) return QString();
+        termios tio;
+        tcgetattr(master, &tio);
+        cfmakeraw(&tio);
+        tcsetattr(master, TCSANOW, &tio);
+        masters.push_back(master);
+        return QString::fromLocal8Bit(ptsname(master));
+    }
+
+    void start() {
+        running = true;
+        thread = std::thread([this]() { run(); });
+    }
+
+    void stop() {
+        if (!thread.joinable()) return;
+        running = false;
+        thread.join();
+    }
+
+    std::uint64_t sentCount() const { return sent.load(std::memory_order_relaxed); }
+    double cpuSeconds() const { return cpu.load(std::memory_order_relaxed); }
+
+private:
+    void run() {
+        std::int64_t due = monotonicNowNs();
+        std::uint32_t tick = 0;
+        while (running) {
+            for (std::size_t v = 0; v < masters.size(); v++) {
+                const double phase = tick * periodNs / 1e9 + v * 0.7;
+                HorusTelemetry t = {};
+                t.sequence = static_cast<std::uint16_t>(tick);
+                t.sensorTimeMs = static_cast<std::uint32_t>(tick * periodNs / 1'000'000);
+                t.flags = HORUS_FIELD_ATTITUDE | HORUS_FIELD_ALTITUDE | HORUS_FIELD_SPEED |
+                          HORUS_FIELD_HEADING | HORUS_FIELD_BATTERY | HORUS_FIELD_RPM;
+                t.pitch = static_cast<float>(20.0 * std::sin(phase * 0.7));
+                t.roll = static_cast<float>(45.0 * std::sin(phase * 0.5));
+                t.altitude = static_cast<float>(8500.0 + 300.0 * std::sin(phase * 0.2));
+                t.airspeed = static_cast<float>(70.0 + 20.0 * std::sin(phase * 0.4));
+                t.heading = static_cast<float>(std::fmod(phase * 10.0, 360.0));
+                t.batteryVolts = 12.6f;
+                t.batteryPercent = 80;
+                for (int i = 0; i < 4; i++) t.rpm[i] = static_cast<std::uint16_t>(2500 + 300 * std::sin(phase + i));
+
+                std::uint8_t frame[HORUS_MAX_FRAME_SIZE];
+                const std::size_t length = horusEncodeTelemetry(t, frame);
+                if (write(masters[v], frame, length) == static_cast<ssize_t>(length)) {
+                    sent.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            tick++;
+            cpu.store(threadCpuSeconds(), std::memory_order_relaxed);
+
+            due += periodNs;
+            const std::int64_t wait = due - monotonicNowNs();
+            if (wait > 0) std::this_thread::sleep_for(std::chrono::nanoseconds(wait));
+        }
+    }
+
+    const std::int64_t periodNs;
+    std::vector<int> masters;
+    std::thread thread;
+    std::atomic<bool> running{false};
+    std::atomic<std::uint64_t> sent{0};
+    std::atomic<double> cpu{0};
+};
+
+RunResult runFleet(int vehicles, const Options &options) {
+    RunResult result;
+    result.vehicles = vehicles;
+
+    Feeder feeder(options.rate);
+    QStringList ports;
+    for (int i = 0; i < vehicles; i++) {
+        const QString port = feeder.addVehicle();
+        if (port.isEmpty()) {
+            std::perror("posix_openpt");
+            std::exit(2);
+        }
+        ports << port;
+    }
+
+    FleetWindow fleet(ports);
+    fleet.setCustomFonts("Courier", "Nimbus Mono PS");
+    fleet.resize(options.width, options.height);
+    fleet.show();
+    feeder.start();
+
+    // Ports open, first frames arrive, static layers are built
+    for (int waited = 0; fleet.linkedCount() < vehicles && waited < 2000; waited += 50) runEventLoop(50);
+    if (fleet.linkedCount() < vehicles) {
+        std::fprintf(stderr, "only %d of %d ptys opened\n", fleet.linkedCount(), vehicles);
+        std::exit(2);
+    }
+    runEventLoop(1000);
+
+    const double cpuBefore = processCpuSeconds() - feeder.cpuSeconds();
+    const std::uint64_t sentBefore = feeder.sentCount();
+    const std::uint64_t receivedBefore = fleet.samplesReceived();
+    const std::uint64_t droppedBefore = fleet.samplesDropped();
+    const std::uint64_t ticksBefore = fleet.displayTicks();
+    const std::int64_t startNs = monotonicNowNs();
+
+    runEventLoop(static_cast<int>(options.seconds * 1000));
+
+    const double elapsed = (monotonicNowNs() - startNs) / 1e9;
+    const double cpu = processCpuSeconds() - feeder.cpuSeconds() - cpuBefore;
+    const std::uint64_t sent = feeder.sentCount() - sentBefore;
+    const std::uint64_t received = fleet.samplesReceived() - receivedBefore;
+    feeder.stop();
+
+    result.cpuPercent = 100.0 * cpu / elapsed;
+    result.deliveredPercent = sent ? 100.0 * received / sent : 0.0;
+    result.dropped = fleet.samplesDropped() - droppedBefore;
+    result.ticksPerSecond = (fleet.displayTicks() - ticksBefore) / elapsed;
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) return 2;
+
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+
+    std::vector<int> fleets;
+    for (int n = 1; n < options.vehicles; n *= 2) fleets.push_back(n);
+    fleets.push_back(options.vehicles);
+
+    const int cores = QThread::idealThreadCount();
+    std::printf("%d cores, %.0f Hz per vehicle, %dx%d window, %.0f s per fleet\n",
+                cores, options.rate, options.width, options.height, options.seconds);
+    std::printf("vehicles   cpu %%   cpu %%/vehicle   delivered %%   dropped   display ticks/s\n");
+
+    RunResult last;
+    for (int vehicles : fleets) {
+        last = runFleet(vehicles, options);
+        std::printf("%8d %7.1f %15.2f %13.2f %9llu %17.1f\n", last.vehicles, last.cpuPercent,
+                    last.cpuPercent / last.vehicles, last.deliveredPercent,
+                    static_cast<unsigned long long>(last.dropped), last.ticksPerSecond);
+        std::fflush(stdout);
+    }
+
+    // Kept up: everything delivered, nothing dropped, cores to spare
+    const bool keptUp = last.deliveredPercent >= 99.0 && last.dropped == 0 &&
+                        last.cpuPercent < 100.0 * cores;
+    std::printf("%d vehicles at %.0f Hz: %s (%.0f%% of %d cores)\n", last.vehicles, options.rate,
+                keptUp ? "kept up" : "fell behind", last.cpuPercent / cores, cores);
+    return keptUp ? 0 : 1;
+}
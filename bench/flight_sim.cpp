@@ -0,0 +1,133 @@
+// The flight simulator as a standalone load generator.
+//
+// Flies FlightModel for --seconds at --rate and encodes every step as a
+// binary frame. Without --pty it runs as fast as it can and writes the frames
+// to --output, a capture for `ingest_bench --input`, and prints a hash of the
+// stream: the same seed and rate must give the same hash on every run and
+// machine. With --pty it paces the frames in real time through a
+// pseudo-terminal and prints the slave path to open with `Horus --ports`;
+// --seconds 0 runs until interrupted.
+//
+//   flight_sim [--rate 1000] [--seconds 60] [--seed 1] [--output capture.bin | --pty]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include "flightsimulator.h"
+
+namespace {
+
+struct Options {
+    double rate = 1000.0;
+    double seconds = 60.0;
+    std::uint32_t seed = 1;
+    const char *output = nullptr;
+    bool pty = false;
+};
+
+bool parseOptions(int argc, char **argv, Options &options) {
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (std::strcmp(arg, "--pty") == 0) {
+            options.pty = true;
+        } else if (value && std::strcmp(arg, "--rate") == 0) {
+            options.rate = std::atof(value); i++;
+        } else if (value && std::strcmp(arg, "--seconds") == 0) {
+            options.seconds = std::atof(value); i++;
+        } else if (value && std::strcmp(arg, "--seed") == 0) {
+            options.seed = static_cast<std::uint32_t>(std::strtoul(value, nullptr, 10)); i++;
+        } else if (value && std::strcmp(arg, "--output") == 0) {
+            options.output = value; i++;
+        } else {
+            std::fprintf(stderr, "usage: %s [--rate HZ] [--seconds S] [--seed N] [--output FILE | --pty]\n", argv[0]);
+            return false;
+        }
+    }
+    return options.rate >= FlightModel::minRate && options.rate <= FlightModel::maxRate && options.seconds >= 0 &&
+           !(options.pty && options.output);
+}
+
+// FNV-1a over the frame stream
+std::uint64_t hashBytes(std::uint64_t hash, const std::uint8_t *data, std::size_t length) {
+    for (std::size_t i = 0; i < length; i++) hash = (hash ^ data[i]) * 1099511628211ull;
+    return hash;
+}
+
+int runPty(const Options &options) {
+    PtyWriter pty;
+    if (!pty.open()) {
+        std::perror("posix_openpt");
+        return 2;
+    }
+    std::printf("%s\n", pty.slavePath().c_str());
+    std::fflush(stdout);
+
+    FlightModel model(options.seed, options.rate);
+    const std::int64_t periodNs = static_cast<std::int64_t>(1e9 / options.rate);
+    const std::uint64_t total = static_cast<std::uint64_t>(options.seconds * options.rate);
+    std::uint64_t sent = 0, dropped = 0;
+    TelemetrySample sample;
+    std::uint8_t frame[HORUS_MAX_FRAME_SIZE];
+    std::int64_t due = monotonicNowNs();
+    for (std::uint64_t n = 0; total == 0 || n < total; n++) {
+        model.step();
+        model.fill(sample);
+        const std::size_t length = horusEncodeTelemetry(toHorusTelemetry(sample, static_cast<std::uint16_t>(n)), frame);
+        if (pty.write(frame, length)) sent++;
+        else dropped++;
+
+        due += periodNs;
+        const std::int64_t wait = due - monotonicNowNs();
+        if (wait > 0) std::this_thread::sleep_for(std::chrono::nanoseconds(wait));
+    }
+    std::fprintf(stderr, "%llu frames sent, %llu dropped while nobody read\n",
+                 static_cast<unsigned long long>(sent), static_cast<unsigned long long>(dropped));
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) return 2;
+    if (options.pty) return runPty(options);
+
+    std::FILE *file = nullptr;
+    if (options.output && !(file = std::fopen(options.output, "wb"))) {
+        std::fprintf(stderr, "could not write %s\n", options.output);
+        return 2;
+    }
+
+    FlightModel model(options.seed, options.rate);
+    const std::uint64_t total = static_cast<std::uint64_t>(options.seconds * options.rate);
+    std::uint64_t hash = 14695981039346656037ull, bytes = 0;
+    TelemetrySample sample;
+    std::uint8_t frame[HORUS_MAX_FRAME_SIZE];
+
+    const auto start = std::chrono::steady_clock::now();
+    for (std::uint64_t n = 0; n < total; n++) {
+        model.step();
+        model.fill(sample);
+        const std::size_t length = horusEncodeTelemetry(toHorusTelemetry(sample, static_cast<std::uint16_t>(n)), frame);
+        hash = hashBytes(hash, frame, length);
+        bytes += length;
+        if (file && std::fwrite(frame, 1, length, file) != length) {
+            std::fprintf(stderr, "could not write %s\n", options.output);
+            std::fclose(file);
+            return 2;
+        }
+    }
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (file) std::fclose(file);
+
+    std::printf("flight       %.0f s at %.0f Hz, seed %u\n", options.seconds, options.rate, options.seed);
+    std::printf("frames       %llu, %.1f MB\n", static_cast<unsigned long long>(total), bytes / 1e6);
+    std::printf("speed        %.0f steps/s, %.0fx real time\n", total / elapsed, options.seconds / elapsed);
+    std::printf("stream hash  %016llx\n", static_cast<unsigned long long>(hash));
+    std::printf("final        pitch %.1f roll %.1f heading %.0f alt %.0f ft speed %.0f kts battery %.0f%%\n",
+                sample.pitch, sample.roll, sample.heading, sample.altitude, sample.airspeed, sample.batteryLevel * 100);
+    return 0;
+}
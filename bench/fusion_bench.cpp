@@ -0,0 +1,220 @@
+// Host sensor fusion benchmark for SensorFusion.
+//
+// Simulates every vehicle's MPU6050 at --rate: a known attitude trajectory
+// is turned into the raw accel/gyro the sensor would report (quantised to
+// LSBs, with noise and gyro bias), queued into one SensorFusion and fused in
+// display-sized batches, as FleetWindow does once per display tick. For
+// Madgwick and Mahony, with SIMD lanes and with the portable kernel, it
+// reports the cost per batch and per sample and the attitude error against
+// the truth once the filter has settled.
+//
+//   fusion_bench [--vehicles 64] [--rate 1000] [--seconds 20] [--display-hz 60]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "sensorfusion.h"
+
+namespace {
+
+struct Options {
+    int vehicles = 64;
+    double rate = 1000.0;
+    double seconds = 20.0;
+    double displayHz = 60.0;
+};
+
+struct RunResult {
+    double batchUs = 0;          // Mean fuse() time
+    double worstBatchUs = 0;
+    double sampleNs = 0;         // Per sample, over all vehicles
+    double pitchErrorDeg = 0;    // RMS after the first two seconds
+    double rollErrorDeg = 0;
+};
+
+bool parseOptions(int argc, char **argv, Options &options) {
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (value && std::strcmp(arg, "--vehicles") == 0) {
+            options.vehicles = std::atoi(value); i++;
+        } else if (value && std::strcmp(arg, "--rate") == 0) {
+            options.rate = std::atof(value); i++;
+        } else if (value && std::strcmp(arg, "--seconds") == 0) {
+            options.seconds = std::atof(value); i++;
+        } else if (value && std::strcmp(arg, "--display-hz") == 0) {
+            options.displayHz = std::atof(value); i++;
+        } else {
+            std::fprintf(stderr, "usage: %s [--vehicles N] [--rate HZ] [--seconds S] [--display-hz HZ]\n", argv[0]);
+            return false;
+        }
+    }
+    return options.vehicles > 0 && options.rate > 0 && options.seconds > 0 && options.displayHz > 0;
+}
+
+// One simulated vehicle: body rates drive a true quaternion, and the
+// sensor reports those rates and the gravity it sees in its own frame
+class SimulatedImu {
+public:
+    explicit SimulatedImu(unsigned seed) : random(seed) {
+        std::uniform_real_distribution<float> phase(0.0f, 6.28f);
+        for (float &p : phases) p = phase(random);
+        std::normal_distribution<float> bias(0.0f, 0.5f);  // deg/s
+        for (float &b : gyroBias) b = bias(random);
+    }
+
+    void step(double t, double dt, TelemetrySample &sample) {
+        // Gentle manoeuvring: up to ~60 deg/s about every axis
+        const float rates[3] = {
+            static_cast<float>(0.8 * std::sin(0.7 * t + phases[0])),
+            static_cast<float>(1.0 * std::sin(0.5 * t + phases[1])),
+            static_cast<float>(0.4 * std::sin(0.3 * t + phases[2])),
+        };
+        integrate(rates, static_cast<float>(dt));
+
+        std::normal_distribution<float> accelNoise(0.0f, 0.02f);  // g
+        std::normal_distribution<float> gyroNoise(0.0f, 0.3f);    // deg/s
+        const float gravity[3] = {
+            2.0f * (q[1] * q[3] - q[0] * q[2]),
+            2.0f * (q[0] * q[1] + q[2] * q[3]),
+            q[0] * q[0] - q[1] * q[1] - q[2] * q[2] + q[3] * q[3],
+        };
+        for (int i = 0; i < 3; i++) {
+            sample.accel[i] = quantise((gravity[i] + accelNoise(random)) * HORUS_ACCEL_LSB_PER_G);
+            const float dps = static_cast<float>(rates[i] * 180.0 / SensorFusion::pi) + gyroBias[i] + gyroNoise(random);
+            sample.gyro[i] = quantise(dps * HORUS_GYRO_LSB_PER_DPS);
+        }
+        sample.fields = HORUS_FIELD_RAW_IMU;
+    }
+
+    SensorFusion::Attitude truth() const { return SensorFusion::toAttitude(q[0], q[1], q[2], q[3]); }
+
+private:
+    void integrate(const float rates[3], float dt) {
+        const float gx = rates[0], gy = rates[1], gz = rates[2];
+        const float d0 = 0.5f * (-q[1] * gx - q[2] * gy - q[3] * gz);
+        const float d1 = 0.5f * (q[0] * gx + q[2] * gz - q[3] * gy);
+        const float d2 = 0.5f * (q[0] * gy - q[1] * gz + q[3] * gx);
+        const float d3 = 0.5f * (q[0] * gz + q[1] * gy - q[2] * gx);
+        q[0] += d0 * dt; q[1] += d1 * dt; q[2] += d2 * dt; q[3] += d3 * dt;
+        const float norm = 1.0f / std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+        for (float &c : q) c *= norm;
+    }
+
+    static std::int16_t quantise(float lsb) {
+        return static_cast<std::int16_t>(std::clamp(std::lround(lsb), -32768l, 32767l));
+    }
+
+    std::mt19937 random;
+    float phases[3] = {};
+    float gyroBias[3] = {};
+    float q[4] = {1.0f, 0.0f, 0.0f, 0.0f};
+};
+
+float angleError(float a, float b) {
+    float d = std::fmod(a - b + 540.0f, 360.0f) - 180.0f;
+    return d;
+}
+
+RunResult run(const Options &options, FusionAlgorithm algorithm, bool vectorized) {
+    SensorFusion fusion(algorithm);
+    fusion.setVectorized(vectorized);
+    std::vector<SimulatedImu> imus;
+    for (int v = 0; v < options.vehicles; v++) {
+        fusion.addVehicle();
+        imus.emplace_back(1234u + v);
+    }
+
+    const double dt = 1.0 / options.rate;
+    const long long samplesPerVehicle = static_cast<long long>(options.seconds * options.rate);
+    const int perBatch = std::max(1, static_cast<int>(std::lround(options.rate / options.displayHz)));
+    const long long settled = static_cast<long long>(2.0 * options.rate);
+
+    std::vector<int> lastSlot(options.vehicles, -1);
+    double fuseSeconds = 0, worstBatch = 0, pitchSquared = 0, rollSquared = 0;
+    long long batches = 0, errorCount = 0;
+
+    TelemetrySample sample;
+    for (long long n = 0; n < samplesPerVehicle; n += perBatch) {
+        const long long end = std::min(samplesPerVehicle, n + perBatch);
+        for (int v = 0; v < options.vehicles; v++) {
+            for (long long k = n; k < end; k++) {
+                imus[v].step(k * dt, dt, sample);
+                sample.sensorTimeMs = 0;
+                sample.timestampNs = static_cast<std::int64_t>(k * dt * 1e9);
+                lastSlot[v] = fusion.add(v, sample);
+            }
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        fusion.fuse();
+        const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        fuseSeconds += elapsed;
+        worstBatch = std::max(worstBatch, elapsed);
+        batches++;
+
+        if (n < settled) continue;
+        for (int v = 0; v < options.vehicles; v++) {
+            const SensorFusion::Attitude fused = fusion.attitude(v, lastSlot[v]);
+            const SensorFusion::Attitude truth = imus[v].truth();
+            const float pitchError = angleError(fused.pitch, truth.pitch);
+            const float rollError = angleError(fused.roll, truth.roll);
+            pitchSquared += pitchError * pitchError;
+            rollSquared += rollError * rollError;
+            errorCount++;
+        }
+    }
+
+    RunResult result;
+    result.batchUs = 1e6 * fuseSeconds / batches;
+    result.worstBatchUs = 1e6 * worstBatch;
+    result.sampleNs = 1e9 * fuseSeconds / (static_cast<double>(samplesPerVehicle) * options.vehicles);
+    result.pitchErrorDeg = errorCount ? std::sqrt(pitchSquared / errorCount) : 0;
+    result.rollErrorDeg = errorCount ? std::sqrt(rollSquared / errorCount) : 0;
+    return result;
+}
+
+const char *simdName() {
+#if HORUS_SIMD_SSE
+    return "SSE";
+#elif HORUS_SIMD_NEON
+    return "NEON";
+#else
+    return "none";
+#endif
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) return 2;
+
+    std::printf("%d vehicles at %.0f Hz, %.0f s, fused at %.0f Hz, SIMD: %s\n", options.vehicles,
+                options.rate, options.seconds, options.displayHz, simdName());
+    std::printf("filter     kernel     us/batch   worst us   ns/sample   pitch rms   roll rms\n");
+
+    const struct { FusionAlgorithm algorithm; const char *name; } filters[] = {
+        {FusionAlgorithm::Madgwick, "madgwick"},
+        {FusionAlgorithm::Mahony, "mahony"},
+    };
+    bool keptUp = true;
+    for (const auto &filter : filters) {
+        for (bool vectorized : {true, false}) {
+            const RunResult r = run(options, filter.algorithm, vectorized);
+            std::printf("%-10s %-8s %10.2f %10.2f %11.2f %10.2f %10.2f\n", filter.name,
+                        vectorized ? "simd" : "scalar", r.batchUs, r.worstBatchUs, r.sampleNs,
+                        r.pitchErrorDeg, r.rollErrorDeg);
+            std::fflush(stdout);
+            // Real time: one batch has a display period to finish in
+            if (vectorized) keptUp = keptUp && r.batchUs < 1e6 / options.displayHz;
+        }
+    }
+    std::printf("%d vehicles at %.0f Hz: %s\n", options.vehicles, options.rate, keptUp ? "kept up" : "fell behind");
+    return keptUp ? 0 : 1;
+}
@@ -0,0 +1,364 @@
+// Serial ingest throughput through SerialReader::ingest(), the exact code
+// that runs on readyRead: LineBuffer, line splitting, field parsing and the
+// ring push for CSV, or the frame decoders for binary and MAVLink streams.
+//
+// The stream is a capture file (--input, raw bytes as read from the port or
+// an autopilot's telemetry link) or a synthetic one in the firmware's format,
+// or an autopilot's at full stream rates for --format mavlink. It is replayed for --seconds in
+// random chunks of --chunk MIN:MAX bytes, optionally with corrupted lines and
+// missing newlines, and the tool reports lines/s, bytes/s, allocations per
+// line and how many 50 Hz vehicles one core keeps up with. Exits 1 if a
+// sample with a NaN or infinite attitude gets through. With --record the
+// samples also go to a flight recorder, to measure what recording costs.
+//
+//   ingest_bench [--input capture.bin] [--format auto|csv|binary|mavlink]
+//                [--seconds 3] [--chunk 1:64] [--corrupt-every N]
+//                [--drop-newline-every N] [--seed N] [--record DIR [--record-raw]]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "allocationcounter.h"
+#include "ingestharness.h"
+
+namespace {
+
+struct Options {
+    const char *input = nullptr;
+    SerialReader::WireFormat format = SerialReader::WireFormat::Auto;
+    bool binary = false;  // Synthetic stream kind
+    bool mavlink = false;
+    double seconds = 3.0;
+    std::uint32_t minChunk = 1;
+    std::uint32_t maxChunk = 64;  // One USB full-speed bulk packet
+    long corruptEvery = 0;
+    long dropNewlineEvery = 0;
+    unsigned seed = 1;
+    const char *record = nullptr;
+    bool recordRaw = false;
+};
+
+bool parseOptions(int argc, char **argv, Options &options) {
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (value && std::strcmp(arg, "--input") == 0) {
+            options.input = value; i++;
+        } else if (value && std::strcmp(arg, "--format") == 0) {
+            if (std::strcmp(value, "csv") == 0) {
+                options.format = SerialReader::WireFormat::Csv;
+            } else if (std::strcmp(value, "binary") == 0) {
+                options.format = SerialReader::WireFormat::Binary;
+                options.binary = true;
+            } else if (std::strcmp(value, "mavlink") == 0) {
+                options.format = SerialReader::WireFormat::Mavlink;
+                options.mavlink = true;
+            } else if (std::strcmp(value, "auto") != 0) {
+                return false;
+            }
+            i++;
+        } else if (value && std::strcmp(arg, "--seconds") == 0) {
+            options.seconds = std::atof(value); i++;
+        } else if (value && std::strcmp(arg, "--chunk") == 0) {
+            unsigned long minChunk = 0, maxChunk = 0;
+            if (std::sscanf(value, "%lu:%lu", &minChunk, &maxChunk) != 2) return false;
+            options.minChunk = static_cast<std::uint32_t>(minChunk);
+            options.maxChunk = static_cast<std::uint32_t>(maxChunk);
+            i++;
+        } else if (value && std::strcmp(arg, "--corrupt-every") == 0) {
+            options.corruptEvery = std::atol(value); i++;
+        } else if (value && std::strcmp(arg, "--drop-newline-every") == 0) {
+            options.dropNewlineEvery = std::atol(value); i++;
+        } else if (value && std::strcmp(arg, "--seed") == 0) {
+            options.seed = static_cast<unsigned>(std::atol(value)); i++;
+        } else if (value && std::strcmp(arg, "--record") == 0) {
+            options.record = value; i++;
+        } else if (std::strcmp(arg, "--record-raw") == 0) {
+            options.recordRaw = true;
+        } else {
+            std::fprintf(stderr, "usage: %s [--input FILE] [--format auto|csv|binary|mavlink] [--seconds S]\n"
+                                 "       [--chunk MIN:MAX] [--corrupt-every N] [--drop-newline-every N] [--seed N]\n"
+                                 "       [--record DIR [--record-raw]]\n", argv[0]);
+            return false;
+        }
+    }
+    return options.seconds > 0 && options.minChunk >= 1 && options.maxChunk >= options.minChunk;
+}
+
+bool readFile(const char *path, std::string &out) {
+    std::FILE *file = std::fopen(path, "rb");
+    if (!file) return false;
+    char buffer[65536];
+    std::size_t n;
+    while ((n = std::fread(buffer, 1, sizeof(buffer), file)) > 0) out.append(buffer, n);
+    std::fclose(file);
+    return true;
+}
+
+// A minute of the firmware's CSV output: "pitch,roll\r\n" with two decimals
+std::string syntheticCsv(std::mt19937 &rng) {
+    std::string stream;
+    std::normal_distribution<float> noise(0.0f, 0.3f);
+    float pitch = 0, roll = 0;
+    char line[64];
+    for (int i = 0; i < 60 * 50; i++) {
+        pitch = std::clamp(pitch + noise(rng), -90.0f, 90.0f);
+        roll = std::clamp(roll + noise(rng), -180.0f, 180.0f);
+        int length = std::snprintf(line, sizeof(line), "%.2f,%.2f\r\n", pitch, roll);
+        stream.append(line, static_cast<std::size_t>(length));
+    }
+    return stream;
+}
+
+// A minute of binary frames with every field present
+std::string syntheticFrames(std::mt19937 &rng) {
+    std::string stream;
+    std::uniform_real_distribution<float> angle(-90.0f, 90.0f);
+    std::uint8_t frame[HORUS_MAX_FRAME_SIZE];
+    for (int i = 0; i < 60 * 50; i++) {
+        HorusTelemetry t = {};
+        t.sequence = static_cast<std::uint16_t>(i);
+        t.sensorTimeMs = static_cast<std::uint32_t>(i * 20);
+        t.flags = HORUS_FIELD_ATTITUDE | HORUS_FIELD_RAW_IMU | HORUS_FIELD_ALTITUDE | HORUS_FIELD_SPEED |
+                  HORUS_FIELD_HEADING | HORUS_FIELD_BATTERY | HORUS_FIELD_RPM;
+        t.pitch = angle(rng);
+        t.roll = angle(rng);
+        t.altitude = 8500.0f;
+        t.airspeed = 70.0f;
+        std::size_t length = horusEncodeTelemetry(t, frame);
+        stream.append(reinterpret_cast<const char *>(frame), length);
+    }
+    return stream;
+}
+
+// Messages per second in syntheticMavlink(), like an autopilot with its
+// telemetry stream rates turned all the way up
+constexpr int mavlinkRates[] = {200, 50, 50, 50, 5, 1};  // ATTITUDE, VFR_HUD, GPI, ESC_STATUS, SYS_STATUS, HEARTBEAT
+constexpr int mavlinkMessagesPerSecond = 200 + 50 + 50 + 50 + 5 + 1;
+
+// A minute of an autopilot's MAVLink v2 stream. HEARTBEAT stands in for the
+// messages the PFD does not use and the decoder passes over.
+std::string syntheticMavlink(std::mt19937 &rng) {
+    std::string stream;
+    std::normal_distribution<float> noise(0.0f, 0.005f);
+    std::uint8_t frame[mavlink::maxFrameSize];
+    std::uint8_t payload[64];
+    std::uint8_t sequence = 0;
+    float pitch = 0, roll = 0;
+    const auto put = [&](std::size_t offset, const void *value, std::size_t size) {
+        std::memcpy(payload + offset, value, size);  // Little-endian hosts
+    };
+    const auto send = [&](std::uint32_t msgid, std::size_t length) {
+        std::size_t size = mavlink::encodeFrame(msgid, payload, length, sequence++, 1, 1, frame);
+        stream.append(reinterpret_cast<const char *>(frame), size);
+    };
+
+    for (int tick = 0; tick < 60 * 200; tick++) {  // 5 ms ticks
+        const std::uint32_t timeMs = static_cast<std::uint32_t>(tick * 5);
+        std::memset(payload, 0, sizeof(payload));
+        pitch = std::clamp(pitch + noise(rng), -1.5f, 1.5f);
+        roll = std::clamp(roll + noise(rng), -3.0f, 3.0f);
+        const float yaw = 0.5f;
+        put(0, &timeMs, 4);
+        put(4, &roll, 4);
+        put(8, &pitch, 4);
+        put(12, &yaw, 4);
+        send(mavlink::msgAttitude, 28);
+
+        if (tick % (200 / mavlinkRates[1]) == 0) {
+            std::memset(payload, 0, sizeof(payload));
+            const float airspeed = 36.0f, altitude = 2590.0f, climb = 0.4f;
+            const std::int16_t heading = static_cast<std::int16_t>(tick / 20 % 360);
+            const std::uint16_t throttle = 62;
+            put(0, &airspeed, 4);
+            put(4, &airspeed, 4);
+            put(8, &altitude, 4);
+            put(12, &climb, 4);
+            put(16, &heading, 2);
+            put(18, &throttle, 2);
+            send(mavlink::msgVfrHud, 20);
+        }
+        if (tick % (200 / mavlinkRates[2]) == 2) {
+            std::memset(payload, 0, sizeof(payload));
+            const std::int32_t lat = 387223000, lon = -91393000, alt = 2590000, relative = 120000;
+            const std::uint16_t hdg = static_cast<std::uint16_t>(tick / 20 % 360 * 100);
+            put(0, &timeMs, 4);
+            put(4, &lat, 4);
+            put(8, &lon, 4);
+            put(12, &alt, 4);
+            put(16, &relative, 4);
+            put(26, &hdg, 2);
+            send(mavlink::msgGlobalPositionInt, 28);
+        }
+        if (tick % (200 / mavlinkRates[3]) == 1) {
+            std::memset(payload, 0, sizeof(payload));
+            const std::uint64_t timeUs = timeMs * 1000ull;
+            put(0, &timeUs, 8);
+            for (int i = 0; i < 4; i++) {
+                const std::int32_t rpm = 2500 + 100 * i + tick % 50;
+                const float volts = 16.4f, amps = 8.0f;
+                put(8 + 4 * i, &rpm, 4);
+                put(24 + 4 * i, &volts, 4);
+                put(40 + 4 * i, &amps, 4);
+            }
+            send(mavlink::msgEscStatus, 57);
+        }
+        if (tick % (200 / mavlinkRates[4]) == 3) {
+            std::memset(payload, 0, sizeof(payload));
+            const std::uint16_t millivolts = 16400;
+            const std::int8_t remaining = 72;
+            put(14, &millivolts, 2);
+            put(30, &remaining, 1);
+            send(mavlink::msgSysStatus, 31);
+        }
+        if (tick % (200 / mavlinkRates[5]) == 4) {
+            std::memset(payload, 0, sizeof(payload));
+            payload[4] = 1;     // Fixed wing
+            payload[5] = 3;     // ArduPilot
+            payload[6] = 0x81;  // Armed, custom mode
+            payload[7] = 4;     // Active
+            payload[8] = 3;     // MAVLink version
+            send(0, 9);         // HEARTBEAT
+        }
+    }
+    return stream;
+}
+
+// Numbers from_chars parses but no sensor sends
+const char *const nonFiniteLines[] = {"nan,0", "0,inf", "-infinity,12.5", "1e99,-1e99", "NAN,NAN"};
+
+// Garbles every Nth line, every other one of those into non-finite numbers,
+// and drops the newline of every Mth
+std::string mutate(const std::string &clean, const Options &options, std::mt19937 &rng) {
+    if (options.corruptEvery <= 0 && options.dropNewlineEvery <= 0) return clean;
+
+    std::string out;
+    out.reserve(clean.size());
+    long line = 0;
+    std::size_t start = 0;
+    while (start < clean.size()) {
+        std::size_t newline = clean.find('\n', start);
+        std::size_t end = newline == std::string::npos ? clean.size() : newline;
+        std::string text = clean.substr(start, end - start);
+        line++;
+
+        if (options.corruptEvery > 0 && line % options.corruptEvery == 0 && !text.empty()) {
+            if (line / options.corruptEvery % 2 == 0) {
+                text = nonFiniteLines[rng() % (sizeof(nonFiniteLines) / sizeof(nonFiniteLines[0]))];
+            } else {
+                text[rng() % text.size()] = static_cast<char>('!' + rng() % 90);
+            }
+        }
+        out += text;
+        const bool dropNewline = options.dropNewlineEvery > 0 && line % options.dropNewlineEvery == 0;
+        if (newline != std::string::npos && !dropNewline) out += '\n';
+        start = end + 1;
+    }
+    return out;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) return 2;
+
+    std::mt19937 rng(options.seed);
+    std::string stream;
+    if (options.input) {
+        if (!readFile(options.input, stream) || stream.empty()) {
+            std::fprintf(stderr, "could not read %s\n", options.input);
+            return 2;
+        }
+    } else {
+        stream = options.mavlink ? syntheticMavlink(rng) : options.binary ? syntheticFrames(rng) : syntheticCsv(rng);
+    }
+    if (!options.binary && !options.mavlink) stream = mutate(stream, options, rng);
+
+    const std::vector<std::uint32_t> chunkSizes = makeChunkSizes(stream.size(), options.minChunk, options.maxChunk, rng);
+    const std::uint64_t linesPerPass = static_cast<std::uint64_t>(std::count(stream.begin(), stream.end(), '\n'));
+
+    static SampleRing ring;
+    SerialReader reader(ring);
+    reader.setWireFormat(options.format);
+    ChunkDevice device;
+
+    std::unique_ptr<FlightRecorder> recorder;
+    if (options.record) {
+        recorder.reset(new FlightRecorder(QString::fromLocal8Bit(options.record)));
+        FlightRecorder::Channel *channel = recorder->openChannel(0, options.recordRaw);
+        if (!recorder->start()) {
+            std::fprintf(stderr, "could not record: %s\n", qPrintable(recorder->lastError()));
+            return 2;
+        }
+        reader.setRecorder(channel);
+    }
+
+    // Warm-up pass: first-touch page faults and the format switch
+    IngestCounts counts;
+    feedChunks(reader, ring, device, stream.data(), chunkSizes, counts);
+
+    counts = IngestCounts();
+    const std::uint64_t messagesBefore = reader.mavlink().messageCount();
+    std::uint64_t passes = 0;
+    const std::uint64_t allocationsBefore = allocationCount();
+    const auto start = std::chrono::steady_clock::now();
+    double elapsed = 0;
+    do {
+        feedChunks(reader, ring, device, stream.data(), chunkSizes, counts);
+        passes++;
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    } while (elapsed < options.seconds);
+    const std::uint64_t allocations = allocationCount() - allocationsBefore;
+    if (recorder) recorder->stop();
+
+    const std::uint64_t lines = linesPerPass * passes;
+    const double samplesPerSecond = counts.samples / elapsed;
+    const bool mavlinkStream = reader.mavlink().messageCount() > 0;
+    const bool binary = mavlinkStream || options.format == SerialReader::WireFormat::Binary ||
+                        (options.format == SerialReader::WireFormat::Auto && stream.find('\0') != std::string::npos);
+    // A MAVLink sample carries several messages
+    const std::uint64_t frames = mavlinkStream ? reader.mavlink().messageCount() - messagesBefore : counts.samples;
+
+    std::printf("stream          %zu bytes, %s, %llu passes\n", stream.size(),
+                mavlinkStream ? "mavlink frames" : binary ? "binary frames" : "csv lines",
+                static_cast<unsigned long long>(passes));
+    std::printf("chunks          %u..%u bytes, %.1f bytes average\n", options.minChunk, options.maxChunk,
+                double(counts.bytes) / double(counts.chunks));
+    if (!binary) {
+        std::printf("lines           %.0f lines/s\n", lines / elapsed);
+    }
+    if (mavlinkStream) {
+        std::printf("messages        %.0f messages/s\n", frames / elapsed);
+    }
+    std::printf("samples         %.0f samples/s\n", samplesPerSecond);
+    std::printf("bytes           %.2f MB/s\n", counts.bytes / elapsed / 1e6);
+    std::printf("allocations     %.4f per %s (%s)\n",
+                double(allocations) / double(binary ? std::max<std::uint64_t>(frames, 1) : std::max<std::uint64_t>(lines, 1)),
+                binary ? "frame" : "line", allocationCounterKind());
+    std::printf("bad lines       %llu\n", static_cast<unsigned long long>(reader.badLineCount()));
+    std::printf("line overflows  %llu\n", static_cast<unsigned long long>(reader.lineOverflowCount()));
+    std::printf("non-finite      %llu\n", static_cast<unsigned long long>(counts.nonFinite));
+    std::printf("crc errors      %llu\n", static_cast<unsigned long long>(reader.decoder().crcErrorCount() +
+                                                                        reader.mavlink().crcErrorCount()));
+    if (mavlinkStream) {
+        std::printf("vehicles        %.0f at %d messages/s on one core\n", frames / elapsed / mavlinkMessagesPerSecond,
+                    mavlinkMessagesPerSecond);
+    } else {
+        std::printf("vehicles        %.0f at 50 Hz on one core\n", samplesPerSecond / 50.0);
+    }
+    if (recorder) {
+        std::printf("recorded        %llu records, %.1f MB in %u segments, %llu dropped, %llu failed syncs\n",
+                    static_cast<unsigned long long>(recorder->recordCount()), recorder->bytesWritten() / 1e6,
+                    recorder->segmentCount(), static_cast<unsigned long long>(recorder->droppedCount()),
+                    static_cast<unsigned long long>(recorder->syncFailureCount()));
+    }
+    return counts.nonFinite == 0 ? 0 : 1;
+}
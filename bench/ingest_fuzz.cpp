@@ -0,0 +1,77 @@
+// Fuzz target for the serial ingest path, built on the same harness as
+// ingest_bench. Build with Clang and -DHORUS_BUILD_FUZZERS=ON for libFuzzer;
+// otherwise main() below replays corpus files given on the command line, so
+// crashers can be reproduced with any compiler.
+//
+// Input layout: byte 0 picks the wire format and seeds the chunking, the
+// rest is the byte stream as it would arrive from the port. Seeds are in
+// bench/corpus. A sample with a NaN or infinite attitude aborts.
+
+#include <QtGlobal>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "ingestharness.h"
+
+namespace {
+
+void discardMessages(QtMsgType, const QMessageLogContext &, const QString &) {
+}
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t *data, std::size_t size) {
+    if (size < 1) return 0;
+    static bool quiet = (qInstallMessageHandler(discardMessages), true);
+    Q_UNUSED(quiet);
+
+    static SampleRing ring;
+    SerialReader reader(ring);  // Fresh line buffer and decoder state per input
+    const SerialReader::WireFormat formats[] = {
+        SerialReader::WireFormat::Auto, SerialReader::WireFormat::Csv, SerialReader::WireFormat::Binary,
+        SerialReader::WireFormat::Mavlink
+    };
+    reader.setWireFormat(formats[data[0] % 4]);
+
+    const char *stream = reinterpret_cast<const char *>(data + 1);
+    const std::size_t length = size - 1;
+
+    std::minstd_rand rng(data[0]);
+    const std::vector<std::uint32_t> chunkSizes = makeChunkSizes(length, 1, 64, rng);
+    ChunkDevice device;
+    IngestCounts counts;
+    feedChunks(reader, ring, device, stream, chunkSizes, counts);
+    if (counts.nonFinite > 0) std::abort();  // The display can't draw NaN or infinity
+
+    // The field parser on its own, with the whole stream as one line
+    float fields[SerialReader::maxFields];
+    const int count = lineparser::parseFields(stream, stream + length, fields, SerialReader::maxFields);
+    for (int i = 0; i < count; i++) {
+        if (!std::isfinite(fields[i])) std::abort();
+    }
+    return 0;
+}
+
+#ifndef HORUS_LIBFUZZER
+int main(int argc, char **argv) {
+    for (int i = 1; i < argc; i++) {
+        std::FILE *file = std::fopen(argv[i], "rb");
+        if (!file) {
+            std::fprintf(stderr, "could not read %s\n", argv[i]);
+            return 2;
+        }
+        std::vector<std::uint8_t> input;
+        std::uint8_t buffer[4096];
+        std::size_t n;
+        while ((n = std::fread(buffer, 1, sizeof(buffer), file)) > 0) input.insert(input.end(), buffer, buffer + n);
+        std::fclose(file);
+
+        LLVMFuzzerTestOneInput(input.data(), input.size());
+        std::printf("%s: ok\n", argv[i]);
+    }
+    return 0;
+}
+#endif
@@ -0,0 +1,92 @@
+#ifndef INGESTHARNESS_H
+#define INGESTHARNESS_H
+
+// Shared by ingest_bench and ingest_fuzz: pushes a byte stream through
+// SerialReader::ingest(), the same code readyRead runs, in caller-chosen
+// chunks.
+
+#include <QIODevice>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "serialreader.h"
+
+// Hands out one chunk at a time, like a QSerialPort holding whatever the
+// driver delivered since the last readyRead.
+class ChunkDevice : public QIODevice {
+public:
+    ChunkDevice() {
+        open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+    }
+
+    void setChunk(const char *data, qint64 length) {
+        chunk = data;
+        remaining = length;
+    }
+
+    bool isSequential() const override { return true; }
+    qint64 bytesAvailable() const override { return remaining + QIODevice::bytesAvailable(); }
+
+protected:
+    qint64 readData(char *out, qint64 maxLength) override {
+        const qint64 n = qMin(maxLength, remaining);
+        std::memcpy(out, chunk, static_cast<std::size_t>(n));
+        chunk += n;
+        remaining -= n;
+        return n;
+    }
+
+    qint64 writeData(const char *, qint64) override { return -1; }
+
+private:
+    const char *chunk = nullptr;
+    qint64 remaining = 0;
+};
+
+struct IngestCounts {
+    std::uint64_t bytes = 0;
+    std::uint64_t chunks = 0;
+    std::uint64_t samples = 0;
+    std::uint64_t nonFinite = 0;  // Drained samples with a NaN or infinite attitude: a parser bug
+};
+
+// Splits length bytes into chunks of minChunk..maxChunk bytes.
+// Drawn up front so the random number generator stays out of timed loops.
+template <typename Rng>
+std::vector<std::uint32_t> makeChunkSizes(std::size_t length, std::uint32_t minChunk, std::uint32_t maxChunk, Rng &rng) {
+    std::vector<std::uint32_t> sizes;
+    const std::uint32_t span = maxChunk - minChunk + 1;
+    std::size_t offset = 0;
+    while (offset < length) {
+        std::uint32_t size = minChunk + static_cast<std::uint32_t>(rng() % span);
+        if (size > length - offset) size = static_cast<std::uint32_t>(length - offset);
+        sizes.push_back(size);
+        offset += size;
+    }
+    return sizes;
+}
+
+// One readyRead per chunk; the display side is played by draining the ring
+inline void feedChunks(SerialReader &reader, SampleRing &ring, ChunkDevice &device,
+                       const char *data, const std::vector<std::uint32_t> &chunkSizes,
+                       IngestCounts &counts) {
+    TelemetrySample sample;
+    const std::uint64_t droppedBefore = ring.droppedCount();
+    for (std::uint32_t size : chunkSizes) {
+        device.setChunk(data, size);
+        reader.ingest(&device);
+        data += size;
+
+        while (ring.pop(sample)) {
+            counts.samples++;
+            if (!std::isfinite(sample.pitch) || !std::isfinite(sample.roll)) counts.nonFinite++;
+        }
+        counts.bytes += size;
+        counts.chunks++;
+    }
+    // Big chunks can overrun the ring before it is drained; those were parsed too
+    counts.samples += ring.droppedCount() - droppedBefore;
+}
+
+#endif // INGESTHARNESS_H
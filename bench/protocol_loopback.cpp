@@ -0,0 +1,218 @@
+// Drives the binary frame decoder through a pseudo-terminal at full line rate.
+//
+// A writer thread encodes frames with the firmware encoder and writes them to
+// the pty master, paced to the configured baud rate (or as fast as the kernel
+// takes them with --unpaced). The main thread reads the slave side exactly as
+// the serial reader would and checks the decoder's counters against what was
+// deliberately corrupted or dropped.
+//
+//   protocol_loopback [--baud 921600] [--seconds 5] [--corrupt-every N]
+//                     [--drop-every N] [--unpaced]
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include "framedecoder.h"
+
+namespace {
+
+struct Options {
+    long baud = 921600;
+    double seconds = 5.0;
+    long corruptEvery = 0;
+    long dropEvery = 0;
+    bool unpaced = false;
+};
+
+struct WriterStats {
+    std::uint64_t encoded = 0;
+    std::uint64_t sent = 0;
+    std::uint64_t corrupted = 0;
+    std::uint64_t dropped = 0;
+    std::uint64_t bytes = 0;
+};
+
+bool parseOptions(int argc, char **argv, Options &options) {
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (std::strcmp(arg, "--unpaced") == 0) {
+            options.unpaced = true;
+        } else if (value && std::strcmp(arg, "--baud") == 0) {
+            options.baud = std::atol(value); i++;
+        } else if (value && std::strcmp(arg, "--seconds") == 0) {
+            options.seconds = std::atof(value); i++;
+        } else if (value && std::strcmp(arg, "--corrupt-every") == 0) {
+            options.corruptEvery = std::atol(value); i++;
+        } else if (value && std::strcmp(arg, "--drop-every") == 0) {
+            options.dropEvery = std::atol(value); i++;
+        } else {
+            std::fprintf(stderr, "usage: %s [--baud N] [--seconds S] [--corrupt-every N] [--drop-every N] [--unpaced]\n", argv[0]);
+            return false;
+        }
+    }
+    return options.baud > 0 && options.seconds > 0;
+}
+
+bool makeRaw(int fd) {
+    termios tio;
+    if (tcgetattr(fd, &tio) != 0) return false;
+    cfmakeraw(&tio);
+    return tcsetattr(fd, TCSANOW, &tio) == 0;
+}
+
+bool writeAll(int fd, const std::uint8_t *data, std::size_t length) {
+    while (length > 0) {
+        ssize_t n = write(fd, data, length);
+        if (n < 0) return false;
+        data += n;
+        length -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+void runWriter(int fd, const Options &options, WriterStats &stats) {
+    using clock = std::chrono::steady_clock;
+    const double bytesPerSecond = options.baud / 10.0;  // 8N1
+    const clock::time_point start = clock::now();
+    const clock::time_point stop = start + std::chrono::duration_cast<clock::duration>(
+        std::chrono::duration<double>(options.seconds));
+
+    std::uint8_t batch[4096];
+    std::size_t batchLength = 0;
+    std::uint16_t sequence = 0;
+
+    for (;;) {
+        // The last frame goes out clean, so the decoder sees past every frame
+        // dropped or corrupted before it
+        const bool last = clock::now() >= stop;
+        HorusTelemetry t = {};
+        double phase = stats.encoded * 0.001;
+        t.sequence = sequence++;
+        t.sensorTimeMs = static_cast<std::uint32_t>(stats.encoded);
+        t.flags = HORUS_FIELD_ATTITUDE | HORUS_FIELD_RAW_IMU | HORUS_FIELD_ALTITUDE |
+                  HORUS_FIELD_SPEED | HORUS_FIELD_HEADING | HORUS_FIELD_BATTERY | HORUS_FIELD_RPM;
+        t.pitch = static_cast<float>(20.0 * std::sin(phase));
+        t.roll = static_cast<float>(45.0 * std::sin(phase * 1.3));
+        t.altitude = static_cast<float>(8500.0 + 100.0 * std::sin(phase * 0.2));
+        t.airspeed = 70.0f;
+        t.heading = static_cast<float>(std::fmod(phase * 10.0, 360.0));
+        t.batteryVolts = 12.6f;
+        t.batteryPercent = 80;
+        for (int i = 0; i < 4; i++) t.rpm[i] = static_cast<std::uint16_t>(2500 + i);
+        stats.encoded++;
+
+        if (!last && options.dropEvery > 0 && stats.encoded % options.dropEvery == 0) {
+            stats.dropped++;
+            continue;
+        }
+
+        std::uint8_t frame[HORUS_MAX_FRAME_SIZE];
+        std::size_t length = horusEncodeTelemetry(t, frame);
+        if (!last && options.corruptEvery > 0 && stats.encoded % options.corruptEvery == 0) {
+            // Flip a bit in the middle of the frame, never producing a delimiter
+            std::uint8_t &victim = frame[length / 2];
+            victim ^= (victim == 0x01) ? 0x02 : 0x01;
+            stats.corrupted++;
+        }
+
+        if (batchLength + length > sizeof(batch)) {
+            if (!writeAll(fd, batch, batchLength)) return;
+            batchLength = 0;
+        }
+        std::memcpy(batch + batchLength, frame, length);
+        batchLength += length;
+        stats.sent++;
+        stats.bytes += length;
+
+        if (!options.unpaced) {
+            // Hold the cumulative byte count to the line rate
+            clock::time_point due = start + std::chrono::duration_cast<clock::duration>(
+                std::chrono::duration<double>(stats.bytes / bytesPerSecond));
+            if (due > clock::now() + std::chrono::milliseconds(1)) {
+                if (!writeAll(fd, batch, batchLength)) return;
+                batchLength = 0;
+                std::this_thread::sleep_until(due);
+            }
+        }
+        if (last) break;
+    }
+    writeAll(fd, batch, batchLength);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) return 2;
+
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+        std::perror("posix_openpt");
+        return 2;
+    }
+    int slave = open(ptsname(master), O_RDONLY | O_NOCTTY);
+    if (slave < 0 || !makeRaw(slave) || !makeRaw(master)) {
+        std::perror("pty slave");
+        return 2;
+    }
+
+    WriterStats writerStats;
+    std::atomic<bool> writerDone{false};
+    const auto start = std::chrono::steady_clock::now();
+    std::thread writer([&] {
+        runWriter(master, options, writerStats);
+        writerDone = true;
+    });
+
+    FrameDecoder decoder;
+    std::uint64_t received = 0;
+    std::uint64_t bytesRead = 0;
+    std::uint8_t chunk[1024];
+    for (;;) {
+        pollfd pfd = {slave, POLLIN, 0};
+        int ready = poll(&pfd, 1, 200);
+        if (ready <= 0) {
+            if (writerDone) break;  // Drained
+            continue;
+        }
+        ssize_t n = read(slave, chunk, sizeof(chunk));
+        if (n <= 0) break;
+        bytesRead += static_cast<std::uint64_t>(n);
+        decoder.feed(chunk, static_cast<std::size_t>(n), monotonicNowNs(),
+                     [&](const TelemetrySample &) { received++; });
+    }
+    writer.join();
+    // The trailing poll timeout is not decode time
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() - 0.2;
+    close(slave);
+    close(master);
+
+    const std::uint64_t rejected = decoder.crcErrorCount() + decoder.framingErrorCount();
+    const bool countsMatch = received == writerStats.sent - writerStats.corrupted &&
+                             rejected == writerStats.corrupted &&
+                             decoder.sequenceGapCount() == writerStats.corrupted + writerStats.dropped &&
+                             decoder.sequenceResyncCount() == 0;
+
+    std::printf("mode            %s @ %ld baud\n", options.unpaced ? "unpaced" : "paced", options.baud);
+    std::printf("frames sent     %llu (%llu corrupted, %llu dropped before send)\n",
+                static_cast<unsigned long long>(writerStats.sent),
+                static_cast<unsigned long long>(writerStats.corrupted),
+                static_cast<unsigned long long>(writerStats.dropped));
+    std::printf("frames decoded  %llu\n", static_cast<unsigned long long>(received));
+    std::printf("crc errors      %llu\n", static_cast<unsigned long long>(decoder.crcErrorCount()));
+    std::printf("framing errors  %llu\n", static_cast<unsigned long long>(decoder.framingErrorCount()));
+    std::printf("sequence gaps   %llu\n", static_cast<unsigned long long>(decoder.sequenceGapCount()));
+    std::printf("resyncs         %llu\n", static_cast<unsigned long long>(decoder.sequenceResyncCount()));
+    std::printf("throughput      %.0f frames/s, %.2f MB/s\n", received / elapsed, bytesRead / elapsed / 1e6);
+    std::printf("result          %s\n", countsMatch ? "PASS" : "FAIL");
+    return countsMatch ? 0 : 1;
+}
@@ -0,0 +1,249 @@
+// Headless render benchmark for AttitudeIndicator.
+//
+// Renders the PFD into an offscreen QImage (offscreen QPA platform) for a
+// number of frames of scripted telemetry, at 1000x1000, 1920x1080 and
+// 3840x2160, with antialiasing on and off. For every configuration it
+// reports frame time percentiles with parallel tile rendering and with
+// everything painted serially on the GUI thread, the cost of each registered
+// instrument painted on its own, and heap allocations per frame, as JSON.
+// The adaptive quality levels are held at full quality, then timed one by
+// one with parallel tiles.
+//
+//   render_bench [--frames 2000] [--output results.json]
+
+#include <QApplication>
+#include <QByteArray>
+#include <QFile>
+#include <QImage>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPainter>
+#include <QThreadPool>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <vector>
+#include "airdata.h"
+#include "allocationcounter.h"
+#include "attitudeindicator.h"
+
+namespace {
+
+struct Options {
+    int frames = 2000;
+    const char *output = nullptr;
+};
+
+struct RenderSize {
+    int width;
+    int height;
+};
+
+bool parseOptions(int argc, char **argv, Options &options) {
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (value && std::strcmp(arg, "--frames") == 0) {
+            options.frames = std::atoi(value); i++;
+        } else if (value && std::strcmp(arg, "--output") == 0) {
+            options.output = value; i++;
+        } else {
+            std::fprintf(stderr, "usage: %s [--frames N] [--output FILE]\n", argv[0]);
+            return false;
+        }
+    }
+    return options.frames > 0;
+}
+
+// Same shape as the main window's simulation, as a function of the frame number
+void scriptTelemetry(int frame, TelemetrySnapshot &t) {
+    const double time = frame * 0.02;
+    t.pitch = static_cast<float>(60.0 * std::sin(time * 0.7));
+    t.roll = static_cast<float>(170.0 * std::sin(time * 0.5));
+    t.altitude = static_cast<float>(8500.0 + 1000.0 * std::sin(time * 0.2));
+    t.speed = static_cast<float>(70.0 + 230.0 * std::sin(time * 0.4));
+    t.heading = static_cast<float>(std::fmod(time * 40.0, 360.0));
+    // The derived altitudes need no history; the rates are not drawn
+    AirData airData;
+    airData.setQnhInHg(static_cast<float>(29.92 + 0.5 * std::sin(time * 0.3)));
+    airData.setOutsideAirTemperature(8.0f);
+    airData.add(0, t.altitude, t.heading);
+    airData.fill(t);
+    t.propQuantity = 4;
+    for (int i = 0; i < 4; i++) {
+        t.rpm[i] = static_cast<int>(2500 + 1500 * std::sin(time * (0.2 + 0.03 * i)));
+    }
+    t.batteryVolts = static_cast<float>(4.2 + 0.5 * std::sin(time * 5));
+    t.batteryLevel = static_cast<float>(0.56 + 0.4 * std::sin(time * 0.02));
+    t.flightMode = "ATLC Takeoff Active";
+    const int seconds = frame / 50;
+    std::snprintf(t.clock, sizeof(t.clock), "%02d:%02d:%02d", (seconds / 3600) % 24, (seconds / 60) % 60, seconds % 60);
+}
+
+QJsonObject percentiles(std::vector<double> &microseconds) {
+    std::sort(microseconds.begin(), microseconds.end());
+    auto at = [&](double q) {
+        std::size_t index = static_cast<std::size_t>(std::ceil(q * microseconds.size()));
+        return microseconds[std::min(microseconds.size() - 1, index > 0 ? index - 1 : 0)];
+    };
+    double sum = 0;
+    for (double value : microseconds) sum += value;
+
+    QJsonObject result;
+    result["mean_us"] = sum / microseconds.size();
+    result["p50_us"] = at(0.50);
+    result["p90_us"] = at(0.90);
+    result["p99_us"] = at(0.99);
+    result["max_us"] = microseconds.back();
+    return result;
+}
+
+double elapsedMicroseconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+QJsonObject runConfiguration(AttitudeIndicator &pfd, RenderSize size, bool antialiasing, int frames) {
+    pfd.resize(size.width, size.height);
+    pfd.setAntialiasing(antialiasing);
+    QImage image(size.width, size.height, QImage::Format_ARGB32_Premultiplied);
+    TelemetrySnapshot telemetry;
+
+    // Warm up the static layer, ladder strip, atlases and tape labels
+    for (int frame = 0; frame < 50; frame++) {
+        scriptTelemetry(frame, telemetry);
+        pfd.setTelemetry(telemetry);
+        pfd.render(&image);
+    }
+
+    // Whole frames, as the window would paint them after a full invalidation:
+    // serially on the GUI thread, then with tiles on the thread pool
+    std::vector<double> serialFrameTimes;
+    serialFrameTimes.reserve(frames);
+    pfd.setParallelRendering(false);
+    for (int frame = 0; frame < frames; frame++) {
+        scriptTelemetry(frame, telemetry);
+        const auto start = std::chrono::steady_clock::now();
+        pfd.setTelemetry(telemetry);
+        pfd.render(&image);
+        serialFrameTimes.push_back(elapsedMicroseconds(start));
+    }
+    pfd.setParallelRendering(true);
+    pfd.render(&image);  // Tiles allocated at this size
+
+    std::vector<double> frameTimes;
+    frameTimes.reserve(frames);
+    const std::uint64_t allocationsBefore = allocationCount();
+    for (int frame = 0; frame < frames; frame++) {
+        scriptTelemetry(frame, telemetry);
+        const auto start = std::chrono::steady_clock::now();
+        pfd.setTelemetry(telemetry);
+        pfd.render(&image);
+        frameTimes.push_back(elapsedMicroseconds(start));
+    }
+    const std::uint64_t allocations = allocationCount() - allocationsBefore;
+
+    // The same frames at each reduced quality level
+    QJsonArray qualities;
+    std::vector<double> qualityFrameTimes;
+    qualityFrameTimes.reserve(frames);
+    for (int level = FrameTimeGovernor::PlainTicks; level < FrameTimeGovernor::QualityCount; level++) {
+        pfd.setRenderQuality(static_cast<FrameTimeGovernor::Quality>(level));
+        pfd.render(&image);  // Ladder strip and tiles rebuilt for the level
+        qualityFrameTimes.clear();
+        for (int frame = 0; frame < frames; frame++) {
+            scriptTelemetry(frame, telemetry);
+            const auto start = std::chrono::steady_clock::now();
+            pfd.setTelemetry(telemetry);
+            pfd.render(&image);
+            qualityFrameTimes.push_back(elapsedMicroseconds(start));
+        }
+        QJsonObject quality = percentiles(qualityFrameTimes);
+        quality["name"] = FrameTimeGovernor::qualityName(level);
+        qualities.append(quality);
+    }
+    pfd.setRenderQuality(FrameTimeGovernor::Full);
+
+    // One instrument at a time over the same script
+    QJsonArray instruments;
+    std::vector<double> instrumentTimes;
+    instrumentTimes.reserve(frames);
+    for (int index = 0; index < pfd.instrumentCount(); index++) {
+        instrumentTimes.clear();
+        for (int frame = 0; frame < frames; frame++) {
+            scriptTelemetry(frame, telemetry);
+            pfd.setTelemetry(telemetry);
+            QPainter painter(&image);
+            const auto start = std::chrono::steady_clock::now();
+            pfd.renderInstrument(painter, index);
+            painter.end();  // Raster flushes happen here
+            instrumentTimes.push_back(elapsedMicroseconds(start));
+        }
+        QJsonObject instrument = percentiles(instrumentTimes);
+        instrument["name"] = pfd.instrumentName(index);
+        instruments.append(instrument);
+    }
+
+    QJsonObject result;
+    result["width"] = size.width;
+    result["height"] = size.height;
+    result["antialiasing"] = antialiasing;
+    result["frame"] = percentiles(frameTimes);
+    result["frame_serial"] = percentiles(serialFrameTimes);
+    result["frame_by_quality"] = qualities;
+    result["render_threads"] = QThreadPool::globalInstance()->maxThreadCount();
+    result["allocations_per_frame"] = double(allocations) / frames;
+    result["instruments"] = instruments;
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) return 2;
+
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+
+    AttitudeIndicator pfd;
+    pfd.setCustomFonts("Courier", "Nimbus Mono PS");
+    pfd.setAttribute(Qt::WA_DontShowOnScreen);
+    pfd.setAdaptiveQuality(false);
+    pfd.show();
+
+    const RenderSize sizes[] = {{1000, 1000}, {1920, 1080}, {3840, 2160}};
+    QJsonArray configurations;
+    for (const RenderSize &size : sizes) {
+        for (bool antialiasing : {true, false}) {
+            configurations.append(runConfiguration(pfd, size, antialiasing, options.frames));
+            std::fprintf(stderr, "%dx%d aa=%d done\n", size.width, size.height, antialiasing);
+        }
+    }
+
+    QJsonObject report;
+    report["benchmark"] = "render";
+    report["qt_version"] = qVersion();
+    report["platform"] = QGuiApplication::platformName();
+    report["frames"] = options.frames;
+    report["allocation_counter"] = allocationCounterKind();
+    report["configurations"] = configurations;
+    const QByteArray json = QJsonDocument(report).toJson();
+
+    if (options.output) {
+        QFile file(QString::fromLocal8Bit(options.output));
+        if (!file.open(QIODevice::WriteOnly) || file.write(json) != json.size()) {
+            std::fprintf(stderr, "could not write %s\n", options.output);
+            return 1;
+        }
+    } else {
+        std::fwrite(json.constData(), 1, static_cast<std::size_t>(json.size()), stdout);
+    }
+    return 0;
+}
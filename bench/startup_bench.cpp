@@ -0,0 +1,127 @@
+// Time to first frame, enforced.
+//
+// Launches Horus --runs times with --simulate --exit-after-first-frame, on
+// the offscreen QPA platform unless --platform says otherwise, and collects
+// the startup trace each run prints (see startuptrace.h). Prints the median
+// and worst time of every phase and exits 1 if the median time to first
+// frame misses --target-ms, so a startup regression fails the run. The first
+// launch is a warm-up and not counted: it pays for a cold disk cache.
+//
+//   startup_bench [--runs 10] [--target-ms 1000] [--platform offscreen] [--horus path/to/Horus]
+
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QMap>
+#include <QProcess>
+#include <QProcessEnvironment>
+#include <QString>
+#include <QStringList>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+struct Options {
+    int runs = 10;
+    double targetMs = 1000.0;
+    QString platform = "offscreen";
+    QString horus = HORUS_EXECUTABLE;
+};
+
+bool parseOptions(int argc, char **argv, Options &options) {
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (value && std::strcmp(arg, "--runs") == 0) {
+            options.runs = std::atoi(value); i++;
+        } else if (value && std::strcmp(arg, "--target-ms") == 0) {
+            options.targetMs = std::atof(value); i++;
+        } else if (value && std::strcmp(arg, "--platform") == 0) {
+            options.platform = QString::fromLocal8Bit(value); i++;
+        } else if (value && std::strcmp(arg, "--horus") == 0) {
+            options.horus = QString::fromLocal8Bit(value); i++;
+        } else {
+            std::fprintf(stderr, "usage: %s [--runs N] [--target-ms MS] [--platform NAME] [--horus PATH]\n", argv[0]);
+            return false;
+        }
+    }
+    return options.runs > 0 && options.targetMs > 0;
+}
+
+// One launch; phase name -> ms from process start, empty if it failed
+QMap<QString, double> launch(const Options &options) {
+    QProcess horus;
+    QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+    environment.insert("QT_QPA_PLATFORM", options.platform);
+    horus.setProcessEnvironment(environment);
+    horus.setProcessChannelMode(QProcess::SeparateChannels);
+    horus.start(options.horus, {"--simulate", "--exit-after-first-frame"});
+    if (!horus.waitForFinished(30000) || horus.exitStatus() != QProcess::NormalExit || horus.exitCode() != 0) {
+        horus.kill();
+        horus.waitForFinished();
+        std::fprintf(stderr, "%s did not exit cleanly:\n%s", qPrintable(options.horus),
+                     horus.readAllStandardError().constData());
+        return {};
+    }
+
+    // "first frame          123.4 ms"; phases not reached print "-"
+    QMap<QString, double> phases;
+    for (const QByteArray &line : horus.readAllStandardOutput().split('\n')) {
+        if (!line.endsWith(" ms")) continue;
+        const QString text = QString::fromLatin1(line.left(line.size() - 3)).trimmed();
+        const int split = text.lastIndexOf(' ');
+        bool ok = false;
+        const double ms = text.mid(split + 1).toDouble(&ok);
+        if (split > 0 && ok) phases.insert(text.left(split).trimmed(), ms);
+    }
+    return phases;
+}
+
+double percentile(std::vector<double> values, double rank) {
+    std::sort(values.begin(), values.end());
+    return values[static_cast<std::size_t>(rank * (values.size() - 1) + 0.5)];
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    QCoreApplication app(argc, argv);
+    Options options;
+    if (!parseOptions(argc, argv, options)) return 2;
+
+    if (launch(options).isEmpty()) return 2;  // Warm-up
+
+    // Phase name -> one time per run, in the order the first run reached them
+    QStringList order;
+    QMap<QString, std::vector<double>> times;
+    for (int run = 0; run < options.runs; run++) {
+        const QMap<QString, double> phases = launch(options);
+        if (!phases.contains("first frame")) {
+            std::fprintf(stderr, "run %d printed no first frame time\n", run + 1);
+            return 2;
+        }
+        for (auto it = phases.begin(); it != phases.end(); ++it) {
+            if (!times.contains(it.key())) order.append(it.key());
+            times[it.key()].push_back(it.value());
+        }
+    }
+    std::sort(order.begin(), order.end(), [&times](const QString &a, const QString &b) {
+        return percentile(times[a], 0.5) < percentile(times[b], 0.5);
+    });
+
+    std::printf("%d launches, QPA platform %s\n", options.runs, qPrintable(options.platform));
+    std::printf("%-18s %9s %9s\n", "phase", "p50 ms", "max ms");
+    for (const QString &phase : order) {
+        const std::vector<double> &values = times[phase];
+        std::printf("%-18s %9.1f %9.1f\n", qPrintable(phase), percentile(values, 0.5), percentile(values, 1.0));
+    }
+
+    const double firstFrameMs = percentile(times["first frame"], 0.5);
+    const bool met = firstFrameMs <= options.targetMs;
+    std::printf("time to first frame %.1f ms, target %.0f ms: %s\n", firstFrameMs, options.targetMs,
+                met ? "met" : "MISSED");
+    return met ? 0 : 1;
+}
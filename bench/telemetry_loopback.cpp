@@ -0,0 +1,224 @@
+// Drives TelemetryServer over loopback the way a ground station uses it.
+//
+// A publisher thread stands in for the serial reader and publishes samples at
+// --rate. Three TelemetryClients follow the server over TCP, a local socket
+// and UDP, as --connect viewers would, and a fourth subscriber connects over
+// TCP with a tiny receive buffer and never reads. The viewers must get
+// (nearly) every sample with low latency while the server sheds the stalled
+// subscriber's oldest frames instead of buffering without bound or holding
+// the others up.
+//
+//   telemetry_loopback [--rate 1000] [--seconds 5] [--port 7280]
+
+#include <QCoreApplication>
+#include <QThread>
+#include <QTimer>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "telemetryclient.h"
+#include "telemetryserver.h"
+
+namespace {
+
+struct Options {
+    double rate = 1000.0;
+    double seconds = 5.0;
+    int port = 7280;  // TCP; UDP uses the next one
+};
+
+bool parseOptions(int argc, char **argv, Options &options) {
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (value && std::strcmp(arg, "--rate") == 0) {
+            options.rate = std::atof(value); i++;
+        } else if (value && std::strcmp(arg, "--seconds") == 0) {
+            options.seconds = std::atof(value); i++;
+        } else if (value && std::strcmp(arg, "--port") == 0) {
+            options.port = std::atoi(value); i++;
+        } else {
+            std::fprintf(stderr, "usage: %s [--rate HZ] [--seconds S] [--port N]\n", argv[0]);
+            return false;
+        }
+    }
+    return options.rate > 0 && options.seconds > 0 && options.port > 0 && options.port < 65535;
+}
+
+// One --connect viewer and what it received
+struct Viewer {
+    const char *name = nullptr;
+    SampleRing ring;
+    std::unique_ptr<TelemetryClient> client;
+    std::uint64_t received = 0;
+    std::vector<std::int64_t> latencyNs;  // Publish to decoded
+};
+
+// Connects over TCP and never reads, like a tool stopped in a debugger
+int connectStalledSubscriber(int port) {
+    const int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    const int receiveBuffer = 1024;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &receiveBuffer, sizeof(receiveBuffer));
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<std::uint16_t>(port));
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+double percentileUs(std::vector<std::int64_t> &values, double p) {
+    if (values.empty()) return 0;
+    const std::size_t index = std::min(values.size() - 1, static_cast<std::size_t>(p * values.size()));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index] / 1e3;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    QCoreApplication app(argc, argv);
+    Options options;
+    if (!parseOptions(argc, argv, options)) return 2;
+
+    const auto endpoint = [](const QString &text) {
+        TelemetryEndpoint parsed;
+        QString error;
+        TelemetryEndpoint::parse(text, parsed, error);
+        return parsed;
+    };
+    const TelemetryEndpoint tcp = endpoint(QString("tcp://127.0.0.1:%1").arg(options.port));
+    const TelemetryEndpoint local = endpoint(QString("local:horus-loopback-%1").arg(QCoreApplication::applicationPid()));
+    const TelemetryEndpoint udp = endpoint(QString("udp://127.0.0.1:%1").arg(options.port + 1));
+
+    QThread serverThread;
+    TelemetryServer *server = new TelemetryServer;
+    server->addEndpoint(tcp);
+    server->addEndpoint(local);
+    server->addEndpoint(udp);
+    server->moveToThread(&serverThread);
+    QObject::connect(&serverThread, &QThread::finished, server, &QObject::deleteLater);
+
+    const long long total = static_cast<long long>(options.seconds * options.rate);
+    // Publish time by sequence; the sample's sensorTimeMs carries the index
+    std::unique_ptr<std::atomic<std::int64_t>[]> publishedNs(new std::atomic<std::int64_t>[total]);
+
+    Viewer viewers[3];
+    const char *names[] = {"tcp", "local", "udp"};
+    const TelemetryEndpoint *targets[] = {&tcp, &local, &udp};
+    for (int i = 0; i < 3; i++) {
+        viewers[i].name = names[i];
+        viewers[i].client.reset(new TelemetryClient(viewers[i].ring));
+        viewers[i].client->setEndpoint(*targets[i]);
+        viewers[i].latencyNs.reserve(static_cast<std::size_t>(total));
+    }
+
+    int stalledFd = -1;
+    std::atomic<bool> ready{false};
+    QObject::connect(server, &TelemetryServer::started, &app, [&](bool ok, const QString &error) {
+        if (!ok) {
+            std::fprintf(stderr, "server: %s\n", qPrintable(error));
+            app.exit(1);
+            return;
+        }
+        for (Viewer &viewer : viewers) viewer.client->connectToServer();
+        stalledFd = connectStalledSubscriber(options.port);
+        if (stalledFd < 0) {
+            std::fprintf(stderr, "stalled subscriber could not connect\n");
+            app.exit(1);
+            return;
+        }
+        ready.store(true);
+    });
+    serverThread.start();
+    QMetaObject::invokeMethod(server, &TelemetryServer::start, Qt::QueuedConnection);
+
+    // Viewers drain their rings as the display timer would, a bit faster
+    QTimer drainTimer;
+    QObject::connect(&drainTimer, &QTimer::timeout, [&]() {
+        for (Viewer &viewer : viewers) {
+            TelemetrySample sample;
+            while (viewer.ring.pop(sample)) {
+                viewer.received++;
+                if (sample.sensorTimeMs < total) {
+                    viewer.latencyNs.push_back(sample.parsedNs - publishedNs[sample.sensorTimeMs].load());
+                }
+            }
+        }
+    });
+    drainTimer.start(2);
+
+    // Stands in for the serial reader thread
+    std::atomic<bool> publishing{true};
+    std::thread publisher([&]() {
+        // Until the two stream viewers and the stalled subscriber are in
+        while (publishing.load() && (!ready.load() || server->subscriberCount() < 3)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        const auto start = std::chrono::steady_clock::now();
+        const std::chrono::duration<double> period(1.0 / options.rate);
+        TelemetrySample sample;
+        sample.fields = HORUS_FIELD_ATTITUDE | HORUS_FIELD_ALTITUDE;
+        for (long long n = 0; n < total && publishing.load(); n++) {
+            std::this_thread::sleep_until(start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(n * period));
+            sample.sensorTimeMs = static_cast<std::uint32_t>(n);
+            sample.pitch = static_cast<float>(n % 90);
+            sample.altitude = static_cast<float>(n);
+            publishedNs[n].store(monotonicNowNs());
+            server->publish(sample);
+        }
+        // Let the tail arrive, then stop
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        QMetaObject::invokeMethod(&app, [&app]() { app.quit(); }, Qt::QueuedConnection);
+    });
+
+    const int status = app.exec();
+    publishing.store(false);
+    publisher.join();
+    drainTimer.stop();
+    if (status != 0) {
+        serverThread.quit();
+        serverThread.wait();
+        return status;
+    }
+
+    const std::uint64_t published = server->framesPublished();
+    const std::uint64_t dropped = server->framesDropped();
+    std::printf("%lld samples at %.0f Hz; server encoded %llu, shed %llu for the stalled subscriber, lost %llu itself\n",
+                total, options.rate, static_cast<unsigned long long>(published),
+                static_cast<unsigned long long>(dropped), static_cast<unsigned long long>(server->samplesDropped()));
+    std::printf("viewer   received   delivered   gaps   p50 us   p99 us   max us\n");
+
+    bool passed = published == static_cast<std::uint64_t>(total) && dropped > 0;
+    for (Viewer &viewer : viewers) {
+        const double delivered = 100.0 * viewer.received / total;
+        const double p50 = percentileUs(viewer.latencyNs, 0.50);
+        const double p99 = percentileUs(viewer.latencyNs, 0.99);
+        const double worst = percentileUs(viewer.latencyNs, 1.0);
+        std::printf("%-8s %8llu %10.2f%% %6llu %8.0f %8.0f %8.0f\n", viewer.name,
+                    static_cast<unsigned long long>(viewer.received), delivered,
+                    static_cast<unsigned long long>(viewer.client->decoder().sequenceGapCount()), p50, p99, worst);
+        passed = passed && delivered >= 99.0;
+    }
+    std::printf("%s\n", passed ? "PASS" : "FAIL");
+
+    close(stalledFd);
+    for (Viewer &viewer : viewers) viewer.client.reset();
+    serverThread.quit();
+    serverThread.wait();
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,69 @@
+#ifndef DISPLAYCLOCK_H
+#define DISPLAYCLOCK_H
+
+#include <QEvent>
+#include <QObject>
+#include <QScreen>
+#include <QWidget>
+#include <QWindow>
+#include <cstdint>
+#include <functional>
+#include "telemetrysample.h"
+
+// Runs a callback once per display refresh. Each tick comes from the
+// window's QEvent::UpdateRequest and re-arms the next with requestUpdate(),
+// which the platform paces to the monitor (the display link on macOS, frame
+// callbacks on Wayland), so the tick's repaint makes the next vsync instead
+// of beating against it the way a millisecond timer does.
+// Platforms without a display-paced update (xcb, Windows, offscreen) deliver
+// requestUpdate() on a short timer instead; there ticks closer together than
+// most of a refresh period are skipped, which holds them near the refresh
+// rate.
+class DisplayClock : public QObject {
+public:
+    DisplayClock(QWidget *window, std::function<void()> tick)
+    : QObject(window), window(window), tick(std::move(tick)) {
+    }
+
+    void start() {
+        window->winId();  // The QWindow exists from here on
+        handle = window->windowHandle();
+        handle->installEventFilter(this);
+        lastTickNs = monotonicNowNs();
+        running = true;
+        handle->requestUpdate();
+    }
+
+    bool isRunning() const { return running; }
+
+    qreal refreshHz() const {
+        const QScreen *display = window->screen();
+        return qMax<qreal>(display ? display->refreshRate() : 60.0, 1.0);
+    }
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override {
+        if (watched != handle || !running) return false;
+        if (event->type() == QEvent::UpdateRequest) {
+            const std::int64_t now = monotonicNowNs();
+            if (now - lastTickNs >= static_cast<std::int64_t>(0.75e9 / refreshHz())) {
+                lastTickNs = now;
+                tick();
+            }
+            handle->requestUpdate();
+        } else if (event->type() == QEvent::Expose) {
+            // Hidden windows get no update requests; pick up again when shown
+            handle->requestUpdate();
+        }
+        return false;  // The window still repaints on its own UpdateRequest
+    }
+
+private:
+    QWidget *window;
+    QWindow *handle = nullptr;
+    std::function<void()> tick;
+    std::int64_t lastTickNs = 0;
+    bool running = false;
+};
+
+#endif // DISPLAYCLOCK_H
@@ -0,0 +1,217 @@
+// Horus binary telemetry frame, shared by the ESP32 firmware and the host.
+//
+// Wire format (version 1):
+//   COBS( payload | crc16 ) 0x00
+//
+// Payload, little-endian:
+//   off size field
+//    0   1   version            HORUS_PROTOCOL_VERSION
+//    1   1   message type       HORUS_MSG_TELEMETRY
+//    2   2   sequence           +1 per frame, wraps at 65535
+//    4   4   sensor time        millis() on the sender
+//    8   2   field flags        HORUS_FIELD_* - which groups below are valid
+//   10  12   pitch, roll, yaw   float, degrees
+//   22   6   accel x, y, z      int16, raw LSB (HORUS_ACCEL_LSB_PER_G)
+//   28   6   gyro x, y, z       int16, raw LSB (HORUS_GYRO_LSB_PER_DPS)
+//   34   4   altitude           float, feet
+//   38   4   airspeed           float, knots
+//   42   4   heading            float, degrees
+//   46   4   battery voltage    float, volts
+//   50   1   battery level      uint8, percent
+//   51   8   rpm[4]             uint16
+//
+// crc16 is CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) over the payload.
+// COBS guarantees 0x00 only ever appears as the frame delimiter, so a
+// receiver can resynchronise on the next zero after any corruption.
+
+#ifndef HORUS_PROTOCOL_H
+#define HORUS_PROTOCOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define HORUS_PROTOCOL_VERSION 1
+#define HORUS_MSG_TELEMETRY 1
+
+#define HORUS_FIELD_ATTITUDE (1u << 0)
+#define HORUS_FIELD_RAW_IMU  (1u << 1)
+#define HORUS_FIELD_ALTITUDE (1u << 2)
+#define HORUS_FIELD_SPEED    (1u << 3)
+#define HORUS_FIELD_HEADING  (1u << 4)
+#define HORUS_FIELD_BATTERY  (1u << 5)
+#define HORUS_FIELD_RPM      (1u << 6)
+
+#define HORUS_ACCEL_LSB_PER_G 16384.0f  // MPU6050 at +-2 g
+#define HORUS_GYRO_LSB_PER_DPS 131.0f   // MPU6050 at +-250 deg/s
+
+#define HORUS_TELEMETRY_PAYLOAD_SIZE 59
+#define HORUS_CRC_SIZE 2
+// COBS adds one byte per 254 plus the leading code byte; +1 for the delimiter
+#define HORUS_MAX_FRAME_SIZE (HORUS_TELEMETRY_PAYLOAD_SIZE + HORUS_CRC_SIZE + 2 + 1)
+
+struct HorusTelemetry {
+  uint16_t sequence;
+  uint32_t sensorTimeMs;
+  uint16_t flags;
+  float pitch;
+  float roll;
+  float yaw;
+  int16_t accel[3];
+  int16_t gyro[3];
+  float altitude;
+  float airspeed;
+  float heading;
+  float batteryVolts;
+  uint8_t batteryPercent;
+  uint16_t rpm[4];
+};
+
+static inline uint16_t horusCrc16(const uint8_t *data, size_t length) {
+  uint16_t crc = 0xFFFF;
+  for (size_t i = 0; i < length; i++) {
+    crc ^= static_cast<uint16_t>(data[i]) << 8;
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+    }
+  }
+  return crc;
+}
+
+// Encodes length bytes into out (at least length + length / 254 + 1 bytes).
+// Returns the encoded length, not including the 0x00 delimiter.
+static inline size_t horusCobsEncode(const uint8_t *in, size_t length, uint8_t *out) {
+  size_t codeIndex = 0;
+  size_t outIndex = 1;
+  uint8_t code = 1;
+  for (size_t i = 0; i < length; i++) {
+    if (in[i] == 0) {
+      out[codeIndex] = code;
+      codeIndex = outIndex++;
+      code = 1;
+    } else {
+      out[outIndex++] = in[i];
+      if (++code == 0xFF) {
+        out[codeIndex] = code;
+        codeIndex = outIndex++;
+        code = 1;
+      }
+    }
+  }
+  out[codeIndex] = code;
+  return outIndex;
+}
+
+// Decodes in place (the output never outgrows the input).
+// Returns the decoded length, or 0 if the block is not valid COBS.
+static inline size_t horusCobsDecode(uint8_t *data, size_t length) {
+  size_t in = 0;
+  size_t out = 0;
+  while (in < length) {
+    uint8_t code = data[in++];
+    if (code == 0 || in + code - 1 > length) return 0;
+    for (uint8_t i = 1; i < code; i++) {
+      data[out++] = data[in++];
+    }
+    if (code != 0xFF && in < length) {
+      data[out++] = 0;
+    }
+  }
+  return out;
+}
+
+static inline void horusPutU16(uint8_t *p, uint16_t v) {
+  p[0] = static_cast<uint8_t>(v);
+  p[1] = static_cast<uint8_t>(v >> 8);
+}
+
+static inline void horusPutU32(uint8_t *p, uint32_t v) {
+  p[0] = static_cast<uint8_t>(v);
+  p[1] = static_cast<uint8_t>(v >> 8);
+  p[2] = static_cast<uint8_t>(v >> 16);
+  p[3] = static_cast<uint8_t>(v >> 24);
+}
+
+static inline void horusPutF32(uint8_t *p, float v) {
+  uint32_t bits;
+  memcpy(&bits, &v, sizeof(bits));
+  horusPutU32(p, bits);
+}
+
+static inline uint16_t horusGetU16(const uint8_t *p) {
+  return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t horusGetU32(const uint8_t *p) {
+  return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+         (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+static inline float horusGetF32(const uint8_t *p) {
+  uint32_t bits = horusGetU32(p);
+  float v;
+  memcpy(&v, &bits, sizeof(v));
+  return v;
+}
+
+// Serialises one telemetry message into a complete frame, delimiter included.
+// out must hold HORUS_MAX_FRAME_SIZE bytes. Returns the number of bytes to send.
+static inline size_t horusEncodeTelemetry(const HorusTelemetry &t, uint8_t *out) {
+  uint8_t raw[HORUS_TELEMETRY_PAYLOAD_SIZE + HORUS_CRC_SIZE];
+  uint8_t *p = raw;
+
+  p[0] = HORUS_PROTOCOL_VERSION;
+  p[1] = HORUS_MSG_TELEMETRY;
+  horusPutU16(p + 2, t.sequence);
+  horusPutU32(p + 4, t.sensorTimeMs);
+  horusPutU16(p + 8, t.flags);
+  horusPutF32(p + 10, t.pitch);
+  horusPutF32(p + 14, t.roll);
+  horusPutF32(p + 18, t.yaw);
+  for (int i = 0; i < 3; i++) {
+    horusPutU16(p + 22 + 2 * i, static_cast<uint16_t>(t.accel[i]));
+    horusPutU16(p + 28 + 2 * i, static_cast<uint16_t>(t.gyro[i]));
+  }
+  horusPutF32(p + 34, t.altitude);
+  horusPutF32(p + 38, t.airspeed);
+  horusPutF32(p + 42, t.heading);
+  horusPutF32(p + 46, t.batteryVolts);
+  p[50] = t.batteryPercent;
+  for (int i = 0; i < 4; i++) {
+    horusPutU16(p + 51 + 2 * i, t.rpm[i]);
+  }
+  horusPutU16(p + HORUS_TELEMETRY_PAYLOAD_SIZE, horusCrc16(p, HORUS_TELEMETRY_PAYLOAD_SIZE));
+
+  size_t length = horusCobsEncode(raw, sizeof(raw), out);
+  out[length++] = 0;
+  return length;
+}
+
+// Parses a decoded, CRC-checked payload. Returns false on a wrong version,
+// type or size so newer senders are rejected rather than misread.
+static inline bool horusDecodeTelemetry(const uint8_t *p, size_t length, HorusTelemetry &t) {
+  if (length != HORUS_TELEMETRY_PAYLOAD_SIZE) return false;
+  if (p[0] != HORUS_PROTOCOL_VERSION || p[1] != HORUS_MSG_TELEMETRY) return false;
+
+  t.sequence = horusGetU16(p + 2);
+  t.sensorTimeMs = horusGetU32(p + 4);
+  t.flags = horusGetU16(p + 8);
+  t.pitch = horusGetF32(p + 10);
+  t.roll = horusGetF32(p + 14);
+  t.yaw = horusGetF32(p + 18);
+  for (int i = 0; i < 3; i++) {
+    t.accel[i] = static_cast<int16_t>(horusGetU16(p + 22 + 2 * i));
+    t.gyro[i] = static_cast<int16_t>(horusGetU16(p + 28 + 2 * i));
+  }
+  t.altitude = horusGetF32(p + 34);
+  t.airspeed = horusGetF32(p + 38);
+  t.heading = horusGetF32(p + 42);
+  t.batteryVolts = horusGetF32(p + 46);
+  t.batteryPercent = p[50];
+  for (int i = 0; i < 4; i++) {
+    t.rpm[i] = horusGetU16(p + 51 + 2 * i);
+  }
+  return true;
+}
+
+#endif // HORUS_PROTOCOL_H
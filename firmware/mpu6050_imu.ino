@@ -1,4 +1,9 @@
 #include <Wire.h>
+#include "horus_protocol.h"
+
+// 1 = binary COBS/CRC frames (see horus_protocol.h), 0 = legacy "pitch,roll" CSV.
+// The Horus host detects either automatically.
+#define HORUS_BINARY_FRAMES 1
 
 // MPU6050 I2C address
 int MPU6050_ADDR = 0x68;
@@ -17,6 +22,10 @@ float pitch = 0.0;
 float roll = 0.0;
 unsigned long lastTime = 0;
 
+// Binary frame state
+uint16_t frameSequence = 0;
+uint8_t frameBuffer[HORUS_MAX_FRAME_SIZE];
+
 // I2C pins
 #define SDA_PIN 21
 #define SCL_PIN 22
@@ -86,9 +95,13 @@ void loop() {
   pitch = 0.98 * (pitch + gyroX_dps * dt) + 0.02 * accelPitch;
   roll = 0.98 * (roll + gyroY_dps * dt) + 0.02 * accelRoll;
 
+#if HORUS_BINARY_FRAMES
+  sendTelemetryFrame(currentTime);
+#else
   Serial.print(pitch, 2);
   Serial.print(",");
   Serial.println(roll, 2);
+#endif
 
   delay(20);  // 50Hz update rate
 }
@@ -127,4 +140,22 @@ bool findMPU6050() {
   }
 
   return false;
-}
\ No newline at end of file
+}
+
+void sendTelemetryFrame(unsigned long timeMs) {
+  HorusTelemetry t = {};
+  t.sequence = frameSequence++;
+  t.sensorTimeMs = timeMs;
+  t.flags = HORUS_FIELD_ATTITUDE | HORUS_FIELD_RAW_IMU;
+  t.pitch = pitch;
+  t.roll = roll;
+  t.accel[0] = accelX;
+  t.accel[1] = accelY;
+  t.accel[2] = accelZ;
+  t.gyro[0] = gyroX;
+  t.gyro[1] = gyroY;
+  t.gyro[2] = gyroZ;
+
+  size_t length = horusEncodeTelemetry(t, frameBuffer);
+  Serial.write(frameBuffer, length);
+}
@@ -0,0 +1,250 @@
+#ifndef FLEETWINDOW_H
+#define FLEETWINDOW_H
+
+#include <QMainWindow>
+#include <QGridLayout>
+#include <QStringList>
+#include <QThread>
+#include <QWidget>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <vector>
+#include "airdata.h"
+#include "attitudeindicator.h"
+#include "attitudeinterpolator.h"
+#include "displayclock.h"
+#include "flightrecorder.h"
+#include "readerpool.h"
+#include "sensorfusion.h"
+#include "serialreader.h"
+#include "startuptrace.h"
+
+// Multi-vehicle mode: one PFD per serial port (or pseudo-terminal), laid out
+// in a grid. Every vehicle has its own reader, sample ring, interpolator and
+// snapshot; the readers share a small ReaderPool and one DisplayClock drives
+// all PFDs, so the per-vehicle cost is a ring drain and the repaint of
+// whatever changed on that PFD. Raw IMU from all vehicles is fused in one
+// SensorFusion batch per tick, one SIMD lane per vehicle.
+class FleetWindow : public QMainWindow {
+    Q_OBJECT
+
+public:
+    // recorder, if given, gets one channel per vehicle (channel id = grid index)
+    explicit FleetWindow(const QStringList &ports, FlightRecorder *recorder = nullptr,
+                         bool recordRawBytes = false, qint32 baudRate = QSerialPort::Baud115200,
+                         QWidget *parent = nullptr)
+    : QMainWindow(parent) {
+        setWindowTitle(QString("Horus Project - %1 vehicles").arg(ports.size()));
+
+        QWidget *grid = new QWidget(this);
+        QGridLayout *layout = new QGridLayout(grid);
+        layout->setSpacing(2);
+        layout->setContentsMargins(2, 2, 2, 2);
+        setCentralWidget(grid);
+        const int columns = qMax(1, static_cast<int>(std::ceil(std::sqrt(static_cast<double>(ports.size())))));
+
+        // Ingest is light next to painting: half the cores is plenty
+        readers.reset(new ReaderPool(qMin(static_cast<int>(ports.size()), qMax(1, QThread::idealThreadCount() / 2))));
+
+        for (int i = 0; i < ports.size(); i++) {
+            auto vehicle = std::unique_ptr<Vehicle>(new Vehicle);
+            vehicle->port = ports[i];
+            vehicle->telemetry.flightMode = "CONNECTING " + ports[i].toStdString();
+
+            vehicle->display = new AttitudeIndicator(grid);
+            vehicle->display->setMinimumSize(240, 240);
+            vehicle->display->setLatencyStats(&vehicle->latencyStats);
+            vehicle->display->setTelemetry(vehicle->telemetry);
+            connect(vehicle->display, &AttitudeIndicator::firstFramePainted, this, &FleetWindow::firstFramePainted);
+            layout->addWidget(vehicle->display, i / columns, i % columns);
+
+            vehicle->fusionLane = fusion.addVehicle();
+            vehicle->drained.resize(SampleRing::capacity());
+            vehicle->fusionSlots.resize(SampleRing::capacity());
+
+            vehicle->reader = new SerialReader(vehicle->ring);
+            vehicle->reader->setPortName(ports[i]);
+            vehicle->reader->setBaudRate(baudRate);
+            if (recorder) vehicle->reader->setRecorder(recorder->openChannel(static_cast<std::uint16_t>(i), recordRawBytes));
+            Vehicle *v = vehicle.get();
+            connect(vehicle->reader, &SerialReader::linkChanged, this, [this, v](bool up) { onLinkChanged(*v, up); });
+            vehicle->linkWaitNs = monotonicNowNs();
+            readers->adopt(vehicle->reader);
+            QMetaObject::invokeMethod(vehicle->reader, &SerialReader::openPort, Qt::QueuedConnection);
+
+            vehicles.push_back(std::move(vehicle));
+        }
+
+        displayClock = new DisplayClock(this, [this]() { updateVehicles(); });
+        displayClock->start();
+        // The PFDs share each display frame on the GUI thread
+        for (const auto &vehicle : vehicles) {
+            vehicle->display->setTargetFrameRate(displayClock->refreshHz() * vehicles.size());
+        }
+    }
+
+    ~FleetWindow() override {
+        // Stop the readers before the rings they push into go away
+        readers.reset();
+    }
+
+    void setCustomFonts(const QString &font1, const QString &font2) {
+        for (const auto &vehicle : vehicles) vehicle->display->setCustomFonts(font1, font2);
+    }
+
+    // See AttitudeIndicator::warmUp()
+    void warmUp() {
+        for (const auto &vehicle : vehicles) vehicle->display->warmUp();
+    }
+
+    // Madgwick by default; Off shows the angles the vehicles send
+    void setFusionAlgorithm(FusionAlgorithm algorithm) { fusion.setAlgorithm(algorithm); }
+
+    // See AttitudeInterpolator; a render delay of autoRenderDelay is one sample period
+    void setInterpolation(std::int64_t renderDelayNs, std::int64_t maxExtrapolationNs) {
+        for (const auto &vehicle : vehicles) {
+            vehicle->interpolator.setRenderDelayNs(renderDelayNs);
+            vehicle->interpolator.setMaxExtrapolationNs(maxExtrapolationNs);
+        }
+    }
+
+    int vehicleCount() const { return static_cast<int>(vehicles.size()); }
+    int readerThreadCount() const { return readers->threadCount(); }
+
+    // Fleet totals, for bench/fleet_bench.cpp
+    std::uint64_t samplesReceived() const {
+        std::uint64_t total = 0;
+        for (const auto &vehicle : vehicles) total += vehicle->received;
+        return total;
+    }
+
+    std::uint64_t samplesDropped() const {
+        std::uint64_t total = 0;
+        for (const auto &vehicle : vehicles) total += vehicle->ring.droppedCount();
+        return total;
+    }
+
+    std::uint64_t displayTicks() const { return ticks; }
+
+    int linkedCount() const {
+        int linked = 0;
+        for (const auto &vehicle : vehicles) linked += vehicle->linked ? 1 : 0;
+        return linked;
+    }
+
+signals:
+    // Each PFD's first frame; the first of them is the fleet's
+    void firstFramePainted(qint64 paintedNs);
+
+private slots:
+    void updateVehicles() {
+        const std::int64_t now = monotonicNowNs();
+        char clock[sizeof(TelemetrySnapshot::clock)];
+        std::time_t wall = std::time(nullptr);
+        std::strftime(clock, sizeof(clock), "%H:%M:%S", std::localtime(&wall));
+
+        for (const auto &vehicle : vehicles) drainVehicle(*vehicle, now);
+        fusion.fuse();
+        for (const auto &vehicle : vehicles) updateVehicle(*vehicle, now, clock);
+        ticks++;
+    }
+
+private:
+    struct Vehicle {
+        QString port;
+        SampleRing ring;
+        SerialReader *reader = nullptr;  // Owned by the reader pool
+        std::vector<TelemetrySample> drained;  // This tick's samples, see drainVehicle()
+        std::vector<int> fusionSlots;
+        std::size_t drainedCount = 0;
+        int fusionLane = 0;
+        AttitudeInterpolator interpolator;
+        AirData airData;
+        LatencyStats latencyStats;
+        TelemetrySample latest;
+        TelemetrySnapshot telemetry;
+        AttitudeIndicator *display = nullptr;
+        bool linked = false;
+        std::int64_t linkWaitNs = 0;  // Start of the wait for the first sample
+        std::uint64_t received = 0;
+    };
+
+    // The reader reconnects by itself; a vehicle whose link drops keeps its
+    // last values and shows them as stale
+    void onLinkChanged(Vehicle &vehicle, bool up) {
+        vehicle.linked = up;
+        if (up) StartupTrace::instance().mark(StartupTrace::PortOpened);
+        vehicle.telemetry.flightMode = (up ? "LINK " : "NO LINK ") + vehicle.port.toStdString();
+        vehicle.display->setTelemetry(vehicle.telemetry);
+    }
+
+    // Takes everything queued and hands its raw IMU to the shared fusion batch
+    void drainVehicle(Vehicle &vehicle, std::int64_t now) {
+        std::size_t count = 0;
+        while (count < vehicle.drained.size() && vehicle.ring.pop(vehicle.drained[count])) {
+            TelemetrySample &sample = vehicle.drained[count];
+            sample.handoffNs = now;
+            vehicle.latencyStats.recordHandoff(sample);
+            vehicle.fusionSlots[count] = fusion.add(vehicle.fusionLane, sample);
+            count++;
+        }
+        vehicle.latencyStats.recordDrain(count, vehicle.ring.droppedCount());
+        vehicle.drainedCount = count;
+    }
+
+    // Same handoff as the single-vehicle window, minus the simulated fields
+    void updateVehicle(Vehicle &vehicle, std::int64_t now, const char *clock) {
+        const std::size_t count = vehicle.drainedCount;
+        // The interpolator keeps the last two
+        for (std::size_t i = count > 2 ? count - 2 : 0; i < count; i++) {
+            fusion.apply(vehicle.fusionLane, vehicle.fusionSlots[i], vehicle.drained[i]);
+            vehicle.interpolator.addSample(vehicle.drained[i]);
+        }
+        for (std::size_t i = 0; i < count; i++) vehicle.airData.add(vehicle.drained[i]);
+        if (count > 0) {
+            const TelemetrySample &sample = vehicle.drained[count - 1];
+            vehicle.received += count;
+            vehicle.latest = sample;
+            vehicle.telemetry.sampleArrivedNs = sample.timestampNs;
+            vehicle.telemetry.sampleHandoffNs = sample.handoffNs;
+            vehicle.telemetry.sampleSensorTimeMs = sample.sensorTimeMs;
+        }
+        // A quiet link holds its values and is flagged on the PFD
+        TelemetrySnapshot &t = vehicle.telemetry;
+        t.staleMs = staleAgeMs(vehicle.latest.timestampNs ? vehicle.latest.timestampNs : vehicle.linkWaitNs, now);
+        if (!vehicle.interpolator.hasSample()) {
+            vehicle.display->setTelemetry(t);
+            return;
+        }
+
+        const TelemetrySample &latest = vehicle.latest;
+        const AttitudeInterpolator::Attitude attitude = vehicle.interpolator.at(now);
+        t.pitch = attitude.pitch;
+        t.roll = attitude.roll;
+        if (latest.has(HORUS_FIELD_ALTITUDE)) t.altitude = latest.altitude;
+        if (latest.has(HORUS_FIELD_SPEED)) t.speed = latest.airspeed;
+        if (latest.has(HORUS_FIELD_HEADING)) t.heading = latest.heading;
+        else if (latest.has(HORUS_FIELD_FUSED)) t.heading = latest.yaw;
+        if (latest.has(HORUS_FIELD_BATTERY)) {
+            t.batteryVolts = latest.batteryVolts;
+            t.batteryLevel = latest.batteryLevel;
+        }
+        if (latest.has(HORUS_FIELD_RPM)) {
+            t.propQuantity = 4;
+            for (int i = 0; i < 4; i++) t.rpm[i] = latest.rpm[i];
+        }
+        vehicle.airData.fill(t);
+        std::memcpy(t.clock, clock, sizeof(t.clock));
+        vehicle.display->setTelemetry(t);
+    }
+
+    std::vector<std::unique_ptr<Vehicle>> vehicles;
+    std::unique_ptr<ReaderPool> readers;
+    SensorFusion fusion;
+    DisplayClock *displayClock = nullptr;
+    std::uint64_t ticks = 0;
+};
+
+#endif // FLEETWINDOW_H
@@ -0,0 +1,137 @@
+#ifndef FLIGHTLOG_H
+#define FLIGHTLOG_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "firmware/horus_protocol.h"
+#include "telemetrysample.h"
+
+// On-disk format of the flight data recorder.
+//
+// A log is a directory of segment files, segment-000000.hfl, -000001, ...
+// Each segment is preallocated, memory mapped and laid out as
+//
+//   [header page, 4 KiB][time index, indexCapacity entries][records ...]
+//
+// Records are appended after dataOffset. The writer fills in record bytes
+// and index entries first and only then advances committedBytes/indexCount
+// in the header, so after a crash everything up to committedBytes is whole
+// and anything past it is ignored. Values are host endian (little endian on
+// every platform the PFD runs on); samples are stored as TelemetrySample,
+// whose size is recorded so a reader can refuse a mismatched layout.
+//
+// Timestamps are the host steady clock of the recording session;
+// createdSteadyNs/createdWallMs map them to wall time.
+
+static const char FLIGHT_LOG_MAGIC[8] = {'H', 'O', 'R', 'U', 'S', 'F', 'L', '1'};
+static const std::uint32_t FLIGHT_LOG_VERSION = 1;
+static const std::uint32_t FLIGHT_LOG_HEADER_SIZE = 4096;
+
+enum FlightLogRecordType : std::uint16_t {
+    FLIGHT_LOG_SAMPLE = 1,  // Payload: TelemetrySample
+    FLIGHT_LOG_RAW = 2      // Payload: bytes as read from the port
+};
+
+struct FlightLogSegmentHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t headerSize;
+    std::uint32_t sampleSize;         // sizeof(TelemetrySample) of the writer
+    std::uint32_t segmentIndex;
+    std::uint64_t segmentSize;        // Preallocated file size
+    std::uint64_t indexOffset;
+    std::uint64_t indexCapacity;
+    std::uint64_t dataOffset;
+    std::int64_t createdSteadyNs;
+    std::int64_t createdWallMs;       // Milliseconds since the Unix epoch
+    std::uint32_t headerChecksum;     // CRC-16 of everything above, widened
+    std::uint32_t reserved;
+
+    // Advanced by the writer after the data they cover is in place
+    std::uint64_t committedBytes;     // End of the last whole record, from file start
+    std::uint64_t indexCount;
+    std::uint64_t recordCount;
+    std::int64_t firstTimestampNs;
+    std::int64_t lastTimestampNs;
+    std::uint32_t closed;             // 1 once the writer finished the segment cleanly
+};
+
+struct FlightLogIndexEntry {
+    std::int64_t timestampNs;   // Of the record at offset
+    std::uint64_t offset;       // From file start
+};
+
+struct FlightLogRecordHeader {
+    std::uint16_t type;         // FlightLogRecordType
+    std::uint16_t channel;      // Vehicle / source the record came from
+    std::uint32_t size;         // Payload bytes, the record is padded to 8
+    std::int64_t timestampNs;
+};
+
+static_assert(sizeof(FlightLogSegmentHeader) <= FLIGHT_LOG_HEADER_SIZE, "header must fit its page");
+static_assert(sizeof(FlightLogRecordHeader) == 16, "records stay 8 byte aligned");
+
+inline std::size_t flightLogRecordSpan(std::uint32_t payloadSize) {
+    return sizeof(FlightLogRecordHeader) + ((payloadSize + 7u) & ~std::size_t(7));
+}
+
+inline std::uint32_t flightLogHeaderChecksum(const FlightLogSegmentHeader &header) {
+    return horusCrc16(reinterpret_cast<const std::uint8_t *>(&header), offsetof(FlightLogSegmentHeader, headerChecksum));
+}
+
+// Read-only view of one mapped segment; no copies, no allocation
+class FlightLogSegmentView {
+public:
+    // data/length: the whole mapped file
+    bool attach(const std::uint8_t *data, std::size_t length) {
+        base = nullptr;
+        if (length < FLIGHT_LOG_HEADER_SIZE) return false;
+        std::memcpy(&header, data, sizeof(header));
+        if (std::memcmp(header.magic, FLIGHT_LOG_MAGIC, sizeof(FLIGHT_LOG_MAGIC)) != 0) return false;
+        if (header.version != FLIGHT_LOG_VERSION) return false;
+        if (header.headerChecksum != flightLogHeaderChecksum(header)) return false;
+        if (header.sampleSize != sizeof(TelemetrySample)) return false;
+        if (header.dataOffset > length || header.committedBytes > length ||
+            header.committedBytes < header.dataOffset) return false;
+        if (header.indexOffset + header.indexCount * sizeof(FlightLogIndexEntry) > header.dataOffset) return false;
+
+        base = data;
+        return true;
+    }
+
+    bool isValid() const { return base != nullptr; }
+    const FlightLogSegmentHeader &info() const { return header; }
+    std::uint64_t begin() const { return header.dataOffset; }
+    std::uint64_t end() const { return header.committedBytes; }
+
+    // Record at offset, or false at the end / on a damaged record
+    bool recordAt(std::uint64_t offset, FlightLogRecordHeader &record, const std::uint8_t *&payload,
+                  std::uint64_t &next) const {
+        if (offset + sizeof(FlightLogRecordHeader) > header.committedBytes) return false;
+        std::memcpy(&record, base + offset, sizeof(record));
+        next = offset + flightLogRecordSpan(record.size);
+        if (next > header.committedBytes) return false;
+        payload = base + offset + sizeof(FlightLogRecordHeader);
+        return true;
+    }
+
+    // Offset of the last indexed record at or before timestampNs, O(log n)
+    std::uint64_t seek(std::int64_t timestampNs) const {
+        const auto *index = reinterpret_cast<const FlightLogIndexEntry *>(base + header.indexOffset);
+        std::uint64_t low = 0;
+        std::uint64_t high = header.indexCount;  // First entry after timestampNs
+        while (low < high) {
+            const std::uint64_t middle = low + (high - low) / 2;
+            if (index[middle].timestampNs <= timestampNs) low = middle + 1;
+            else high = middle;
+        }
+        return low == 0 ? header.dataOffset : index[low - 1].offset;
+    }
+
+private:
+    const std::uint8_t *base = nullptr;
+    FlightLogSegmentHeader header = {};
+};
+
+#endif // FLIGHTLOG_H
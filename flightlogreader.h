@@ -0,0 +1,109 @@
+#ifndef FLIGHTLOGREADER_H
+#define FLIGHTLOGREADER_H
+
+#include <QDir>
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "flightlog.h"
+
+// Read side of a flight log directory (flightlog.h). Every segment is mapped
+// read-only, so seeking is a binary search over segment start times and then
+// over that segment's time index; records are read in place.
+class FlightLogReader {
+public:
+    // Position of one record in the log
+    struct Cursor {
+        std::size_t segment = 0;
+        std::uint64_t offset = 0;
+    };
+
+    bool open(const QString &directory) {
+        close();
+        const QStringList names = QDir(directory).entryList(QStringList() << "segment-*.hfl", QDir::Files, QDir::Name);
+        for (const QString &name : names) {
+            Segment segment;
+            segment.file.reset(new QFile(QDir(directory).filePath(name)));
+            if (!segment.file->open(QIODevice::ReadOnly)) continue;
+            const qint64 length = segment.file->size();
+            const std::uint8_t *data = segment.file->map(0, length);
+            // A segment that never got a record, or a foreign file, is skipped
+            if (!data || !segment.view.attach(data, static_cast<std::size_t>(length)) ||
+                segment.view.info().recordCount == 0) {
+                continue;
+            }
+            segments.push_back(std::move(segment));
+        }
+        if (segments.empty()) {
+            error = QString("no readable flight log segments in %1").arg(directory);
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+        segments.clear();
+        error.clear();
+    }
+
+    const QString &errorString() const { return error; }
+    bool isOpen() const { return !segments.empty(); }
+
+    std::int64_t startNs() const { return segments.empty() ? 0 : segments.front().view.info().firstTimestampNs; }
+    std::int64_t endNs() const { return segments.empty() ? 0 : segments.back().view.info().lastTimestampNs; }
+
+    // Host wall clock of the first segment, to label the log
+    std::int64_t createdWallMs() const { return segments.empty() ? 0 : segments.front().view.info().createdWallMs; }
+
+    Cursor begin() const {
+        Cursor cursor;
+        if (!segments.empty()) cursor.offset = segments.front().view.begin();
+        return cursor;
+    }
+
+    // Cursor at an indexed record no later than timestampNs, at most one index
+    // interval before it. O(log segments + log index entries).
+    Cursor seek(std::int64_t timestampNs) const {
+        auto after = std::upper_bound(segments.begin(), segments.end(), timestampNs,
+                                      [](std::int64_t t, const Segment &segment) {
+                                          return t < segment.view.info().firstTimestampNs;
+                                      });
+        if (after == segments.begin()) return begin();
+
+        Cursor cursor;
+        cursor.segment = static_cast<std::size_t>(after - segments.begin()) - 1;
+        cursor.offset = segments[cursor.segment].view.seek(timestampNs);
+        return cursor;
+    }
+
+    // Reads the record at cursor and advances it; false at the end of the log
+    bool next(Cursor &cursor, FlightLogRecordHeader &record, const std::uint8_t *&payload) const {
+        while (cursor.segment < segments.size()) {
+            std::uint64_t following;
+            if (segments[cursor.segment].view.recordAt(cursor.offset, record, payload, following)) {
+                cursor.offset = following;
+                return true;
+            }
+            // Past the committed end (or a damaged tail): on to the next segment
+            cursor.segment++;
+            if (cursor.segment < segments.size()) cursor.offset = segments[cursor.segment].view.begin();
+        }
+        return false;
+    }
+
+private:
+    struct Segment {
+        std::unique_ptr<QFile> file;  // Owns the mapping
+        FlightLogSegmentView view;
+    };
+
+    std::vector<Segment> segments;
+    QString error;
+};
+
+#endif // FLIGHTLOGREADER_H
@@ -0,0 +1,454 @@
+#ifndef FLIGHTRECORDER_H
+#define FLIGHTRECORDER_H
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QString>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "flightlog.h"
+#include "spscring.h"
+#include "telemetrysample.h"
+
+#ifdef Q_OS_UNIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// Defaults hold about 13 minutes of index and a few minutes of 1 kHz data per segment
+struct FlightRecorderOptions {
+    std::uint64_t segmentBytes = 64ull << 20;
+    std::uint64_t indexCapacity = 8192;   // Time index entries per segment
+    std::int64_t indexIntervalNs = 100'000'000;
+    int syncIntervalMs = 1000;            // Power loss costs at most this much
+};
+
+// Flight data recorder: appends every decoded sample, and optionally the raw
+// port bytes, to a segmented log (flightlog.h) from a background thread.
+//
+// Producers only copy into a per-channel SpscRing, so recording costs the
+// ingest thread a memcpy and never a syscall or a lock. The writer drains the
+// rings into preallocated, memory-mapped segments and publishes each batch in
+// the segment header. Memory stays bounded: the rings are fixed, one segment
+// is mapped at a time and dirty pages are synced every syncIntervalMs. If the
+// writer falls behind, the oldest queued records are dropped and counted.
+class FlightRecorder {
+    // How much the writer takes from one ring per pass
+    static constexpr int batchLimit = 512;
+
+public:
+    // One producer thread's queue into the recorder
+    class Channel {
+    public:
+        // Producer side; cheap enough for the ingest path
+        void record(const TelemetrySample &sample) {
+            samples.push(sample);
+        }
+
+        void recordRaw(const void *data, std::size_t length, std::int64_t timestampNs) {
+            const auto *bytes = static_cast<const std::uint8_t *>(data);
+            while (length > 0) {
+                RawChunk chunk;
+                chunk.timestampNs = timestampNs;
+                chunk.length = static_cast<std::uint16_t>(length < sizeof(chunk.bytes) ? length : sizeof(chunk.bytes));
+                std::memcpy(chunk.bytes, bytes, chunk.length);
+                rawChunks.push(chunk);
+                bytes += chunk.length;
+                length -= chunk.length;
+            }
+        }
+
+        bool recordsRawBytes() const { return rawBytes; }
+        std::uint16_t id() const { return channelId; }
+
+        // Records evicted because the writer fell behind
+        std::uint64_t droppedCount() const { return samples.droppedCount() + rawChunks.droppedCount(); }
+
+    private:
+        friend class FlightRecorder;
+
+        struct RawChunk {
+            std::int64_t timestampNs;
+            std::uint16_t length;
+            std::uint8_t bytes[246];
+        };
+
+        // Writer side: entries popped from a ring, waiting for the merge
+        template <typename T>
+        struct Staged {
+            T entries[batchLimit];
+            int head = 0;
+            int count = 0;
+            bool more = false;  // Stopped at batchLimit; the ring may hold later ones
+
+            template <typename Ring>
+            void refill(Ring &ring) {
+                if (head > 0) {
+                    std::memmove(entries, entries + head, (count - head) * sizeof(T));
+                    count -= head;
+                    head = 0;
+                }
+                while (count < batchLimit && ring.pop(entries[count])) count++;
+                more = count == batchLimit;
+            }
+
+            bool empty() const { return head == count; }
+            std::int64_t headTimestampNs() const { return entries[head].timestampNs; }
+            std::int64_t lastTimestampNs() const { return entries[count - 1].timestampNs; }
+        };
+
+        Channel(std::uint16_t id, bool raw) : channelId(id), rawBytes(raw) {}
+
+        std::uint16_t channelId;
+        bool rawBytes;
+        SpscRing<TelemetrySample, 4096> samples;  // Seconds of 1 kHz headroom
+        SpscRing<RawChunk, 1024> rawChunks;
+        Staged<TelemetrySample> stagedSamples;
+        Staged<RawChunk> stagedRaw;
+    };
+
+    explicit FlightRecorder(const QString &directory, const FlightRecorderOptions &options = FlightRecorderOptions())
+    : directory(directory), options(options) {
+    }
+
+    ~FlightRecorder() {
+        stop();
+    }
+
+    FlightRecorder(const FlightRecorder &) = delete;
+    FlightRecorder &operator=(const FlightRecorder &) = delete;
+
+    // Call before start(); the recorder owns the channel
+    Channel *openChannel(std::uint16_t id, bool rawBytes = false) {
+        channels.push_back(std::unique_ptr<Channel>(new Channel(id, rawBytes)));
+        return channels.back().get();
+    }
+
+    // Creates the log directory and the first segment, then starts the writer
+    bool start() {
+        if (writer.joinable()) return true;
+        if (!QDir().mkpath(directory)) {
+            setError(QString("could not create %1").arg(directory));
+            return false;
+        }
+        if (QFile::exists(segmentPath(0))) {
+            setError(QString("%1 already holds a flight log").arg(directory));
+            return false;
+        }
+
+        running.store(true, std::memory_order_relaxed);
+        writer = std::thread([this]() { run(); });
+        return true;
+    }
+
+    // Drains what is queued, closes the segment and joins the writer
+    void stop() {
+        if (!writer.joinable()) return;
+        running.store(false, std::memory_order_relaxed);
+        writer.join();
+    }
+
+    bool isRecording() const { return writer.joinable() && !failed.load(std::memory_order_relaxed); }
+    const QString &path() const { return directory; }
+
+    std::uint64_t recordCount() const { return records.load(std::memory_order_relaxed); }
+    std::uint64_t bytesWritten() const { return bytes.load(std::memory_order_relaxed); }
+    std::uint32_t segmentCount() const { return segments.load(std::memory_order_relaxed); }
+
+    std::uint64_t droppedCount() const {
+        std::uint64_t dropped = 0;
+        for (const auto &channel : channels) dropped += channel->droppedCount();
+        return dropped;
+    }
+
+    // msync() calls that failed, see sync()
+    std::uint64_t syncFailureCount() const { return syncFailures.load(std::memory_order_relaxed); }
+
+    QString lastError() const {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        return error;
+    }
+
+private:
+    QString segmentPath(std::uint32_t index) const {
+        return QDir(directory).filePath(QString("segment-%1.hfl").arg(index, 6, 10, QChar('0')));
+    }
+
+    void setError(const QString &message) {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        error = message;
+    }
+
+    void run() {
+        auto lastSync = std::chrono::steady_clock::now();
+        for (;;) {
+            // Read the flag first so a stop() racing a push still gets drained
+            const bool keepRunning = running.load(std::memory_order_relaxed);
+            const int written = drainChannels();
+            if (written > 0) commit();
+
+            const auto now = std::chrono::steady_clock::now();
+            if (now - lastSync >= std::chrono::milliseconds(options.syncIntervalMs)) {
+                sync();
+                lastSync = now;
+            }
+
+            if (written == 0) {
+                if (!keepRunning) break;
+                // Polling keeps producers free of wake-ups; 4096 slots cover it
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            }
+        }
+        closeSegment();
+    }
+
+    // Merges the channels by timestamp, so the log is in time order and a
+    // segment's first timestamp bounds everything after it. A ring that had
+    // more than batchLimit queued may hold older entries than another's
+    // staged ones, so nothing past its last staged timestamp goes out yet.
+    int drainChannels() {
+        std::int64_t cutoff = LLONG_MAX;
+        for (const auto &channel : channels) {
+            channel->stagedSamples.refill(channel->samples);
+            channel->stagedRaw.refill(channel->rawChunks);
+            if (channel->stagedSamples.more) cutoff = std::min(cutoff, channel->stagedSamples.lastTimestampNs());
+            if (channel->stagedRaw.more) cutoff = std::min(cutoff, channel->stagedRaw.lastTimestampNs());
+        }
+
+        int written = 0;
+        for (;;) {
+            Channel *oldest = nullptr;
+            bool raw = false;
+            std::int64_t oldestNs = LLONG_MAX;
+            for (const auto &channel : channels) {
+                if (!channel->stagedSamples.empty() && channel->stagedSamples.headTimestampNs() < oldestNs) {
+                    oldest = channel.get();
+                    raw = false;
+                    oldestNs = channel->stagedSamples.headTimestampNs();
+                }
+                if (!channel->stagedRaw.empty() && channel->stagedRaw.headTimestampNs() < oldestNs) {
+                    oldest = channel.get();
+                    raw = true;
+                    oldestNs = channel->stagedRaw.headTimestampNs();
+                }
+            }
+            if (!oldest || oldestNs > cutoff) break;
+
+            if (raw) {
+                const Channel::RawChunk &chunk = oldest->stagedRaw.entries[oldest->stagedRaw.head++];
+                append(FLIGHT_LOG_RAW, oldest->channelId, chunk.timestampNs, chunk.bytes, chunk.length);
+            } else {
+                const TelemetrySample &sample = oldest->stagedSamples.entries[oldest->stagedSamples.head++];
+                append(FLIGHT_LOG_SAMPLE, oldest->channelId, sample.timestampNs, &sample, sizeof(sample));
+            }
+            written++;
+        }
+        return written;
+    }
+
+    void append(std::uint16_t type, std::uint16_t channel, std::int64_t timestampNs,
+                const void *payload, std::uint32_t size) {
+        if (failed.load(std::memory_order_relaxed)) return;
+
+        const std::uint64_t span = flightLogRecordSpan(size);
+        const bool wantsIndex = timestampNs >= nextIndexNs;
+        if (!map || writeOffset + span > header()->segmentSize ||
+            (wantsIndex && indexCount == header()->indexCapacity)) {
+            commit();
+            closeSegment();
+            if (!openSegment()) return;
+        }
+
+        if (timestampNs >= nextIndexNs) {
+            FlightLogIndexEntry entry = {timestampNs, writeOffset};
+            std::memcpy(map + header()->indexOffset + indexCount * sizeof(entry), &entry, sizeof(entry));
+            indexCount++;
+            nextIndexNs = timestampNs + options.indexIntervalNs;
+        }
+
+        FlightLogRecordHeader record = {type, channel, size, timestampNs};
+        std::memcpy(map + writeOffset, &record, sizeof(record));
+        std::memcpy(map + writeOffset + sizeof(record), payload, size);
+        // Padding stays zero: the segment was freshly allocated
+        writeOffset += span;
+        recordCountInSegment++;
+        if (firstTimestampNs == LLONG_MIN) firstTimestampNs = timestampNs;
+        lastTimestampNs = timestampNs;
+    }
+
+    // Publishes appended records: data and index first, then the header
+    void commit() {
+        if (!map) return;
+        std::atomic_thread_fence(std::memory_order_release);
+        FlightLogSegmentHeader *h = header();
+        h->indexCount = indexCount;
+        h->recordCount = recordCountInSegment;
+        h->firstTimestampNs = firstTimestampNs;
+        h->lastTimestampNs = lastTimestampNs;
+        std::atomic_thread_fence(std::memory_order_release);
+        h->committedBytes = writeOffset;
+
+        records.fetch_add(recordCountInSegment - publishedRecords, std::memory_order_relaxed);
+        bytes.fetch_add(writeOffset - publishedBytes, std::memory_order_relaxed);
+        publishedRecords = recordCountInSegment;
+        publishedBytes = writeOffset;
+    }
+
+    bool openSegment() {
+        file.reset(new QFile(segmentPath(segmentIndex)));
+        if (!file->open(QIODevice::ReadWrite | QIODevice::Truncate) ||
+            !file->resize(static_cast<qint64>(options.segmentBytes))) {
+            return fail(QString("could not allocate %1: %2").arg(file->fileName(), file->errorString()));
+        }
+        const int reserveError = reserveBlocks();
+        if (reserveError == ENOSPC || reserveError == EFBIG) {
+            // A store into a mapped hole the disk cannot back is a SIGBUS
+            return fail(QString("no room for %1: %2").arg(file->fileName(), QString::fromLocal8Bit(std::strerror(reserveError))));
+        }
+        map = file->map(0, static_cast<qint64>(options.segmentBytes));
+        if (!map) {
+            return fail(QString("could not map %1: %2").arg(file->fileName(), file->errorString()));
+        }
+
+        FlightLogSegmentHeader h = {};
+        std::memcpy(h.magic, FLIGHT_LOG_MAGIC, sizeof(h.magic));
+        h.version = FLIGHT_LOG_VERSION;
+        h.headerSize = FLIGHT_LOG_HEADER_SIZE;
+        h.sampleSize = sizeof(TelemetrySample);
+        h.segmentIndex = segmentIndex;
+        h.segmentSize = options.segmentBytes;
+        h.indexOffset = FLIGHT_LOG_HEADER_SIZE;
+        h.indexCapacity = options.indexCapacity;
+        h.dataOffset = (h.indexOffset + options.indexCapacity * sizeof(FlightLogIndexEntry) + 4095) & ~std::uint64_t(4095);
+        h.createdSteadyNs = monotonicNowNs();
+        h.createdWallMs = QDateTime::currentMSecsSinceEpoch();
+        h.headerChecksum = flightLogHeaderChecksum(h);
+        h.committedBytes = h.dataOffset;
+        h.firstTimestampNs = LLONG_MIN;
+        h.lastTimestampNs = LLONG_MIN;
+        std::memcpy(map, &h, sizeof(h));
+
+        writeOffset = h.dataOffset;
+        syncedOffset = h.dataOffset;
+        indexCount = 0;
+        recordCountInSegment = 0;
+        publishedRecords = 0;
+        publishedBytes = h.dataOffset;
+        firstTimestampNs = LLONG_MIN;
+        lastTimestampNs = LLONG_MIN;
+        nextIndexNs = LLONG_MIN;  // Every segment starts with an index entry
+        segmentIndex++;
+        segments.store(segmentIndex, std::memory_order_relaxed);
+        // Header bytes are not counted in bytesWritten
+        return true;
+    }
+
+    // Reserves the segment's blocks; a sparse file would fault them in one page
+    // at a time. Returns 0 or an errno. Anything but running out of space just
+    // leaves the file sparse: the filesystem cannot preallocate.
+    int reserveBlocks() {
+#if defined(Q_OS_LINUX)
+        return posix_fallocate(file->handle(), 0, static_cast<off_t>(options.segmentBytes));
+#elif defined(Q_OS_MACOS)
+        fstore_t store = {F_ALLOCATECONTIG | F_ALLOCATEALL, F_PEOFPOSMODE, 0,
+                          static_cast<off_t>(options.segmentBytes), 0};
+        if (fcntl(file->handle(), F_PREALLOCATE, &store) == 0) return 0;
+        store.fst_flags = F_ALLOCATEALL;  // Fragmented is still better than sparse
+        return fcntl(file->handle(), F_PREALLOCATE, &store) == 0 ? 0 : errno;
+#else
+        return 0;
+#endif
+    }
+
+    // Flushes dirty pages: records first, then the header that covers them
+    void sync() {
+        if (!map) return;
+#ifdef Q_OS_UNIX
+        static const std::uint64_t page = static_cast<std::uint64_t>(sysconf(_SC_PAGESIZE));
+        const std::uint64_t start = syncedOffset & ~(page - 1);
+        const std::uint64_t end = header()->committedBytes;
+        if (end > start && msync(map + start, end - start, MS_SYNC) != 0) {
+            syncFailed(errno);
+            return;  // Retried from the same offset next time
+        }
+        if (msync(map, header()->dataOffset, MS_SYNC) != 0) {
+            syncFailed(errno);
+            return;
+        }
+        syncedOffset = end;
+#endif
+    }
+
+    // The data is still mapped and the kernel writes it back eventually, so
+    // recording goes on; the count and lastError() say durability is at risk
+    void syncFailed(int errorCode) {
+        syncFailures.fetch_add(1, std::memory_order_relaxed);
+        setError(QString("could not sync %1: %2").arg(file->fileName(), QString::fromLocal8Bit(std::strerror(errorCode))));
+    }
+
+    // Marks the segment closed and trims the unused preallocation
+    void closeSegment() {
+        if (!map) return;
+        commit();
+        header()->closed = 1;
+        sync();
+        const std::uint64_t used = writeOffset;
+        file->unmap(map);
+        map = nullptr;
+        file->resize(static_cast<qint64>(used));
+        file->close();
+        file.reset();
+    }
+
+    bool fail(const QString &message) {
+        setError(message);
+        failed.store(true, std::memory_order_relaxed);
+        map = nullptr;
+        file.reset();
+        return false;
+    }
+
+    FlightLogSegmentHeader *header() const {
+        return reinterpret_cast<FlightLogSegmentHeader *>(map);
+    }
+
+    const QString directory;
+    const FlightRecorderOptions options;
+    std::vector<std::unique_ptr<Channel>> channels;
+    std::thread writer;
+    std::atomic<bool> running{false};
+    std::atomic<bool> failed{false};
+    std::atomic<std::uint64_t> records{0};
+    std::atomic<std::uint64_t> bytes{0};
+    std::atomic<std::uint32_t> segments{0};
+    std::atomic<std::uint64_t> syncFailures{0};
+    mutable std::mutex errorMutex;
+    QString error;
+
+    // Writer thread only
+    std::unique_ptr<QFile> file;
+    std::uint8_t *map = nullptr;
+    std::uint32_t segmentIndex = 0;
+    std::uint64_t writeOffset = 0;
+    std::uint64_t syncedOffset = 0;
+    std::uint64_t indexCount = 0;
+    std::uint64_t recordCountInSegment = 0;
+    std::uint64_t publishedRecords = 0;
+    std::uint64_t publishedBytes = 0;
+    std::int64_t firstTimestampNs = LLONG_MIN;
+    std::int64_t lastTimestampNs = LLONG_MIN;
+    std::int64_t nextIndexNs = LLONG_MIN;
+};
+
+#endif // FLIGHTRECORDER_H
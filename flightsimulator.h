@@ -0,0 +1,333 @@
+#ifndef FLIGHTSIMULATOR_H
+#define FLIGHTSIMULATOR_H
+
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include "firmware/horus_protocol.h"
+#include "telemetrysample.h"
+
+#ifdef Q_OS_UNIX
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+// A small fixed-wing vehicle flown by a scripted autopilot, advanced in
+// fixed steps. Every step is a full sample: attitude, raw IMU consistent with
+// it, altitude, airspeed, heading, battery and four motors' RPM. Everything
+// random comes from one seeded mt19937, so a seed and a rate always give the
+// same flight, step for step.
+//
+// Attitude uses the firmware's Z-X-Y convention (pitch about the sensor's X
+// axis, roll about Y), so host fusion of the raw IMU lands on the attitude
+// sent. The accelerometer reads gravity only.
+class FlightModel {
+public:
+    static constexpr double minRate = 50.0;
+    static constexpr double maxRate = 2000.0;
+
+    explicit FlightModel(std::uint32_t seed = 1, double rateHz = 50.0)
+    : random(seed), stepSeconds(1.0 / std::clamp(rateHz, minRate, maxRate)) {
+        newSegment();
+    }
+
+    double rate() const { return 1.0 / stepSeconds; }
+    std::uint64_t stepCount() const { return steps; }
+
+    void step() {
+        const double dt = stepSeconds;
+        steps++;
+        segmentLeft -= dt;
+        if (segmentLeft <= 0) newSegment();
+
+        // Attitude: rate-limited toward the targets, plus turbulence
+        turbulence(dt);
+        pitch += std::clamp(2.0 * (targetPitch - pitch), -radians(20), radians(20)) * dt + gust[0] * dt;
+        roll += std::clamp(1.5 * (targetRoll - roll), -radians(60), radians(60)) * dt + gust[1] * dt;
+        pitch = std::clamp(pitch, -radians(60), radians(60));
+        roll = std::clamp(roll, -radians(80), radians(80));
+
+        // Coordinated turn; heading is clockwise, right wing down turns right
+        heading = std::fmod(heading + gravity * std::tan(roll) / airspeed * dt + gust[2] * dt + 2 * pi, 2 * pi);
+
+        throttle += (targetThrottle - throttle) * std::min(1.0, 2.0 * dt);
+        const double thrust = 6.0 * throttle;  // m/s^2
+        const double drag = 0.004 * airspeed * airspeed;
+        airspeed = std::clamp(airspeed + (thrust - drag - gravity * std::sin(pitch)) * dt, 12.0, 60.0);
+        altitude = std::max(0.0, altitude + airspeed * std::sin(pitch) * dt);
+
+        // A fresh pack when this one runs low: 20 minutes at full throttle
+        charge -= (0.1 + 0.9 * throttle) / 1200.0 * dt;
+        if (charge < 0.1) charge = 1.0;
+
+        std::normal_distribution<double> rpmNoise(0.0, 15.0);
+        for (int i = 0; i < 4; i++) {
+            const double target = 1500.0 + 6500.0 * throttle + 40.0 * i;
+            rpm[i] += (target - rpm[i]) * std::min(1.0, dt / 0.15) + rpmNoise(random) * std::sqrt(dt);
+        }
+
+        updateQuaternion(dt);
+    }
+
+    // The current state as one sample; timestamps are left to the caller
+    void fill(TelemetrySample &sample) const {
+        constexpr double feet = 3.28084, knots = 1.94384;
+        const double degrees = 180.0 / pi;
+        sample.sensorTimeMs = static_cast<std::uint32_t>(bootMs + static_cast<double>(steps) * stepSeconds * 1000.0);
+        sample.fields = HORUS_FIELD_ATTITUDE | HORUS_FIELD_RAW_IMU | HORUS_FIELD_ALTITUDE | HORUS_FIELD_SPEED |
+                        HORUS_FIELD_HEADING | HORUS_FIELD_BATTERY | HORUS_FIELD_RPM;
+        sample.pitch = static_cast<float>(pitch * degrees);
+        sample.roll = static_cast<float>(roll * degrees);
+        const double headingDegrees = heading * degrees;
+        sample.yaw = static_cast<float>(headingDegrees > 180.0 ? headingDegrees - 360.0 : headingDegrees);
+        sample.heading = static_cast<float>(headingDegrees);
+        sample.altitude = static_cast<float>(altitude * feet);
+        sample.airspeed = static_cast<float>(airspeed * knots);
+        sample.batteryVolts = static_cast<float>(4 * (3.3 + 0.9 * charge) - 0.8 * throttle);  // 4S pack, sagging
+        sample.batteryLevel = static_cast<float>(charge);
+        for (int i = 0; i < 4; i++) sample.rpm[i] = static_cast<std::uint16_t>(std::clamp(rpm[i], 0.0, 65535.0));
+
+        // Gravity in the sensor frame, and the body rates that took q from
+        // the previous step's attitude to this one's
+        const double g[3] = {
+            2.0 * (q[1] * q[3] - q[0] * q[2]),
+            2.0 * (q[0] * q[1] + q[2] * q[3]),
+            q[0] * q[0] - q[1] * q[1] - q[2] * q[2] + q[3] * q[3],
+        };
+        for (int i = 0; i < 3; i++) {
+            sample.accel[i] = lsb(g[i] * HORUS_ACCEL_LSB_PER_G);
+            sample.gyro[i] = lsb(bodyRate[i] * degrees * HORUS_GYRO_LSB_PER_DPS);
+        }
+    }
+
+private:
+    static constexpr double pi = 3.14159265358979323846;
+    static constexpr double gravity = 9.80665;
+    static constexpr double bootMs = 1000.0;  // Senders' clocks never start at 0
+
+    static double radians(double degrees) { return degrees * pi / 180.0; }
+
+    static std::int16_t lsb(double value) {
+        return static_cast<std::int16_t>(std::clamp(std::lround(value), -32768l, 32767l));
+    }
+
+    // The autopilot's next manoeuvre: a bank, a climb or descent, a power setting
+    void newSegment() {
+        std::uniform_real_distribution<double> seconds(8.0, 20.0), bank(-40.0, 40.0), climb(-5.0, 12.0),
+            power(0.45, 1.0), chance(0.0, 1.0);
+        segmentLeft = seconds(random);
+        targetRoll = chance(random) < 0.3 ? 0.0 : radians(bank(random));
+        targetPitch = radians(climb(random));
+        targetThrottle = power(random);
+        // Stay between 1000 and 4000 m
+        if (altitude < 1000.0) targetPitch = std::abs(targetPitch) + radians(3);
+        if (altitude > 4000.0) targetPitch = -std::abs(targetPitch) - radians(3);
+    }
+
+    // Band-limited turbulence on pitch, roll and heading rates (rad/s)
+    void turbulence(double dt) {
+        constexpr double tau = 0.5, sigma = 0.05;
+        std::normal_distribution<double> unit(0.0, 1.0);
+        for (double &g : gust) g += -g / tau * dt + sigma * std::sqrt(2.0 / tau * dt) * unit(random);
+    }
+
+    // q = yaw (about up, counter-clockwise) * pitch (X) * roll (Y)
+    void updateQuaternion(double dt) {
+        const double cy = std::cos(-heading / 2), sy = std::sin(-heading / 2);
+        const double cp = std::cos(pitch / 2), sp = std::sin(pitch / 2);
+        const double cr = std::cos(roll / 2), sr = std::sin(roll / 2);
+        const double pr[4] = {cp * cr, sp * cr, cp * sr, sp * sr};
+        const double next[4] = {
+            cy * pr[0] - sy * pr[3],
+            cy * pr[1] - sy * pr[2],
+            cy * pr[2] + sy * pr[1],
+            cy * pr[3] + sy * pr[0],
+        };
+
+        // conj(q) * next = (1, w dt / 2) for a small step
+        double d[4] = {
+            q[0] * next[0] + q[1] * next[1] + q[2] * next[2] + q[3] * next[3],
+            q[0] * next[1] - q[1] * next[0] - q[2] * next[3] + q[3] * next[2],
+            q[0] * next[2] + q[1] * next[3] - q[2] * next[0] - q[3] * next[1],
+            q[0] * next[3] - q[1] * next[2] + q[2] * next[1] - q[3] * next[0],
+        };
+        if (d[0] < 0) for (double &c : d) c = -c;
+        for (int i = 0; i < 3; i++) bodyRate[i] = steps > 1 ? 2.0 * d[i + 1] / dt : 0.0;
+        for (int i = 0; i < 4; i++) q[i] = next[i];
+    }
+
+    std::mt19937 random;
+    const double stepSeconds;
+    std::uint64_t steps = 0;
+
+    double segmentLeft = 0;
+    double targetPitch = 0, targetRoll = 0, targetThrottle = 0.6;
+
+    double pitch = 0, roll = 0, heading = 0;  // rad
+    double gust[3] = {};
+    double airspeed = 36.0;   // m/s
+    double altitude = 2591.0; // m
+    double throttle = 0.6;
+    double charge = 1.0;      // Battery, 0..1
+    double rpm[4] = {5400, 5440, 5480, 5520};
+    double q[4] = {1, 0, 0, 0};
+    double bodyRate[3] = {};  // rad/s, sensor frame
+};
+
+#ifdef Q_OS_UNIX
+// The master side of a pseudo-terminal that frames are written to; readers
+// open slavePath() like a serial port. Writes never block: a frame that
+// does not fit while nobody reads is dropped.
+class PtyWriter {
+public:
+    PtyWriter() = default;
+    PtyWriter(const PtyWriter &) = delete;
+    PtyWriter &operator=(const PtyWriter &) = delete;
+    ~PtyWriter() { close(); }
+
+    bool open() {
+        close();
+        master = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+        if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+            close();
+            return false;
+        }
+        termios tio;
+        if (tcgetattr(master, &tio) == 0) {
+            cfmakeraw(&tio);
+            tcsetattr(master, TCSANOW, &tio);
+        }
+        slave = ptsname(master);
+        return true;
+    }
+
+    void close() {
+        if (master >= 0) ::close(master);
+        master = -1;
+        slave.clear();
+    }
+
+    bool isOpen() const { return master >= 0; }
+    const std::string &slavePath() const { return slave; }
+
+    bool write(const std::uint8_t *data, std::size_t length) {
+        return master >= 0 && ::write(master, data, length) == static_cast<ssize_t>(length);
+    }
+
+private:
+    int master = -1;
+    std::string slave;
+};
+#endif
+
+// Flies a FlightModel in real time on its own QThread, as a load generator
+// and as the display's stand-in when there is no vehicle. Samples go into a
+// SampleRing, like a SerialReader's, or with openPty() out through a
+// pseudo-terminal as binary frames, so a SerialReader (this process's or
+// another's) decodes them like a real port.
+//
+// Steps are fixed; each timer tick runs every step the clock has passed.
+// Configure before start(); drive it with queued calls.
+class FlightSimulator : public QObject {
+    Q_OBJECT
+
+public:
+    explicit FlightSimulator(SampleRing &ring, QObject *parent = nullptr)
+    : QObject(parent), sampleRing(ring) {
+    }
+
+    void setRate(double hz) { rateHz = std::clamp(hz, FlightModel::minRate, FlightModel::maxRate); }
+    void setSeed(std::uint32_t value) { seed = value; }
+    double rate() const { return rateHz; }
+
+#ifdef Q_OS_UNIX
+    // Sends frames to a new pseudo-terminal instead of the ring; returns its
+    // slave path, or an empty string
+    QString openPty() {
+        return pty.open() ? QString::fromStdString(pty.slavePath()) : QString();
+    }
+#endif
+
+    // Any thread
+    std::uint64_t stepCount() const { return steps.load(std::memory_order_relaxed); }
+    std::uint64_t droppedFrameCount() const { return droppedFrames.load(std::memory_order_relaxed); }  // pty full
+
+public slots:
+    void start() {
+        model.reset(new FlightModel(seed, rateHz));
+        periodNs = static_cast<std::int64_t>(1e9 / rateHz);
+        nextStepNs = monotonicNowNs();
+        if (!timer) {
+            timer = new QTimer(this);
+            timer->setTimerType(Qt::PreciseTimer);
+            connect(timer, &QTimer::timeout, this, &FlightSimulator::tick);
+        }
+        timer->start(1);
+    }
+
+    void stop() {
+        if (timer) timer->stop();
+    }
+
+    // Back to the ring, e.g. when nothing could open the pty
+    void closePty() {
+#ifdef Q_OS_UNIX
+        pty.close();
+#endif
+    }
+
+private slots:
+    void tick() {
+        const std::int64_t now = monotonicNowNs();
+        // After a stall (a suspended laptop) carry on from now, not from then
+        if (now - nextStepNs > 1'000'000'000) nextStepNs = now;
+
+        TelemetrySample sample;
+        while (nextStepNs <= now) {
+            model->step();
+            model->fill(sample);
+            emitSample(sample, now);
+            nextStepNs += periodNs;
+        }
+        steps.store(model->stepCount(), std::memory_order_relaxed);
+    }
+
+private:
+    void emitSample(TelemetrySample &sample, std::int64_t now) {
+#ifdef Q_OS_UNIX
+        if (pty.isOpen()) {
+            std::uint8_t frame[HORUS_MAX_FRAME_SIZE];
+            const std::size_t length = horusEncodeTelemetry(toHorusTelemetry(sample, sequence++), frame);
+            if (!pty.write(frame, length)) droppedFrames.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+#endif
+        sample.timestampNs = now;
+        sample.parsedNs = now;
+        sampleRing.push(sample);
+    }
+
+    SampleRing &sampleRing;
+    std::unique_ptr<FlightModel> model;
+    double rateHz = FlightModel::minRate;
+    std::uint32_t seed = 1;
+    QTimer *timer = nullptr;
+    std::int64_t periodNs = 0;
+    std::int64_t nextStepNs = 0;
+    std::uint16_t sequence = 0;
+#ifdef Q_OS_UNIX
+    PtyWriter pty;
+#endif
+    std::atomic<std::uint64_t> steps{0};
+    std::atomic<std::uint64_t> droppedFrames{0};
+};
+
+#endif // FLIGHTSIMULATOR_H
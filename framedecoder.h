@@ -0,0 +1,141 @@
+#ifndef FRAMEDECODER_H
+#define FRAMEDECODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "firmware/horus_protocol.h"
+#include "telemetrysample.h"
+
+// Streaming decoder for the binary telemetry frames in firmware/horus_protocol.h.
+// Bytes can arrive in any chunking; frames are assembled in a fixed buffer and
+// decoded in place, so there is no allocation on the ingest path.
+class FrameDecoder {
+public:
+    // Larger forward steps are the sequence going backwards, modulo 2^16
+    static constexpr std::uint16_t maxSequenceGap = 0x8000;
+
+    // Calls onSample(const TelemetrySample &) for every valid frame
+    template <typename SampleHandler>
+    void feed(const std::uint8_t *data, std::size_t length, std::int64_t arrivedNs, SampleHandler &&onSample) {
+        const std::uint8_t *end = data + length;
+        while (data != end) {
+            const void *zero = std::memchr(data, 0, static_cast<std::size_t>(end - data));
+            const std::uint8_t *chunkEnd = zero ? static_cast<const std::uint8_t *>(zero) : end;
+            append(data, static_cast<std::size_t>(chunkEnd - data));
+
+            if (!zero) return;
+            finishFrame(arrivedNs, onSample);
+            data = chunkEnd + 1;
+        }
+    }
+
+    void reset() {
+        frameLength = 0;
+        discarding = false;
+        haveSequence = false;
+    }
+
+    std::uint64_t frameCount() const { return frames; }
+    std::uint64_t crcErrorCount() const { return crcErrors; }
+    std::uint64_t framingErrorCount() const { return framingErrors; }  // Bad COBS, size, version
+    std::uint64_t sequenceGapCount() const { return sequenceGaps; }    // Frames missing between good ones
+    std::uint64_t sequenceResyncCount() const { return sequenceResyncs; }  // Sender restarts, reordered frames
+
+private:
+    void append(const std::uint8_t *data, std::size_t length) {
+        if (discarding) return;
+        if (frameLength + length > sizeof(frame)) {
+            // Too long to be one of ours: skip to the next delimiter
+            discarding = true;
+            return;
+        }
+        std::memcpy(frame + frameLength, data, length);
+        frameLength += length;
+    }
+
+    template <typename SampleHandler>
+    void finishFrame(std::int64_t arrivedNs, SampleHandler &onSample) {
+        std::size_t encodedLength = frameLength;
+        bool oversized = discarding;
+        frameLength = 0;
+        discarding = false;
+
+        if (oversized) {
+            framingErrors++;
+            return;
+        }
+        if (encodedLength == 0) return;  // Back-to-back delimiters
+
+        std::size_t decodedLength = horusCobsDecode(frame, encodedLength);
+        if (decodedLength <= HORUS_CRC_SIZE) {
+            framingErrors++;
+            return;
+        }
+
+        std::size_t payloadLength = decodedLength - HORUS_CRC_SIZE;
+        if (horusCrc16(frame, payloadLength) != horusGetU16(frame + payloadLength)) {
+            crcErrors++;
+            return;
+        }
+
+        HorusTelemetry telemetry;
+        if (!horusDecodeTelemetry(frame, payloadLength, telemetry)) {
+            framingErrors++;
+            return;
+        }
+
+        // A step back, in the sequence or the sender's clock, is a reboot or a
+        // frame out of order, not 65,000 lost ones: start counting afresh
+        if (haveSequence) {
+            std::uint16_t missed = static_cast<std::uint16_t>(telemetry.sequence - lastSequence - 1);
+            if (missed < maxSequenceGap && telemetry.sensorTimeMs >= lastSensorTimeMs) sequenceGaps += missed;
+            else sequenceResyncs++;
+        }
+        lastSequence = telemetry.sequence;
+        lastSensorTimeMs = telemetry.sensorTimeMs;
+        haveSequence = true;
+        frames++;
+
+        onSample(toSample(telemetry, arrivedNs));
+    }
+
+    static TelemetrySample toSample(const HorusTelemetry &t, std::int64_t arrivedNs) {
+        TelemetrySample sample;
+        sample.timestampNs = arrivedNs;
+        sample.sensorTimeMs = t.sensorTimeMs;
+        sample.fields = t.flags;
+        sample.pitch = t.pitch;
+        sample.roll = t.roll;
+        sample.yaw = t.yaw;
+        for (int i = 0; i < 3; i++) {
+            sample.accel[i] = t.accel[i];
+            sample.gyro[i] = t.gyro[i];
+        }
+        sample.altitude = t.altitude;
+        sample.airspeed = t.airspeed;
+        sample.heading = t.heading;
+        sample.batteryVolts = t.batteryVolts;
+        sample.batteryLevel = t.batteryPercent / 100.0f;
+        for (int i = 0; i < 4; i++) {
+            sample.rpm[i] = t.rpm[i];
+        }
+        return sample;
+    }
+
+    std::uint8_t frame[HORUS_MAX_FRAME_SIZE];
+    std::size_t frameLength = 0;
+    bool discarding = false;
+
+    std::uint16_t lastSequence = 0;
+    std::uint32_t lastSensorTimeMs = 0;
+    bool haveSequence = false;
+
+    std::uint64_t frames = 0;
+    std::uint64_t crcErrors = 0;
+    std::uint64_t framingErrors = 0;
+    std::uint64_t sequenceGaps = 0;
+    std::uint64_t sequenceResyncs = 0;
+};
+
+#endif // FRAMEDECODER_H
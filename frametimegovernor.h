@@ -0,0 +1,117 @@
+#ifndef FRAMETIMEGOVERNOR_H
+#define FRAMETIMEGOVERNOR_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include "latencystats.h"
+
+// Trades render detail for frame time. The PFD reports how long each
+// paintEvent() took; every windowFrames frames the 90th percentile of the
+// window is compared with the budget, a share of the display period. Over
+// budget steps one quality level down. Well under it for recoverWindows
+// windows in a row steps one level back up, so the level does not flap at
+// the edge of the budget.
+//
+// The levels take detail away from the secondary instruments first and
+// never skip the horizon, which is painted every frame at every level.
+// GUI thread only.
+class FrameTimeGovernor {
+public:
+    // Each level keeps the savings of the ones above it
+    enum Quality {
+        Full,          // Everything antialiased
+        PlainTicks,    // Tape ticks without antialiasing
+        SparseLadder,  // Pitch ladder every 10 degrees, unfiltered
+        Essential,     // Gauges, clock and QNH repaint once a second
+        QualityCount
+    };
+
+    static constexpr int windowFrames = 30;
+    static constexpr double budgetShare = 0.75;   // Of the display period; the rest is compositing
+    static constexpr double recoverShare = 0.5;   // Of the budget, to step back up
+    static constexpr int recoverWindows = 4;
+
+    static const char *qualityName(int quality) {
+        static const char *const names[QualityCount] = {
+            "FULL", "PLAIN TICKS", "SPARSE LADDER", "ESSENTIAL"
+        };
+        return names[quality];
+    }
+
+    // Painted frames per second the display aims for
+    void setTargetFrameRate(double hz) {
+        budget = static_cast<std::int64_t>(budgetShare * 1e9 / std::max(hz, 1.0));
+    }
+
+    // Off holds the current level, e.g. for bench/render_bench.cpp
+    void setAdaptive(bool enabled) {
+        adaptive = enabled;
+        goodWindows = 0;
+    }
+
+    void setQuality(Quality quality) {
+        level = quality;
+        windowCount = 0;
+        goodWindows = 0;
+    }
+
+    // One painted frame; true when the quality level changed
+    bool recordFrame(std::int64_t paintNs) {
+        paintHistogram.add(paintNs);
+        if (paintNs > budget) overBudget++;
+        window[windowCount++] = paintNs;
+        if (windowCount < windowFrames) return false;
+
+        windowCount = 0;
+        windows++;
+        std::array<std::int64_t, windowFrames> sorted = window;
+        const int rank = windowFrames * 9 / 10;
+        std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+        windowP90 = sorted[rank];
+        if (!adaptive) return false;
+
+        if (windowP90 > budget) {
+            goodWindows = 0;
+            if (level + 1 == QualityCount) return false;
+            level = static_cast<Quality>(level + 1);
+            stepsDown++;
+            return true;
+        }
+        if (windowP90 > recoverShare * budget) {
+            goodWindows = 0;
+            return false;
+        }
+        if (++goodWindows < recoverWindows || level == Full) return false;
+        goodWindows = 0;
+        level = static_cast<Quality>(level - 1);
+        stepsUp++;
+        return true;
+    }
+
+    Quality quality() const { return level; }
+    bool isAdaptive() const { return adaptive; }
+    std::int64_t budgetNs() const { return budget; }
+    std::int64_t windowP90Ns() const { return windowP90; }  // Of the last full window
+    const LatencyHistogram &paintTimes() const { return paintHistogram; }
+    std::uint64_t windowsCompleted() const { return windows; }
+    std::uint64_t overBudgetCount() const { return overBudget; }
+    std::uint64_t stepDownCount() const { return stepsDown; }
+    std::uint64_t stepUpCount() const { return stepsUp; }
+
+private:
+    Quality level = Full;
+    bool adaptive = true;
+    std::int64_t budget = static_cast<std::int64_t>(budgetShare * 1e9 / 60);
+    std::array<std::int64_t, windowFrames> window{};
+    int windowCount = 0;
+    int goodWindows = 0;
+    std::int64_t windowP90 = 0;
+    LatencyHistogram paintHistogram;
+    std::uint64_t windows = 0;
+    std::uint64_t overBudget = 0;
+    std::uint64_t stepsDown = 0;
+    std::uint64_t stepsUp = 0;
+};
+
+#endif // FRAMETIMEGOVERNOR_H
@@ -0,0 +1,136 @@
+#ifndef GLYPHATLAS_H
+#define GLYPHATLAS_H
+
+#include <QPainter>
+#include <QImage>
+#include <QFont>
+#include <QFontMetricsF>
+#include <QColor>
+#include <QtMath>
+#include <cmath>
+
+// Printable ASCII pre-rendered once for one font and colour at device
+// resolution. Readouts that change every frame are blitted glyph by glyph
+// from the atlas, so no text layout or shaping runs per frame. The atlas is
+// a QImage, so instrument tiles on worker threads can draw from it too.
+// Glyphs are placed by their plain advances, which is exact for the
+// monospaced instrument fonts.
+class GlyphAtlas {
+public:
+    static constexpr char firstChar = ' ';
+    static constexpr char lastChar = '~';
+    static constexpr int glyphCount = lastChar - firstChar + 1;
+    static constexpr int maxTextLength = 64;
+
+    // scale: device pixels per logical unit of the painter the atlas is drawn with.
+    // metricsDevice: the widget, so font sizes resolve exactly as drawText() would.
+    void build(const QFont &font, const QColor &color, qreal scale, QPaintDevice *metricsDevice) {
+        QFontMetricsF metrics(font, metricsDevice);
+        ascent = metrics.ascent();
+        pad = 1.0;  // Logical units around each glyph for antialiasing and overhang
+
+        qreal maxAdvance = 0;
+        for (int i = 0; i < glyphCount; i++) {
+            advances[i] = metrics.horizontalAdvance(QChar(firstChar + i));
+            maxAdvance = qMax(maxAdvance, advances[i]);
+        }
+
+        deviceScale = scale;
+        cellWidth = qCeil((maxAdvance + 2 * pad) * scale);
+        cellHeight = qCeil((metrics.height() + 2 * pad) * scale);
+
+        image = QImage(cellWidth * glyphCount, cellHeight, QImage::Format_ARGB32_Premultiplied);
+        image.fill(Qt::transparent);
+
+        QPainter painter(&image);
+        painter.setRenderHint(QPainter::Antialiasing);
+        painter.setRenderHint(QPainter::TextAntialiasing);
+        painter.scale(scale, scale);
+        painter.setFont(font);
+        painter.setPen(color);
+        for (int i = 0; i < glyphCount; i++) {
+            qreal cellLeft = i * cellWidth / scale;
+            painter.drawText(QPointF(cellLeft + pad, pad + ascent), QString(QChar(firstChar + i)));
+        }
+    }
+
+    bool isNull() const { return image.isNull(); }
+
+    // Same anchor as QPainter::drawText(x, baseline, text)
+    void draw(QPainter &painter, qreal x, qreal baseline, const char *text, int length) const {
+        if (image.isNull()) return;
+
+        const qreal inverse = 1.0 / deviceScale;
+        const qreal cellLogicalWidth = cellWidth * inverse;
+        const qreal cellLogicalHeight = cellHeight * inverse;
+        const qreal top = baseline - ascent - pad;
+
+        qreal penX = x;
+        for (int i = 0; i < length && i < maxTextLength; i++) {
+            int index = static_cast<unsigned char>(text[i]) - firstChar;
+            if (index < 0 || index >= glyphCount) index = '?' - firstChar;
+
+            if (text[i] != ' ') {
+                painter.drawImage(QRectF(penX - pad, top, cellLogicalWidth, cellLogicalHeight), image,
+                                  QRectF(index * cellWidth, 0, cellWidth, cellHeight));
+            }
+            penX += advances[index];
+        }
+    }
+
+private:
+    QImage image;
+    qreal advances[glyphCount] = {};  // Logical units
+    qreal ascent = 0;                 // Logical units
+    qreal pad = 0;                    // Logical units
+    qreal deviceScale = 1;
+    int cellWidth = 0;                // Device pixels
+    int cellHeight = 0;
+};
+
+// Allocation-free number formatting for atlas readouts.
+// Each append writes at out and returns the number of characters written.
+namespace textformat {
+
+inline int appendText(char *out, const char *text) {
+    int n = 0;
+    while (text[n]) { out[n] = text[n]; n++; }
+    return n;
+}
+
+inline int appendInt(char *out, long long value, int minDigits = 1) {
+    char digits[24];
+    int n = 0;
+    bool negative = value < 0;
+    unsigned long long v = negative ? 0ull - static_cast<unsigned long long>(value) : static_cast<unsigned long long>(value);
+    do {
+        digits[n++] = static_cast<char>('0' + v % 10);
+        v /= 10;
+    } while (v != 0);
+    while (n < minDigits) digits[n++] = '0';
+
+    int written = 0;
+    if (negative) out[written++] = '-';
+    while (n > 0) out[written++] = digits[--n];
+    return written;
+}
+
+// Fixed-point like QString::number(value, 'f', decimals)
+inline int appendFixed(char *out, double value, int decimals) {
+    long long scale = 1;
+    for (int i = 0; i < decimals; i++) scale *= 10;
+    long long scaled = std::llround(std::fabs(value) * scale);
+
+    int written = 0;
+    if (value < 0 && scaled != 0) out[written++] = '-';
+    written += appendInt(out + written, scaled / scale);
+    if (decimals > 0) {
+        out[written++] = '.';
+        written += appendInt(out + written, scaled % scale, decimals);
+    }
+    return written;
+}
+
+} // namespace textformat
+
+#endif // GLYPHATLAS_H
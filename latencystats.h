@@ -0,0 +1,209 @@
+#ifndef LATENCYSTATS_H
+#define LATENCYSTATS_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include "telemetrysample.h"
+
+// Latencies in fixed 100 us buckets up to 500 ms, plus one overflow bucket.
+// Recording is O(1) without allocation; percentiles have bucket resolution,
+// the maximum is exact.
+class LatencyHistogram {
+public:
+    static constexpr std::int64_t bucketNs = 100'000;
+    static constexpr int bucketCount = 5000;
+
+    void add(std::int64_t ns) {
+        if (ns < 0) ns = 0;  // Clock alignment can undershoot by a bucket or two
+        const std::int64_t index = ns / bucketNs;
+        buckets[index < bucketCount ? index : bucketCount]++;
+        samples++;
+        maxNs = std::max(maxNs, ns);
+    }
+
+    // Upper edge of the bucket holding quantile q (0..1), capped at the maximum
+    std::int64_t percentileNs(double q) const {
+        if (samples == 0) return 0;
+        std::uint64_t rank = static_cast<std::uint64_t>(std::ceil(q * samples));
+        rank = std::max<std::uint64_t>(rank, 1);
+
+        std::uint64_t seen = 0;
+        for (int i = 0; i < bucketCount; i++) {
+            seen += buckets[i];
+            if (seen >= rank) return std::min((i + 1) * bucketNs, maxNs);
+        }
+        return maxNs;
+    }
+
+    std::int64_t maxValueNs() const { return maxNs; }
+    std::uint64_t count() const { return samples; }
+
+    void reset() {
+        buckets.fill(0);
+        samples = 0;
+        maxNs = 0;
+    }
+
+private:
+    std::array<std::uint32_t, bucketCount + 1> buckets{};
+    std::uint64_t samples = 0;
+    std::int64_t maxNs = 0;
+};
+
+// Maps the sender's millis() onto the host steady clock.
+// The offset is the smallest (arrival - sensor time) seen, i.e. the sample
+// that crossed the link fastest, so latencies against it are lower bounds
+// that leave out the fixed wire time. The estimate is kept over two rolling
+// windows so drift between the two crystals cannot accumulate, and starts over
+// when the sender's clock jumps (reboot, 49 day wrap).
+class SensorClock {
+public:
+    static constexpr int windowSamples = 500;  // About 10 s at 50 Hz
+
+    void observe(std::uint32_t sensorMs, std::int64_t arrivedNs) {
+        if (!synced) {
+            restart(sensorMs);
+        } else {
+            const std::int32_t stepMs = static_cast<std::int32_t>(sensorMs - lastSensorMs);
+            if (stepMs < 0 || stepMs > 10'000) {
+                restart(sensorMs);
+            } else {
+                extendedMs += stepMs;
+                lastSensorMs = sensorMs;
+            }
+        }
+
+        const std::int64_t offset = arrivedNs - extendedMs * 1'000'000;
+        currentMin = std::min(currentMin, offset);
+        if (++windowCount == windowSamples) {
+            previousMin = currentMin;
+            currentMin = std::numeric_limits<std::int64_t>::max();
+            windowCount = 0;
+        }
+    }
+
+    // Host steady clock time of a recently observed sensor timestamp
+    bool toHostNs(std::uint32_t sensorMs, std::int64_t &hostNs) const {
+        if (!synced) return false;
+        const std::int64_t ms = extendedMs + static_cast<std::int32_t>(sensorMs - lastSensorMs);
+        hostNs = ms * 1'000'000 + std::min(currentMin, previousMin);
+        return true;
+    }
+
+private:
+    void restart(std::uint32_t sensorMs) {
+        synced = true;
+        lastSensorMs = sensorMs;
+        extendedMs = sensorMs;
+        currentMin = std::numeric_limits<std::int64_t>::max();
+        previousMin = std::numeric_limits<std::int64_t>::max();
+        windowCount = 0;
+    }
+
+    bool synced = false;
+    std::uint32_t lastSensorMs = 0;
+    std::int64_t extendedMs = 0;
+    std::int64_t currentMin = std::numeric_limits<std::int64_t>::max();
+    std::int64_t previousMin = std::numeric_limits<std::int64_t>::max();
+    int windowCount = 0;
+};
+
+// Per-stage latency of the display pipeline, owned by the GUI thread.
+// Stages, all on the host steady clock:
+//   parse         bytes read in readSerialData() -> sample parsed
+//   queue         parsed -> taken off the ring by the display
+//   render        taken off the ring -> paintEvent() finished the first frame showing it
+//   rx->paint     bytes read -> that frame finished
+//   sensor->paint sender's millis() -> that frame finished (binary frames only)
+class LatencyStats {
+public:
+    enum Stage { Parse, Queue, Render, ArrivalToPaint, SensorToPaint, StageCount };
+
+    static const char *stageName(int stage) {
+        static const char *const names[StageCount] = {
+            "parse", "queue", "render", "rx->paint", "sensor->paint"
+        };
+        return names[stage];
+    }
+
+    // Every sample the display takes off the ring, dropped or not
+    void recordHandoff(const TelemetrySample &sample) {
+        if (sample.timestampNs == 0) return;
+        if (sample.parsedNs != 0) {
+            histograms[Parse].add(sample.parsedNs - sample.timestampNs);
+            histograms[Queue].add(sample.handoffNs - sample.parsedNs);
+        }
+        if (sample.sensorTimeMs != 0) {
+            sensorClock.observe(sample.sensorTimeMs, sample.timestampNs);
+        }
+    }
+
+    // Once per sample, when the first frame that shows it has been painted
+    void recordPresented(std::int64_t arrivedNs, std::int64_t handoffNs,
+                         std::uint32_t sensorTimeMs, std::int64_t paintedNs) {
+        if (arrivedNs == 0) return;
+        histograms[Render].add(paintedNs - handoffNs);
+        histograms[ArrivalToPaint].add(paintedNs - arrivedNs);
+
+        std::int64_t sensorNs;
+        if (sensorTimeMs != 0 && sensorClock.toHostNs(sensorTimeMs, sensorNs)) {
+            histograms[SensorToPaint].add(paintedNs - sensorNs);
+        }
+        presented++;
+    }
+
+    // Once per drain of the ring: taken samples, of which only the newest
+    // is drawn, and the ring's running count of samples evicted while full
+    void recordDrain(std::size_t taken, std::uint64_t ringDropped) {
+        if (taken > 1) coalesced += taken - 1;
+        dropped = ringDropped - droppedAtReset;
+        ringDroppedTotal = ringDropped;
+    }
+
+    const LatencyHistogram &histogram(int stage) const { return histograms[stage]; }
+    std::uint64_t presentedCount() const { return presented; }
+    std::uint64_t droppedCount() const { return dropped; }      // Evicted from the full ring
+    std::uint64_t coalescedCount() const { return coalesced; }  // Taken off it, never drawn
+
+    void reset() {
+        for (LatencyHistogram &histogram : histograms) histogram.reset();
+        presented = 0;
+        coalesced = 0;
+        dropped = 0;
+        droppedAtReset = ringDroppedTotal;
+    }
+
+    void writeReport(std::FILE *out) const {
+        std::fprintf(out, "%-14s %10s %9s %9s %9s\n", "stage", "samples", "p50 ms", "p99 ms", "max ms");
+        for (int stage = 0; stage < StageCount; stage++) {
+            const LatencyHistogram &h = histograms[stage];
+            std::fprintf(out, "%-14s %10llu %9.2f %9.2f %9.2f\n", stageName(stage),
+                         static_cast<unsigned long long>(h.count()),
+                         h.percentileNs(0.50) / 1e6, h.percentileNs(0.99) / 1e6, h.maxValueNs() / 1e6);
+        }
+        std::fprintf(out, "samples dropped %llu, coalesced %llu\n", static_cast<unsigned long long>(dropped),
+                     static_cast<unsigned long long>(coalesced));
+    }
+
+    bool dumpToFile(const char *path) const {
+        std::FILE *out = std::fopen(path, "w");
+        if (!out) return false;
+        writeReport(out);
+        return std::fclose(out) == 0;
+    }
+
+private:
+    std::array<LatencyHistogram, StageCount> histograms;
+    SensorClock sensorClock;
+    std::uint64_t presented = 0;
+    std::uint64_t coalesced = 0;
+    std::uint64_t dropped = 0;
+    std::uint64_t droppedAtReset = 0;
+    std::uint64_t ringDroppedTotal = 0;
+};
+
+#endif // LATENCYSTATS_H
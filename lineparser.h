@@ -0,0 +1,244 @@
+#ifndef LINEPARSER_H
+#define LINEPARSER_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__has_include)
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HORUS_SCAN_SSE2 1
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+#include <arm_neon.h>
+#define HORUS_SCAN_NEON 1
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace lineparser {
+
+inline int countTrailingZeros(std::uint64_t bits) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, bits);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(bits);
+#endif
+}
+
+// First '\n' in [p, end), or end. 16 bytes per step where the CPU allows it.
+inline const char *findNewline(const char *p, const char *end) {
+#if defined(HORUS_SCAN_SSE2)
+    const __m128i newline = _mm_set1_epi8('\n');
+    while (end - p >= 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline)));
+        if (mask) return p + countTrailingZeros(mask);
+        p += 16;
+    }
+#elif defined(HORUS_SCAN_NEON)
+    const uint8x16_t newline = vdupq_n_u8('\n');
+    while (end - p >= 16) {
+        uint8x16_t eq = vceqq_u8(vld1q_u8(reinterpret_cast<const uint8_t *>(p)), newline);
+        // Narrow each byte to a nibble so the match mask fits in 64 bits
+        uint8x8_t nibbles = vshrn_n_u16(vreinterpretq_u16_u8(eq), 4);
+        std::uint64_t bits = vget_lane_u64(vreinterpret_u64_u8(nibbles), 0);
+        if (bits) return p + (countTrailingZeros(bits) >> 2);
+        p += 16;
+    }
+#endif
+    const void *hit = std::memchr(p, '\n', static_cast<std::size_t>(end - p));
+    return hit ? static_cast<const char *>(hit) : end;
+}
+
+inline bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// Parses exactly [begin, end) as a decimal float. Locale independent.
+inline bool parseFloat(const char *begin, const char *end, float &out) {
+    if (begin != end && *begin == '+') ++begin;  // from_chars rejects a leading '+'
+    if (begin == end) return false;
+
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    // from_chars also takes "nan" and "inf"; no sensor sends those, and the
+    // display can't draw them
+    float value;
+    std::from_chars_result result = std::from_chars(begin, end, value);
+    if (result.ec != std::errc() || result.ptr != end || !std::isfinite(value)) return false;
+    out = value;
+    return true;
+#else
+    // Fallback for standard libraries without floating-point from_chars.
+    // strtof is not an option: QCoreApplication sets LC_NUMERIC from the user locale.
+    const char *p = begin;
+    bool negative = false;
+    if (*p == '-') { negative = true; ++p; }
+
+    double value = 0.0;
+    int digits = 0;
+    while (p != end && *p >= '0' && *p <= '9') { value = value * 10.0 + (*p++ - '0'); digits++; }
+    if (p != end && *p == '.') {
+        ++p;
+        double scale = 0.1;
+        while (p != end && *p >= '0' && *p <= '9') { value += (*p++ - '0') * scale; scale *= 0.1; digits++; }
+    }
+    if (digits == 0) return false;
+
+    if (p != end && (*p == 'e' || *p == 'E')) {
+        ++p;
+        bool negativeExp = false;
+        if (p != end && (*p == '-' || *p == '+')) negativeExp = (*p++ == '-');
+        if (p == end) return false;
+        int exponent = 0;
+        while (p != end && *p >= '0' && *p <= '9' && exponent < 400) exponent = exponent * 10 + (*p++ - '0');
+        double factor = 1.0;
+        for (int i = 0; i < exponent; i++) factor *= 10.0;
+        value = negativeExp ? value / factor : value * factor;
+    }
+    if (p != end) return false;
+
+    // Huge exponents overflow float
+    const float result = static_cast<float>(negative ? -value : value);
+    if (!std::isfinite(result)) return false;
+    out = result;
+    return true;
+#endif
+}
+
+// Splits one line on ',' and parses up to maxFields floats into out.
+// Returns the number of fields, or -1 if any field is malformed or there are too many.
+inline int parseFields(const char *begin, const char *end, float *out, int maxFields) {
+    int count = 0;
+    const char *field = begin;
+    for (;;) {
+        const void *comma = std::memchr(field, ',', static_cast<std::size_t>(end - field));
+        const char *fieldEnd = comma ? static_cast<const char *>(comma) : end;
+
+        const char *b = field;
+        const char *e = fieldEnd;
+        while (b != e && isSpace(*b)) ++b;
+        while (e != b && isSpace(e[-1])) --e;
+
+        if (count == maxFields || !parseFloat(b, e, out[count])) return -1;
+        count++;
+
+        if (!comma) return count;
+        field = fieldEnd + 1;
+    }
+}
+
+} // namespace lineparser
+
+// Fixed-size circular byte buffer for a line-oriented stream.
+// The serial port reads straight into it and complete lines are handed out
+// in place, so the steady state does no allocation and no memmove.
+class LineBuffer {
+public:
+    static constexpr std::size_t Capacity = 4096;     // Must be a power of two
+    static constexpr std::size_t maxLineLength = 256; // Longer lines are discarded
+
+    // Contiguous free space for the next read; may be shorter than the total free space
+    char *writeSpan(std::size_t &available) {
+        std::size_t used = writePos - readPos;
+        std::size_t offset = writePos & Mask;
+        std::size_t free = Capacity - used;
+        std::size_t untilWrap = Capacity - offset;
+        available = free < untilWrap ? free : untilWrap;
+        return data + offset;
+    }
+
+    void commitWrite(std::size_t bytes) {
+        writePos += bytes;
+    }
+
+    // Calls onLine(const char *begin, const char *end) for every complete line,
+    // without the '\n'. Returns the number of lines delivered.
+    template <typename LineHandler>
+    std::size_t consumeLines(LineHandler &&onLine) {
+        std::size_t lines = 0;
+        while (scanPos != writePos) {
+            std::size_t offset = scanPos & Mask;
+            std::size_t pending = writePos - scanPos;
+            std::size_t untilWrap = Capacity - offset;
+            std::size_t span = pending < untilWrap ? pending : untilWrap;
+
+            const char *begin = data + offset;
+            const char *hit = lineparser::findNewline(begin, begin + span);
+            if (hit == begin + span) {
+                scanPos += span;
+                continue;
+            }
+
+            std::size_t lineEnd = scanPos + static_cast<std::size_t>(hit - begin);
+            if (discarding) {
+                discarding = false;  // The tail of a line already dropped
+            } else {
+                deliverLine(readPos, lineEnd, onLine);
+                lines++;
+            }
+            readPos = scanPos = lineEnd + 1;
+        }
+
+        // No newline in sight: drop the partial line instead of growing, and
+        // the rest of it as it arrives, up to its newline
+        if (discarding || writePos - readPos > maxLineLength) {
+            if (!discarding) overflowed++;
+            discarding = true;
+            readPos = scanPos = writePos;
+        }
+        return lines;
+    }
+
+    void clear() {
+        readPos = scanPos = writePos;
+        discarding = false;
+    }
+
+    // Lines dropped because they exceeded maxLineLength
+    std::uint64_t overflowCount() const { return overflowed; }
+
+private:
+    static constexpr std::size_t Mask = Capacity - 1;
+
+    template <typename LineHandler>
+    void deliverLine(std::size_t from, std::size_t to, LineHandler &onLine) {
+        std::size_t length = to - from;
+        if (length > maxLineLength) {
+            overflowed++;
+            return;
+        }
+
+        std::size_t offset = from & Mask;
+        if (offset + length <= Capacity) {
+            onLine(static_cast<const char *>(data + offset), static_cast<const char *>(data + offset + length));
+            return;
+        }
+
+        // The line wraps the end of the ring: stitch it into the scratch line
+        std::size_t head = Capacity - offset;
+        std::memcpy(scratch, data + offset, head);
+        std::memcpy(scratch + head, data, length - head);
+        onLine(static_cast<const char *>(scratch), static_cast<const char *>(scratch + length));
+    }
+
+    char data[Capacity];
+    char scratch[maxLineLength];
+    std::size_t readPos = 0;   // Start of the oldest unconsumed line
+    std::size_t scanPos = 0;   // Newline search resumes here
+    std::size_t writePos = 0;  // Positions are monotonic; masked on access
+    std::uint64_t overflowed = 0;
+    bool discarding = false;   // Between an overflow and the next newline
+};
+
+#endif // LINEPARSER_H
@@ -1,25 +1,74 @@
 #include <QApplication>
 #include <QMainWindow>
-#include <QTimer>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QLabel>
 #include <QWidget>
 #include <QFontDatabase>
 #include <QDebug>
-#include <QSerialPort>
-#include <QSerialPortInfo>
+#include <QThread>
+#include <QFontMetrics>
+#include <QShortcut>
+#include <QKeySequence>
+#include <QDateTime>
+#include <QCommandLineParser>
+#include <QDir>
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstring>
 #include <ctime>
-#include <iomanip>
-#include <sstream>
 #include <cmath>
+#include <memory>
+#include <optional>
+#include <limits>
+#include <vector>
+#include "airdata.h"
 #include "attitudeindicator.h"
+#include "attitudeinterpolator.h"
+#include "displayclock.h"
+#include "fleetwindow.h"
+#include "flightrecorder.h"
+#include "flightsimulator.h"
+#include "replaysource.h"
+#include "sensorfusion.h"
+#include "serialreader.h"
+#include "startuptrace.h"
+#include "telemetryclient.h"
+#include "telemetryserver.h"
+
+// Command line switches, parsed in main()
+struct LaunchOptions {
+    QString recordDirectory;  // Empty: no flight recorder
+    bool recordRawBytes = false;
+    QString replayDirectory;  // Non-empty: play this log instead of the port
+    double replaySpeed = 1.0;
+    QStringList fleetPorts;   // One: the port to use; two or more: multi-vehicle grid
+    FusionAlgorithm fusion = FusionAlgorithm::Madgwick;  // For samples with raw IMU
+    std::int64_t renderDelayNs = AttitudeInterpolator::autoRenderDelay;  // See attitudeinterpolator.h
+    std::int64_t maxExtrapolationNs = AttitudeInterpolator::defaultMaxExtrapolationNs;
+    std::vector<TelemetryEndpoint> serveEndpoints;  // Republish the port's samples here
+    std::optional<TelemetryEndpoint> connectEndpoint;  // Viewer only: follow a server, no port
+    bool simulate = false;    // Fly the simulator instead of opening the port
+    double simulationRate = FlightModel::minRate;
+    std::uint32_t simulationSeed = 1;
+    bool simulatePty = false; // Simulator frames go through a pty and the serial reader
+    qint32 baudRate = QSerialPort::Baud115200;
+    QList<UsbSerialId> usbIds = portdiscovery::knownBridges();  // Port discovery, see portdiscovery.h
+    bool exitAfterFirstFrame = false;  // Startup benchmark, see bench/startup_bench.cpp
+};
+
+// One session directory per run under --record, named by its start time
+static QString recordingSessionPath(const QString &recordDirectory) {
+    return QDir(recordDirectory).filePath(QDateTime::currentDateTime().toString("'horus-'yyyyMMdd-HHmmss"));
+}
 
 class PFDMainWindow : public QMainWindow {
     Q_OBJECT
 
 public:
-    PFDMainWindow(QWidget *parent = nullptr) : QMainWindow(parent) {
+    explicit PFDMainWindow(const LaunchOptions &launch = LaunchOptions(), QWidget *parent = nullptr)
+    : QMainWindow(parent), launchOptions(launch), fusion(launch.fusion) {
         setWindowTitle("Horus Project - UAV Primary Flight Display");
         resize(1920, 1000);
         // Central widget
@@ -33,18 +82,18 @@ public:
         QHBoxLayout *topBar = new QHBoxLayout();
         altLabel = new QLabel("ALT: 0 m", this);
         speedLabel = new QLabel("SPD: 0 m/s", this);
+        airDataLabel = new QLabel("VS: 0 fpm", this);
         headingLabel = new QLabel("HDG: 0°", this);
 
         // Use custom font for labels
-        QFont labelFont(nimbusMono, 16);
-        altLabel->setFont(labelFont);
-        speedLabel->setFont(labelFont);
-        headingLabel->setFont(labelFont);
+        setLabelFont(nimbusMono);
 
         topBar->addWidget(altLabel);
         topBar->addStretch();
         topBar->addWidget(speedLabel);
         topBar->addStretch();
+        topBar->addWidget(airDataLabel);
+        topBar->addStretch();
         topBar->addWidget(headingLabel);
 
         mainLayout->addLayout(topBar);
@@ -57,6 +106,12 @@ public:
 
         simTime = 0.02;
 
+        fusion.addVehicle();
+        interpolator.setRenderDelayNs(launch.renderDelayNs);
+        interpolator.setMaxExtrapolationNs(launch.maxExtrapolationNs);
+        drained.resize(SampleRing::capacity());
+        fusionSlots.resize(SampleRing::capacity());
+
         // Initialize default values
         pitch = 0.0f;
         roll = 0.0f;
@@ -67,182 +122,504 @@ public:
 
         // Set fonts to AttitudeIndicator
         attitudeIndicator->setCustomFonts(PFDMainWindow::customFontFamily, nimbusMono);
-
-        // Try to connect to ESP32
-        setupSerialPort();
+        connect(attitudeIndicator, &AttitudeIndicator::firstFramePainted, this, &PFDMainWindow::firstFramePainted);
+
+        // Latency: F3 toggles the HUD table, F4 writes it to a file
+        attitudeIndicator->setLatencyStats(&latencyStats);
+        QShortcut *overlayShortcut = new QShortcut(QKeySequence(Qt::Key_F3), this);
+        connect(overlayShortcut, &QShortcut::activated, this, [this]() {
+            attitudeIndicator->setLatencyOverlayVisible(!attitudeIndicator->isLatencyOverlayVisible());
+        });
+        QShortcut *dumpShortcut = new QShortcut(QKeySequence(Qt::Key_F4), this);
+        connect(dumpShortcut, &QShortcut::activated, this, &PFDMainWindow::dumpLatency);
+
+        if (launchOptions.connectEndpoint) {
+            setupViewer();
+        } else if (!launchOptions.replayDirectory.isEmpty()) {
+            setupReplay();
+        } else if (launchOptions.simulate) {
+            startSimulation();
+        } else {
+            // Try to connect to ESP32
+            setupSerialPort();
+        }
     }
 
     // Static member to hold font family name
     static QString customFontFamily;
     static QString nimbusMono;
 
+    // The instrument fonts once loaded, see main()
+    void setCustomFonts(const QString &font1, const QString &font2) {
+        setLabelFont(font2);
+        attitudeIndicator->setCustomFonts(font1, font2);
+    }
+
+    // See AttitudeIndicator::warmUp()
+    void warmUp() { attitudeIndicator->warmUp(); }
+
+signals:
+    void firstFramePainted(qint64 paintedNs);
+
+public:
+    ~PFDMainWindow() override {
+        if (simulatorThread) {
+            simulatorThread->quit();
+            simulatorThread->wait();
+        }
+        if (readerThread) {
+            readerThread->quit();
+            readerThread->wait();
+        }
+        // After the reader: nothing pushes into the server or the recorder any more
+        if (serverThread) {
+            serverThread->quit();
+            serverThread->wait();
+        }
+        if (recorder) {
+            recorder->stop();
+            if (recorder->syncFailureCount() > 0) {
+                qWarning() << "Flight recorder:" << recorder->syncFailureCount() << "syncs failed, last:" << recorder->lastError();
+            }
+        }
+    }
+
 private slots:
     void setupSerialPort() {
-        serialPort = new QSerialPort(this);
+        // The reader lives on its own thread and owns the QSerialPort
+        readerThread = new QThread(this);
+        serialReader = new SerialReader(sampleRing);
+        if (!simulatorPort.isEmpty()) serialReader->setPortName(simulatorPort);
+        else if (launchOptions.fleetPorts.size() == 1) serialReader->setPortName(launchOptions.fleetPorts.first());
+        serialReader->setBaudRate(launchOptions.baudRate);
+        serialReader->setUsbIds(launchOptions.usbIds);
+        startRecorder();
+        startServer();
+        serialReader->moveToThread(readerThread);
+        connect(readerThread, &QThread::finished, serialReader, &QObject::deleteLater);
+        connect(serialReader, &SerialReader::linkChanged, this, &PFDMainWindow::onLinkChanged);
+        connect(serialReader, &SerialReader::dataResumed, this, &PFDMainWindow::onDataResumed);
+        linkWaitNs = monotonicNowNs();
+        readerThread->start();
+
+        QMetaObject::invokeMethod(serialReader, &SerialReader::openPort, Qt::QueuedConnection);
+    }
 
-        // Configure for your ESP32 port
-        serialPort->setPortName("/dev/cu.usbserial-0001");
-        serialPort->setBaudRate(QSerialPort::Baud115200);
-        serialPort->setDataBits(QSerialPort::Data8);
-        serialPort->setParity(QSerialPort::NoParity);
-        serialPort->setStopBits(QSerialPort::OneStop);
-        serialPort->setFlowControl(QSerialPort::NoFlowControl);
+    // Another instance's server stands in for the port: same ring, same display path
+    void setupViewer() {
+        readerThread = new QThread(this);
+        telemetryClient = new TelemetryClient(sampleRing);
+        telemetryClient->setEndpoint(*launchOptions.connectEndpoint);
+        telemetryClient->moveToThread(readerThread);
+        connect(readerThread, &QThread::finished, telemetryClient, &QObject::deleteLater);
+        connect(telemetryClient, &TelemetryClient::linkChanged, this, [this](bool up) {
+            qDebug() << (up ? "Following" : "Waiting for") << launchOptions.connectEndpoint->toString();
+        });
+        linkWaitNs = monotonicNowNs();
+        readerThread->start();
+
+        QMetaObject::invokeMethod(telemetryClient, &TelemetryClient::connectToServer, Qt::QueuedConnection);
+        startDisplayClock(&PFDMainWindow::updateDisplay);
+    }
 
-        if (serialPort->open(QIODevice::ReadOnly)) {
+    // A flight log stands in for the port: same ring, same display path
+    void setupReplay() {
+        readerThread = new QThread(this);
+        replaySource = new ReplaySource(sampleRing);
+        if (!replaySource->open(launchOptions.replayDirectory)) {
+            qWarning() << "Replay failed:" << replaySource->errorString();
+            delete replaySource;
+            replaySource = nullptr;
+            startSimulation();
+            return;
+        }
+        replaySource->setSpeed(launchOptions.replaySpeed);
+        replaySource->moveToThread(readerThread);
+        connect(readerThread, &QThread::finished, replaySource, &QObject::deleteLater);
+        connect(replaySource, &ReplaySource::finished, this, [this]() { qDebug() << "Replay finished"; });
+        readerThread->start();
+
+        // Space pauses, . steps one sample, arrows seek 10 s, [ and ] halve and double the speed
+        addReplayShortcut(Qt::Key_Space, [](ReplaySource *replay) { replay->togglePause(); });
+        addReplayShortcut(Qt::Key_Period, [](ReplaySource *replay) { replay->step(); });
+        addReplayShortcut(Qt::Key_Right, [](ReplaySource *replay) { replay->seekBy(10'000'000'000); });
+        addReplayShortcut(Qt::Key_Left, [](ReplaySource *replay) { replay->seekBy(-10'000'000'000); });
+        addReplayShortcut(Qt::Key_BracketRight, [](ReplaySource *replay) { replay->setSpeed(replay->speed() * 2); });
+        addReplayShortcut(Qt::Key_BracketLeft, [](ReplaySource *replay) { replay->setSpeed(replay->speed() / 2); });
+
+        QMetaObject::invokeMethod(replaySource, &ReplaySource::play, Qt::QueuedConnection);
+        startDisplayClock(&PFDMainWindow::updateDisplay);
+    }
 
-            // Connect signal for incoming data
-            connect(serialPort, &QSerialPort::readyRead, this, &PFDMainWindow::readSerialData);
+    // Runs action on the replay thread when key is pressed
+    template <typename Action>
+    void addReplayShortcut(int key, Action action) {
+        QShortcut *shortcut = new QShortcut(QKeySequence(key), this);
+        ReplaySource *replay = replaySource;
+        connect(shortcut, &QShortcut::activated, replay, [replay, action]() { action(replay); });
+    }
 
-            // Start update timer for other data
-            simTimer = new QTimer(this);
-            connect(simTimer, &QTimer::timeout, this, &PFDMainWindow::updateDisplay);
-            simTimer->start(20); // 50 Hz update rate
+    void startRecorder() {
+        if (launchOptions.recordDirectory.isEmpty()) return;
+        const QString session = recordingSessionPath(launchOptions.recordDirectory);
+        recorder.reset(new FlightRecorder(session));
+        FlightRecorder::Channel *channel = recorder->openChannel(0, launchOptions.recordRawBytes);
+        if (recorder->start()) {
+            serialReader->setRecorder(channel);
+            qDebug() << "Recording flight log to" << session;
         } else {
-            startSimulation();
+            qWarning() << "Flight recorder disabled:" << recorder->lastError();
+            recorder.reset();
         }
     }
 
-    void readSerialData() {
-    // Read all available data
-    QByteArray data = serialPort->readAll();
-
-    serialBuffer += data;
+    // Republishes every sample the reader decodes, from a thread of its own
+    void startServer() {
+        if (launchOptions.serveEndpoints.empty()) return;
+        serverThread = new QThread(this);
+        TelemetryServer *server = new TelemetryServer;
+        for (const TelemetryEndpoint &endpoint : launchOptions.serveEndpoints) server->addEndpoint(endpoint);
+        server->moveToThread(serverThread);
+        connect(serverThread, &QThread::finished, server, &QObject::deleteLater);
+        connect(server, &TelemetryServer::started, this, [](bool ok, const QString &error) {
+            if (ok) qDebug() << "Serving telemetry";
+            else qWarning() << "Telemetry server:" << error;
+        });
+        serialReader->setServer(server);
+        serverThread->start();
+
+        QMetaObject::invokeMethod(server, &TelemetryServer::start, Qt::QueuedConnection);
+    }
 
-    // Process complete lines
-    while (serialBuffer.contains('\n')) {
-        int newlineIndex = serialBuffer.indexOf('\n');
-        QString line = serialBuffer.left(newlineIndex).trimmed();
-        serialBuffer.remove(0, newlineIndex + 1);
+    // The reader keeps the link up by itself; this only follows it
+    void onLinkChanged(bool up, const QString &port) {
+        linkUp = up;
+        linkPort = port;
+        if (up) {
+            qDebug() << "Reading" << port << "at" << launchOptions.baudRate << "baud";
+            StartupTrace::instance().mark(StartupTrace::PortOpened);
+            if (flightSimulator && simulatorPort.isEmpty()) {
+                // The vehicle turned up: the stand-in goes
+                simulatorThread->quit();
+                simulatorThread->wait();
+                flightSimulator = nullptr;
+            }
+            if (!displayClock) startDisplayClock(&PFDMainWindow::updateDisplay);
+            return;
+        }
+        if (displayClock) {
+            // Lost mid-session. The display carries on and flags the data
+            // as stale while the reader reconnects.
+            return;
+        }
+        if (flightSimulator) {
+            // The simulator's own pty: carry on without the serial path
+            qWarning() << "Could not open the simulator's pty; simulating into the display directly";
+            readerThread->quit();
+            readerThread->wait();
+            serialReader = nullptr;
+            simulatorPort.clear();
+            QMetaObject::invokeMethod(flightSimulator, &FlightSimulator::closePty, Qt::QueuedConnection);
+            startDisplayClock(&PFDMainWindow::updateDisplay);
+            return;
+        }
+        // Nothing to read yet: simulate until the reader finds the vehicle
+        qWarning() << (port.isEmpty() ? QString("No ESP32 serial port found") : "Could not open " + port)
+                   << "- simulating until one appears";
+        startSimulation();
+    }
 
-        if (!line.isEmpty()) {
-            parseSerialLine(line);
+    void onDataResumed(qint64 timeToDataNs, qint64 outageNs) {
+        if (outageNs == 0) {
+            StartupTrace::instance().mark(StartupTrace::FirstSample);
+            qDebug() << "First data" << timeToDataNs / 1e6 << "ms after opening" << linkPort;
+            return;
         }
+        qDebug() << "Link back after" << outageNs / 1e6 << "ms," << timeToDataNs / 1e6 << "ms from reopening" << linkPort;
+        restoredText = "LINK RESTORED IN " + QString::number(outageNs / 1e9, 'f', 1).toStdString() + " S";
+        restoredUntilNs = monotonicNowNs() + restoredShownNs;
     }
-}
 
-    void parseSerialLine(const QString &line) {
+    // The serial link or a --connect server, as opposed to a log or the simulator
+    bool followsLink() const {
+        if (telemetryClient) return true;
+        return serialReader && !(flightSimulator && simulatorPort.isEmpty());
+    }
 
-    QStringList parts = line.split(',');
+    // Display ticks come from the window's refresh (see DisplayClock), not
+    // the 50 Hz sensor
+    void startDisplayClock(void (PFDMainWindow::*tick)()) {
+        displayClock = new DisplayClock(this, [this, tick]() { (this->*tick)(); });
+        lastTickNs = monotonicNowNs();
+        displayClock->start();
+        attitudeIndicator->setTargetFrameRate(displayClock->refreshHz());
+    }
 
-    if (parts.size() >= 2) {
-        bool ok1, ok2;
-        float newPitch = parts[0].toFloat(&ok1);  // REAL pitch from MPU6050
-        float newRoll = parts[1].toFloat(&ok2);   // REAL roll from MPU6050
+    // Advances the simulation by the real time since the last tick
+    std::int64_t advanceClock() {
+        const std::int64_t now = monotonicNowNs();
+        simTime += (now - lastTickNs) / 1e9;
+        lastTickNs = now;
+        return now;
+    }
 
-        if (ok1 && ok2) {
-            // Update with REAL sensor data
-            pitch = newPitch;
-            roll = newRoll;
+    // The simulator pushes into a ring of its own. A stand-in simulator
+    // overlaps the reader that replaces it: the reader publishes as soon as
+    // it opens the port, before linkChanged() reaches this thread to stop
+    // the simulator, and a ring takes one producer only.
+    SampleRing &activeRing() {
+        return flightSimulator && simulatorPort.isEmpty() ? simulatorRing : sampleRing;
+    }
 
-            // Debug output
-            qDebug() << "MPU6050 - Pitch:" << pitch << "Roll:" << roll;
+    void drainSamples() {
+        // Every sample goes through host fusion, which needs them all; the
+        // interpolator keeps the last two, older ones were never going to be drawn
+        std::size_t count = 0;
+        const std::int64_t handoffNs = monotonicNowNs();
+        SampleRing &ring = activeRing();
+        while (count < drained.size() && ring.pop(drained[count])) {
+            TelemetrySample &sample = drained[count];
+            sample.handoffNs = handoffNs;
+            latencyStats.recordHandoff(sample);
+            fusionSlots[count] = fusion.add(0, sample);
+            count++;
+        }
+        latencyStats.recordDrain(count, sampleRing.droppedCount() + simulatorRing.droppedCount());
+        if (count == 0) return;
+
+        fusion.fuse();
+        for (std::size_t i = count > 2 ? count - 2 : 0; i < count; i++) {
+            fusion.apply(0, fusionSlots[i], drained[i]);
+            interpolator.addSample(drained[i]);
+        }
+        for (std::size_t i = 0; i < count; i++) airData.add(drained[i]);
 
-            static int frameCount = 0;
-            frameCount++;
+        const TelemetrySample &sample = drained[count - 1];
+        latestSample = sample;
+        telemetry.sampleArrivedNs = sample.timestampNs;
+        telemetry.sampleHandoffNs = sample.handoffNs;
+        telemetry.sampleSensorTimeMs = sample.sensorTimeMs;
+    }
+
+    void dumpLatency() {
+        const QString path = QString("horus-latency-%1.txt").arg(QDateTime::currentSecsSinceEpoch());
+        if (latencyStats.dumpToFile(path.toLocal8Bit().constData())) {
+            qDebug() << "Latency report written to" << path;
         } else {
-            qWarning() << "Failed to parse pitch/roll:" << line;
+            qWarning() << "Could not write latency report to" << path;
         }
-    } else {
-        qWarning() << "Invalid data format:" << line;
     }
-}
 
 void updateDisplay() {
-    // This runs at 50Hz and updates the display with REAL pitch/roll from ESP32
-
-    // Simulate other parameters (altitude, speed, etc.)
-    simTime += 0.02;
-
-    speed = 70.0f + 30.0f * std::sin(simTime * 0.4);
-    heading = std::fmod(simTime * 10.0, 360.0);
-    float batteryState = 4.2f + 0.2f * std::sin(simTime * 5);
-    int propQuantity = 4;
-    float batteryLevel = 0.56f + 0.1f * std::sin(simTime * 0.02);
-    int rpm[4] = {
-        static_cast<int>(2500 + 500.0f * std::sin(simTime * 0.2)),
-        static_cast<int>(2500 + 400.0f * std::sin(simTime * 0.25)),
-        static_cast<int>(2500 + 450.0f * std::sin(simTime * 0.27)),
-        static_cast<int>(2500 + 480.0f * std::sin(simTime * 0.29))
-    };
-    float QNH = 29.92f + 0.1f * std::sin(simTime * 0.3);
-    altitude = 8500.00f + 100.0f * std::sin(simTime * 0.2);
-    float OAT = 15.0f; // Fixed outside air temperature
-    std::string flightMode = "MANUAL - MPU6050 Active";
+    // This runs at the display rate and updates the display with REAL pitch/roll from ESP32
+    const std::int64_t now = advanceClock();
+    drainSamples();
+
+    // A live link gone quiet: the values hold and the PFD says so
+    const std::int64_t lastDataNs = latestSample.timestampNs ? latestSample.timestampNs : linkWaitNs;
+    telemetry.staleMs = followsLink() ? staleAgeMs(lastDataNs, now) : 0;
+
+    // REAL pitch and roll from MPU6050, placed at this frame's time
+    if (interpolator.hasSample()) {
+        const AttitudeInterpolator::Attitude attitude = interpolator.at(now);
+        pitch = attitude.pitch;
+        roll = attitude.roll;
+    }
+
+    // Simulate other parameters (altitude, speed, etc.), unless stale
+    if (telemetry.staleMs == 0) {
+        speed = 70.0f + 30.0f * std::sin(simTime * 0.4);
+        heading = std::fmod(simTime * 10.0, 360.0);
+        telemetry.batteryVolts = 4.2f + 0.2f * std::sin(simTime * 5);
+        telemetry.propQuantity = 4;
+        telemetry.batteryLevel = 0.56f + 0.1f * std::sin(simTime * 0.02);
+        telemetry.rpm[0] = static_cast<int>(2500 + 500.0f * std::sin(simTime * 0.2));
+        telemetry.rpm[1] = static_cast<int>(2500 + 400.0f * std::sin(simTime * 0.25));
+        telemetry.rpm[2] = static_cast<int>(2500 + 450.0f * std::sin(simTime * 0.27));
+        telemetry.rpm[3] = static_cast<int>(2500 + 480.0f * std::sin(simTime * 0.29));
+        airData.setQnhInHg(29.92f + 0.1f * std::sin(simTime * 0.3));
+        altitude = 8500.00f + 100.0f * std::sin(simTime * 0.2);
+    }
+    airData.setOutsideAirTemperature(15.0f); // Fixed outside air temperature
+    if (flightSimulator) telemetry.flightMode = "SIMULATOR";
+    else if (serialReader && !linkUp) telemetry.flightMode = linkPort.isEmpty() ? "NO LINK - SEARCHING" : "NO LINK - RECONNECTING";
+    else if (now < restoredUntilNs) telemetry.flightMode = restoredText;
+    else telemetry.flightMode = "MANUAL - MPU6050 Active";
+
+    // Binary frames and MAVLink can carry real values for what we otherwise simulate
+    if (latestSample.has(HORUS_FIELD_ALTITUDE)) altitude = latestSample.altitude;
+    if (latestSample.has(HORUS_FIELD_SPEED)) speed = latestSample.airspeed;
+    if (latestSample.has(HORUS_FIELD_HEADING)) heading = latestSample.heading;
+    else if (latestSample.has(HORUS_FIELD_FUSED)) heading = latestSample.yaw;
+    if (latestSample.has(HORUS_FIELD_BATTERY)) {
+        telemetry.batteryVolts = latestSample.batteryVolts;
+        telemetry.batteryLevel = latestSample.batteryLevel;
+    }
+    if (latestSample.has(HORUS_FIELD_RPM)) {
+        for (int i = 0; i < 4; i++) telemetry.rpm[i] = latestSample.rpm[i];
+    }
 
-    std::time_t now = std::time(nullptr);
-    std::tm* localTime = std::localtime(&now);
-    std::stringstream ss;
-    ss << std::put_time(localTime, "%H:%M:%S");
-    std::string timeStr = ss.str();
+    // The simulated stand-ins go through the air data once per tick, the
+    // real values once per sample in drainSamples()
+    const bool realAltitude = latestSample.has(HORUS_FIELD_ALTITUDE);
+    const bool realHeading = latestSample.has(HORUS_FIELD_HEADING) || latestSample.has(HORUS_FIELD_FUSED);
+    if (telemetry.staleMs == 0 && !(realAltitude && realHeading)) {
+        const float none = std::numeric_limits<float>::quiet_NaN();
+        airData.add(now, realAltitude ? none : altitude, realHeading ? none : heading);
+    }
 
     // *** USE REAL PITCH AND ROLL FROM MPU6050 ***
-    attitudeIndicator->setAttitude(pitch, roll, altitude, speed, heading,
-                                  QNH, flightMode, timeStr, rpm,
-                                  batteryState, batteryLevel, propQuantity, OAT);
+    publishTelemetry();
 
     // Update top labels
-    altLabel->setText(QString("ALT: %1 ft").arg(altitude, 0, 'f', 1));
-    speedLabel->setText(QString("SPD: %1 kts").arg(speed, 0, 'f', 1));
-    headingLabel->setText(QString("Pitch:%1° Roll:%2°").arg(pitch, 0, 'f', 1).arg(roll, 0, 'f', 1));
+    updateTopBar();
 }
 
-    void startSimulation() {
-        // Fallback simulation mode if ESP32 not connected
-        simTimer = new QTimer(this);
-        connect(simTimer, &QTimer::timeout, this, &PFDMainWindow::updateSimulation);
-        simTimer->start(20);
-    }
+    // Hands the snapshot to the PFD, which repaints only if it looks different
+    void publishTelemetry() {
+        telemetry.pitch = pitch;
+        telemetry.roll = roll;
+        telemetry.altitude = altitude;
+        telemetry.speed = speed;
+        telemetry.heading = heading;
+        airData.fill(telemetry);
 
-    void updateSimulation() {
-        // Full simulation mode (when ESP32 not connected)
-        simTime += 0.02;
+        std::time_t now = std::time(nullptr);
+        std::strftime(telemetry.clock, sizeof(telemetry.clock), "%H:%M:%S", std::localtime(&now));
 
-        pitch = 90.0f * std::sin(simTime * 0.2);
-        roll = 180.0f * std::sin(simTime * 0.5);
-        speed = 70.0f + 230.0f * std::sin(simTime * 0.4);
-        heading = std::fmod(simTime * 10.0, 360.0);
+        attitudeIndicator->setTelemetry(telemetry);
+    }
 
-        float altitudeRate = 2000.0f;
-        float batteryState = 4.2f + 1.0f * std::sin(simTime * 5);
-        int propQuantity = 4;
-        float batteryLevel = 0.56f + 1.0f * std::sin(simTime * 0.02);
-        int rpm[4] = {
-            static_cast<int>(2500 + 1560.0f * std::sin(simTime * 0.2)),
-            static_cast<int>(2500 + 1210.0f * std::sin(simTime * 0.25)),
-            static_cast<int>(2500 + 1543.0f * std::sin(simTime * 0.27)),
-            static_cast<int>(2500 + 1673.0f * std::sin(simTime * 0.29))
-        };
-        float QNH = 29.92f + 1.0f * std::sin(simTime * 0.3);
-        altitude = 8500.00f + 1000.0f * std::sin(simTime * 0.2);
-        float OAT = 8.0f;
-        std::string flightMode = "ATLC Takeoff Active";
+    // The flight simulator stands in for the vehicle: into the ring, or with
+    // --sim-pty as binary frames through a pty and the serial reader
+    void startSimulation() {
+        simulatorThread = new QThread(this);
+        flightSimulator = new FlightSimulator(simulatorRing);
+        flightSimulator->setRate(launchOptions.simulationRate);
+        flightSimulator->setSeed(launchOptions.simulationSeed);
+#ifdef Q_OS_UNIX
+        if (launchOptions.simulatePty && !readerThread) {
+            simulatorPort = flightSimulator->openPty();
+            if (simulatorPort.isEmpty()) qWarning() << "Could not open a pty for the simulator";
+        }
+#endif
+        flightSimulator->moveToThread(simulatorThread);
+        connect(simulatorThread, &QThread::finished, flightSimulator, &QObject::deleteLater);
+        simulatorThread->start();
+        QMetaObject::invokeMethod(flightSimulator, &FlightSimulator::start, Qt::QueuedConnection);
+        qDebug() << "Simulating at" << flightSimulator->rate() << "Hz, seed" << launchOptions.simulationSeed;
+
+        if (!simulatorPort.isEmpty()) {
+            setupSerialPort();
+        } else {
+            startDisplayClock(&PFDMainWindow::updateDisplay);
+        }
+    }
 
-        std::time_t now = std::time(nullptr);
-        std::tm* localTime = std::localtime(&now);
-        std::stringstream ss;
-        ss << std::put_time(localTime, "%H:%M:%S");
-        std::string timeStr = ss.str();
+    // Labels are re-formatted only when the digits they show change
+    void updateTopBar() {
+        const long long alt = std::llround(altitude * 10.0);
+        const long long spd = std::llround(speed * 10.0);
+        const long long pitchShown = std::llround(pitch * 10.0);
+        const long long rollShown = std::llround(roll * 10.0);
+        const long long verticalSpeedShown = std::llround(telemetry.verticalSpeed / 10.0);
+        const long long turnRateShown = std::llround(telemetry.turnRate * 10.0);
+        const long long densityAltitudeShown = std::llround(telemetry.densityAltitude / 10.0);
+
+        if (alt != shownAltitude) {
+            shownAltitude = alt;
+            altLabel->setText(QString("ALT: %1 ft").arg(altitude, 0, 'f', 1));
+        }
+        if (spd != shownSpeed) {
+            shownSpeed = spd;
+            speedLabel->setText(QString("SPD: %1 kts").arg(speed, 0, 'f', 1));
+        }
+        if (pitchShown != shownPitch || rollShown != shownRoll) {
+            shownPitch = pitchShown;
+            shownRoll = rollShown;
+            headingLabel->setText(QString("Pitch:%1° Roll:%2°").arg(pitch, 0, 'f', 1).arg(roll, 0, 'f', 1));
+        }
+        if (verticalSpeedShown != shownVerticalSpeed || turnRateShown != shownTurnRate ||
+            densityAltitudeShown != shownDensityAltitude) {
+            shownVerticalSpeed = verticalSpeedShown;
+            shownTurnRate = turnRateShown;
+            shownDensityAltitude = densityAltitudeShown;
+            airDataLabel->setText(QString("VS: %1 fpm TRN: %2°/s DA: %3 ft")
+                                      .arg(verticalSpeedShown * 10)
+                                      .arg(turnRateShown / 10.0, 0, 'f', 1)
+                                      .arg(densityAltitudeShown * 10));
+        }
+    }
 
-        attitudeIndicator->setAttitude(pitch, roll, altitude, speed, heading,
-                                      QNH, flightMode, timeStr, rpm,
-                                      batteryState, batteryLevel, propQuantity, OAT);
+    void setLabelFont(const QString &family) {
+        const QFont labelFont(family, 16);
+        altLabel->setFont(labelFont);
+        speedLabel->setFont(labelFont);
+        airDataLabel->setFont(labelFont);
+        headingLabel->setFont(labelFont);
 
-        altLabel->setText(QString("ALT: %1 ft").arg(altitude, 0, 'f', 1));
-        speedLabel->setText(QString("SPD: %1 kts").arg(speed, 0, 'f', 1));
-        headingLabel->setText(QString("Roll: %1°").arg(roll, 0, 'f', 0));
+        // Fixed sizes, so new text never asks the layout to run again
+        fixLabelSize(altLabel, "ALT: -00000.0 ft");
+        fixLabelSize(speedLabel, "SPD: -0000.0 kts");
+        fixLabelSize(airDataLabel, "VS: -00000 fpm TRN: -000.0°/s DA: -00000 ft");
+        fixLabelSize(headingLabel, "Pitch:-000.0° Roll:-000.0°");
+    }
+
+    static void fixLabelSize(QLabel *label, const QString &widestText) {
+        QFontMetrics metrics(label->font());
+        label->setFixedSize(metrics.horizontalAdvance(widestText) + 2 * label->margin() + 2,
+                            label->sizeHint().height());
     }
 
 private:
+    LaunchOptions launchOptions;
     AttitudeIndicator *attitudeIndicator;
     QLabel *altLabel;
     QLabel *speedLabel;
+    QLabel *airDataLabel;
     QLabel *headingLabel;
     QLabel *statusLabel;
-    QTimer *simTimer;
-    QSerialPort *serialPort;
-    QByteArray serialBuffer;
+    DisplayClock *displayClock = nullptr;
+    QThread *readerThread = nullptr;
+    QThread *serverThread = nullptr;
+    QThread *simulatorThread = nullptr;
+    SerialReader *serialReader = nullptr;
+    FlightSimulator *flightSimulator = nullptr;
+    QString simulatorPort;  // --sim-pty: the slave end the reader opens
+    TelemetryClient *telemetryClient = nullptr;
+    ReplaySource *replaySource = nullptr;
+    SampleRing sampleRing;     // Reader, viewer or replay
+    SampleRing simulatorRing;  // See activeRing()
+    std::unique_ptr<FlightRecorder> recorder;
+    TelemetrySample latestSample;
+
+    // Serial link state, see onLinkChanged()
+    static constexpr std::int64_t restoredShownNs = 5'000'000'000;
+    bool linkUp = false;
+    QString linkPort;
+    std::int64_t linkWaitNs = 0;  // Start of the wait for the first sample
+    std::string restoredText;
+    std::int64_t restoredUntilNs = 0;
+
+    SensorFusion fusion;
+    std::vector<TelemetrySample> drained;  // One tick's samples, see drainSamples()
+    std::vector<int> fusionSlots;
+    AttitudeInterpolator interpolator;
+    AirData airData;  // Altitudes, rates and QNH for the snapshot, see updateDisplay()
+    LatencyStats latencyStats;
+    std::int64_t lastTickNs = 0;
+    TelemetrySnapshot telemetry;  // Filled in place every tick
     double simTime;
 
+    // Top bar values as last shown, in the labels' own precision
+    long long shownAltitude = LLONG_MIN;
+    long long shownSpeed = LLONG_MIN;
+    long long shownPitch = LLONG_MIN;
+    long long shownRoll = LLONG_MIN;
+    long long shownVerticalSpeed = LLONG_MIN;
+    long long shownTurnRate = LLONG_MIN;
+    long long shownDensityAltitude = LLONG_MIN;
+
     // Real-time sensor data from ESP32
     float pitch;
     float roll;
@@ -258,35 +635,278 @@ private:
 QString PFDMainWindow::customFontFamily = "Courier";
 QString PFDMainWindow::nimbusMono = "Nimbus Mono PS";
 
-int main(int argc, char *argv[]) {
-    QApplication app(argc, argv);
+// --batch: the whole log through the sample ring as fast as it goes, no
+// window and no painting, then a summary on stdout
+static int runBatchReplay(const QString &directory) {
+    SampleRing ring;
+    ReplaySource replay(ring);
+    if (!replay.open(directory)) {
+        qCritical() << "Replay failed:" << replay.errorString();
+        return 1;
+    }
 
-    // Load custom fonts
-    int fontId1 = QFontDatabase::addApplicationFont(":/fonts/armarurgt.ttf");
-    int fontId2 = QFontDatabase::addApplicationFont(":/fonts/NimbusMono.otf");
+    std::uint64_t samples = 0;
+    float minPitch = 0, maxPitch = 0, maxBank = 0;
+    float minAltitude = 0, maxAltitude = 0, maxAirspeed = 0;
+    bool hasAirData = false;
+
+    // Altitude and heading are gathered into arrays and derived a chunk at a
+    // time through AirData's SIMD path, at the standard setting and ISA OAT
+    const std::size_t chunk = 4096;
+    const float none = std::numeric_limits<float>::quiet_NaN();
+    AirData airData;
+    std::vector<std::int64_t> times;
+    std::vector<float> pressureAltitudes, headings;
+    std::vector<float> baroAltitudes(chunk), densityAltitudes(chunk), verticalSpeeds(chunk), turnRates(chunk);
+    times.reserve(chunk);
+    pressureAltitudes.reserve(chunk);
+    headings.reserve(chunk);
+    float minDensityAltitude = 0, maxDensityAltitude = 0, maxClimb = 0, maxDescent = 0, maxTurnRate = 0;
+    bool hasDensityAltitude = false, hasHeading = false;
+    auto deriveAirData = [&]() {
+        airData.addBatch(times.data(), pressureAltitudes.data(), headings.data(), times.size(), baroAltitudes.data(),
+                         densityAltitudes.data(), verticalSpeeds.data(), turnRates.data());
+        for (std::size_t i = 0; i < times.size(); i++) {
+            if (!std::isnan(pressureAltitudes[i])) {
+                if (!hasDensityAltitude) minDensityAltitude = maxDensityAltitude = densityAltitudes[i];
+                hasDensityAltitude = true;
+                minDensityAltitude = std::min(minDensityAltitude, densityAltitudes[i]);
+                maxDensityAltitude = std::max(maxDensityAltitude, densityAltitudes[i]);
+            }
+            maxClimb = std::max(maxClimb, verticalSpeeds[i]);
+            maxDescent = std::max(maxDescent, -verticalSpeeds[i]);
+            maxTurnRate = std::max(maxTurnRate, std::fabs(turnRates[i]));
+        }
+        times.clear();
+        pressureAltitudes.clear();
+        headings.clear();
+    };
 
-    if (fontId1 != -1) {
-        QStringList families = QFontDatabase::applicationFontFamilies(fontId1);
-        if (!families.isEmpty()) {
-            PFDMainWindow::customFontFamily = families.at(0);
-            qDebug() << "✅ Loaded armarurgt font:" << PFDMainWindow::customFontFamily;
+    const std::int64_t startNs = monotonicNowNs();
+    TelemetrySample sample;
+    while (replay.emitNext()) {
+        while (ring.pop(sample)) {
+            const bool heading = sample.has(HORUS_FIELD_HEADING) || sample.has(HORUS_FIELD_FUSED);
+            if (sample.has(HORUS_FIELD_ALTITUDE) || heading) {
+                hasHeading = hasHeading || heading;
+                times.push_back(AirData::sampleTimeNs(sample));
+                pressureAltitudes.push_back(sample.has(HORUS_FIELD_ALTITUDE) ? sample.altitude : none);
+                headings.push_back(!heading ? none : sample.has(HORUS_FIELD_HEADING) ? sample.heading : sample.yaw);
+                if (times.size() == chunk) deriveAirData();
+            }
+            if (samples++ == 0) minPitch = maxPitch = sample.pitch;
+            minPitch = std::min(minPitch, sample.pitch);
+            maxPitch = std::max(maxPitch, sample.pitch);
+            maxBank = std::max(maxBank, std::fabs(sample.roll));
+            if (sample.has(HORUS_FIELD_ALTITUDE)) {
+                if (!hasAirData) minAltitude = maxAltitude = sample.altitude;
+                hasAirData = true;
+                minAltitude = std::min(minAltitude, sample.altitude);
+                maxAltitude = std::max(maxAltitude, sample.altitude);
+            }
+            if (sample.has(HORUS_FIELD_SPEED)) maxAirspeed = std::max(maxAirspeed, sample.airspeed);
         }
+    }
+    deriveAirData();
+    const double elapsed = (monotonicNowNs() - startNs) / 1e9;
+    const double logSeconds = (replay.flightLog().endNs() - replay.flightLog().startNs()) / 1e9;
+
+    std::printf("log          %s, %.1f s\n", qPrintable(directory), logSeconds);
+    std::printf("samples      %llu in %.3f s, %.0f samples/s, %.0fx real time\n",
+                static_cast<unsigned long long>(samples), elapsed, samples / elapsed, logSeconds / elapsed);
+    std::printf("pitch        %.1f .. %.1f deg\n", minPitch, maxPitch);
+    std::printf("max bank     %.1f deg\n", maxBank);
+    if (hasAirData) {
+        std::printf("altitude     %.0f .. %.0f ft\n", minAltitude, maxAltitude);
+        std::printf("max speed    %.0f kts\n", maxAirspeed);
+        std::printf("density alt  %.0f .. %.0f ft at ISA temperature\n", minDensityAltitude, maxDensityAltitude);
+        std::printf("vert speed   +%.0f / -%.0f ft/min\n", maxClimb, maxDescent);
+    }
+    if (hasHeading) std::printf("turn rate    %.1f deg/s max\n", maxTurnRate);
+    return 0;
+}
+
+// Instrument fonts from the resources into PFDMainWindow's families; the
+// fallbacks stay where one does not load
+static void loadInstrumentFonts() {
+    const int customId = QFontDatabase::addApplicationFont(":/fonts/amarurgt.ttf");
+    const QStringList customFamilies = QFontDatabase::applicationFontFamilies(customId);
+    if (!customFamilies.isEmpty()) {
+        PFDMainWindow::customFontFamily = customFamilies.at(0);
+        qDebug() << "Loaded amarurgt font:" << PFDMainWindow::customFontFamily;
     } else {
-        PFDMainWindow::customFontFamily = "Courier";
+        qWarning() << "Could not load :/fonts/amarurgt.ttf - using" << PFDMainWindow::customFontFamily;
     }
 
-    if (fontId2 != -1) {
-        QStringList fontFamilies = QFontDatabase::applicationFontFamilies(fontId2);
-        if (!fontFamilies.isEmpty()) {
-            PFDMainWindow::nimbusMono = fontFamilies.at(0);
-            qDebug() << "✅ Loaded NimbusMono font:" << PFDMainWindow::nimbusMono;
-        }
+    const int monoId = QFontDatabase::addApplicationFont(":/fonts/NimbusMono.otf");
+    const QStringList monoFamilies = QFontDatabase::applicationFontFamilies(monoId);
+    if (!monoFamilies.isEmpty()) {
+        PFDMainWindow::nimbusMono = monoFamilies.at(0);
+        qDebug() << "Loaded NimbusMono font:" << PFDMainWindow::nimbusMono;
     } else {
-        PFDMainWindow::nimbusMono = "Nimbus Mono PS";
+        qWarning() << "Could not load :/fonts/NimbusMono.otf - using" << PFDMainWindow::nimbusMono;
+    }
+}
+
+// The first frame goes up in the fallback fonts. Loading the instrument
+// fonts and building their glyph atlases waits until it is painted, then
+// runs between two display ticks, so a restarted ground station shows its
+// PFD as early as it can.
+template <typename Window>
+static void finishStartup(Window &window, bool exitAfterFirstFrame) {
+    StartupTrace &trace = StartupTrace::instance();
+    trace.mark(StartupTrace::WindowShown);
+    QObject::connect(&window, &Window::firstFramePainted, &window, [&window, &trace, exitAfterFirstFrame](qint64 paintedNs) {
+        if (!trace.mark(StartupTrace::FirstFrame, paintedNs)) return;  // Another PFD of the fleet was first
+        loadInstrumentFonts();
+        trace.mark(StartupTrace::FontsLoaded);
+        window.setCustomFonts(PFDMainWindow::customFontFamily, PFDMainWindow::nimbusMono);
+        window.warmUp();
+        trace.mark(StartupTrace::CachesWarm);
+        qDebug() << "Startup:" << trace.summary().c_str();
+        if (exitAfterFirstFrame) {
+            trace.writeReport(stdout);
+            std::fflush(stdout);
+            QCoreApplication::exit(0);
+        }
+    }, Qt::QueuedConnection);
+}
+
+static LaunchOptions parseLaunchOptions(const QCoreApplication &app) {
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Horus Project - UAV Primary Flight Display");
+    parser.addHelpOption();
+    QCommandLineOption recordOption("record", "Write a flight log under <directory>.", "directory");
+    QCommandLineOption recordRawOption("record-raw", "Also log the raw bytes read from the port.");
+    QCommandLineOption replayOption("replay", "Play a flight log instead of reading the port.", "directory");
+    QCommandLineOption speedOption("speed", "Replay speed, 0.1 to 100.", "factor", "1");
+    QCommandLineOption batchOption("batch", "With --replay: analyse the log at full speed, no display.");
+    QCommandLineOption portsOption("ports", "Monitor several vehicles, one serial port or pty each.", "port,port,...");
+    QCommandLineOption fusionOption("fusion", "Attitude from raw IMU samples: madgwick, mahony or off (the sender's).",
+                                    "filter", "madgwick");
+    parser.addOption(recordOption);
+    parser.addOption(recordRawOption);
+    parser.addOption(replayOption);
+    parser.addOption(speedOption);
+    parser.addOption(batchOption);
+    parser.addOption(portsOption);
+    QCommandLineOption serveOption("serve", "Republish the port's telemetry, e.g. udp://239.255.72.79:7279,"
+                                   "tcp://127.0.0.1:7280,local:horus.", "endpoint,...");
+    QCommandLineOption connectOption("connect", "Viewer only: show another instance's --serve endpoint.", "endpoint");
+    parser.addOption(fusionOption);
+    QCommandLineOption renderDelayOption("render-delay", "Show attitude this far in the past, so frames interpolate "
+                                         "between samples; auto is one sample period.", "ms|auto", "auto");
+    QCommandLineOption maxExtrapolationOption("max-extrapolation", "Extrapolate attitude at most this far past "
+                                              "the newest sample.", "ms", "40");
+    parser.addOption(renderDelayOption);
+    parser.addOption(maxExtrapolationOption);
+    QCommandLineOption simulateOption("simulate", "Fly the built-in flight simulator instead of reading the port.");
+    QCommandLineOption simRateOption("sim-rate", "Simulator steps per second, 50 to 2000.", "hz", "50");
+    QCommandLineOption simSeedOption("sim-seed", "Simulator random seed; the same seed flies the same flight.", "n", "1");
+    QCommandLineOption simPtyOption("sim-pty", "With --simulate: send binary frames through a pty and the serial reader.");
+    parser.addOption(serveOption);
+    parser.addOption(connectOption);
+    parser.addOption(simulateOption);
+    parser.addOption(simRateOption);
+    parser.addOption(simSeedOption);
+    parser.addOption(simPtyOption);
+    QCommandLineOption baudOption("baud", "Serial baud rate.", "rate", "115200");
+    QCommandLineOption usbIdOption("usb-id", "Also look for these USB serial bridges when no port is given.",
+                                   "vid:pid,...");
+    parser.addOption(baudOption);
+    parser.addOption(usbIdOption);
+    QCommandLineOption exitAfterFirstFrameOption("exit-after-first-frame",
+                                                 "Print the startup trace once the first frame is painted and exit.");
+    parser.addOption(exitAfterFirstFrameOption);
+    parser.process(app);
+
+    LaunchOptions launch;
+    launch.recordDirectory = parser.value(recordOption);
+    launch.recordRawBytes = parser.isSet(recordRawOption);
+    launch.replayDirectory = parser.value(replayOption);
+    launch.replaySpeed = parser.value(speedOption).toDouble();
+    launch.fleetPorts = parser.value(portsOption).split(',', Qt::SkipEmptyParts);
+    const QString fusion = parser.value(fusionOption).toLower();
+    if (fusion == "mahony") launch.fusion = FusionAlgorithm::Mahony;
+    else if (fusion == "off") launch.fusion = FusionAlgorithm::Off;
+    else if (fusion != "madgwick") qWarning() << "Unknown --fusion" << fusion << "- using madgwick";
+    bool ok = false;
+    const QString renderDelay = parser.value(renderDelayOption);
+    const double renderDelayMs = renderDelay.toDouble(&ok);
+    if (ok && renderDelayMs >= 0) launch.renderDelayNs = static_cast<std::int64_t>(renderDelayMs * 1e6);
+    else if (renderDelay != "auto") qWarning() << "Ignoring --render-delay" << renderDelay;
+    const double maxExtrapolationMs = parser.value(maxExtrapolationOption).toDouble(&ok);
+    if (ok && maxExtrapolationMs >= 0) launch.maxExtrapolationNs = static_cast<std::int64_t>(maxExtrapolationMs * 1e6);
+    else qWarning() << "Ignoring --max-extrapolation" << parser.value(maxExtrapolationOption);
+    for (const QString &text : parser.value(serveOption).split(',', Qt::SkipEmptyParts)) {
+        TelemetryEndpoint endpoint;
+        QString error;
+        if (TelemetryEndpoint::parse(text, endpoint, error)) launch.serveEndpoints.push_back(endpoint);
+        else qWarning() << "Ignoring --serve" << error;
+    }
+    launch.simulate = parser.isSet(simulateOption);
+    launch.simulationRate = qBound(FlightModel::minRate, parser.value(simRateOption).toDouble(), FlightModel::maxRate);
+    launch.simulationSeed = parser.value(simSeedOption).toUInt();
+    launch.simulatePty = parser.isSet(simPtyOption);
+    const qint32 baud = parser.value(baudOption).toInt();
+    if (baud > 0) launch.baudRate = baud;
+    else qWarning() << "Ignoring --baud" << parser.value(baudOption);
+    for (const QString &text : parser.value(usbIdOption).split(',', Qt::SkipEmptyParts)) {
+        UsbSerialId id;
+        if (portdiscovery::parseUsbId(text, id)) launch.usbIds.append(id);
+        else qWarning() << "Ignoring --usb-id" << text << "- expected hex vid:pid";
+    }
+    launch.exitAfterFirstFrame = parser.isSet(exitAfterFirstFrameOption);
+    if (parser.isSet(connectOption)) {
+        TelemetryEndpoint endpoint;
+        QString error;
+        if (TelemetryEndpoint::parse(parser.value(connectOption), endpoint, error)) launch.connectEndpoint = endpoint;
+        else qWarning() << "Ignoring --connect" << error;
+    }
+    return launch;
+}
+
+int main(int argc, char *argv[]) {
+    // Batch replays need no display, so they do not get a QApplication
+    bool batch = false;
+    for (int i = 1; i < argc; i++) batch = batch || std::strcmp(argv[i], "--batch") == 0;
+    if (batch) {
+        QCoreApplication app(argc, argv);
+        const LaunchOptions launch = parseLaunchOptions(app);
+        if (launch.replayDirectory.isEmpty()) {
+            qCritical() << "--batch needs --replay <directory>";
+            return 2;
+        }
+        return runBatchReplay(launch.replayDirectory);
+    }
+
+    QApplication app(argc, argv);
+    const LaunchOptions launch = parseLaunchOptions(app);
+    StartupTrace::instance().mark(StartupTrace::ApplicationReady);
+
+    if (launch.fleetPorts.size() > 1) {
+        if (!launch.serveEndpoints.empty() || launch.connectEndpoint) {
+            qWarning() << "--serve and --connect follow one vehicle; ignored with --ports";
+        }
+        std::unique_ptr<FlightRecorder> recorder;
+        if (!launch.recordDirectory.isEmpty()) {
+            recorder.reset(new FlightRecorder(recordingSessionPath(launch.recordDirectory)));
+        }
+        FleetWindow fleet(launch.fleetPorts, recorder.get(), launch.recordRawBytes, launch.baudRate);
+        fleet.setCustomFonts(PFDMainWindow::customFontFamily, PFDMainWindow::nimbusMono);
+        fleet.setFusionAlgorithm(launch.fusion);
+        fleet.setInterpolation(launch.renderDelayNs, launch.maxExtrapolationNs);
+        if (recorder && !recorder->start()) {
+            qWarning() << "Flight recorder disabled:" << recorder->lastError();
+        }
+        fleet.show();
+        finishStartup(fleet, launch.exitAfterFirstFrame);
+        return app.exec();  // The window, and with it the readers, goes before the recorder
     }
 
-    PFDMainWindow window;
+    PFDMainWindow window(launch);
     window.show();
+    finishStartup(window, launch.exitAfterFirstFrame);
 
     return app.exec();
 }
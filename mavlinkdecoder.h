@@ -0,0 +1,346 @@
+#ifndef MAVLINKDECODER_H
+#define MAVLINKDECODER_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include "telemetrysample.h"
+
+// MAVLink v2 framing, and the few messages the PFD shows. Field offsets are
+// in wire order (largest types first, extensions last), as in common.xml.
+namespace mavlink {
+
+constexpr std::uint8_t stx = 0xFD;
+constexpr std::size_t headerSize = 10;     // stx .. msgid
+constexpr std::size_t checksumSize = 2;
+constexpr std::size_t signatureSize = 13;
+constexpr std::uint8_t incompatSigned = 0x01;
+constexpr std::size_t maxFrameSize = headerSize + 255 + checksumSize + signatureSize;
+
+constexpr std::uint32_t msgSysStatus = 1;
+constexpr std::uint32_t msgAttitude = 30;
+constexpr std::uint32_t msgGlobalPositionInt = 33;
+constexpr std::uint32_t msgVfrHud = 74;
+constexpr std::uint32_t msgEscStatus = 291;
+
+// Seeds the checksum with each message's layout, so a sender built from a
+// different definition fails the CRC instead of being misread. 0: unknown.
+inline std::uint8_t crcExtra(std::uint32_t msgid) {
+    switch (msgid) {
+    case msgSysStatus: return 124;
+    case msgAttitude: return 39;
+    case msgGlobalPositionInt: return 104;
+    case msgVfrHud: return 20;
+    case msgEscStatus: return 10;
+    default: return 0;
+    }
+}
+
+// CRC-16/MCRF4XX ("X.25" in the MAVLink sources)
+inline std::uint16_t crcAccumulate(std::uint8_t byte, std::uint16_t crc) {
+    std::uint8_t tmp = static_cast<std::uint8_t>(byte ^ (crc & 0xFF));
+    tmp = static_cast<std::uint8_t>(tmp ^ (tmp << 4));
+    return static_cast<std::uint16_t>((crc >> 8) ^ (tmp << 8) ^ (tmp << 3) ^ (tmp >> 4));
+}
+
+inline std::uint16_t crc(const std::uint8_t *data, std::size_t length, std::uint16_t crc = 0xFFFF) {
+    for (std::size_t i = 0; i < length; i++) crc = crcAccumulate(data[i], crc);
+    return crc;
+}
+
+// Senders drop trailing zero bytes from the payload; reads past the end
+// see those zeros. Little-endian, like the wire.
+template <typename T>
+T field(const std::uint8_t *payload, std::size_t length, std::size_t offset) {
+    using Bits = std::conditional_t<sizeof(T) == 1, std::uint8_t,
+                 std::conditional_t<sizeof(T) == 2, std::uint16_t,
+                 std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>>>;
+    Bits bits = 0;
+    for (std::size_t i = 0; i < sizeof(T) && offset + i < length; i++) {
+        bits = static_cast<Bits>(bits | static_cast<Bits>(payload[offset + i]) << (8 * i));
+    }
+    T value;
+    std::memcpy(&value, &bits, sizeof(T));
+    return value;
+}
+
+// Builds one unsigned v2 frame into out (maxFrameSize bytes) with trailing
+// zeros trimmed as a sender would. For tools and benchmarks; returns its size.
+inline std::size_t encodeFrame(std::uint32_t msgid, const std::uint8_t *payload, std::size_t length,
+                               std::uint8_t sequence, std::uint8_t systemId, std::uint8_t componentId,
+                               std::uint8_t *out) {
+    while (length > 1 && payload[length - 1] == 0) length--;
+    out[0] = stx;
+    out[1] = static_cast<std::uint8_t>(length);
+    out[2] = 0;
+    out[3] = 0;
+    out[4] = sequence;
+    out[5] = systemId;
+    out[6] = componentId;
+    out[7] = static_cast<std::uint8_t>(msgid);
+    out[8] = static_cast<std::uint8_t>(msgid >> 8);
+    out[9] = static_cast<std::uint8_t>(msgid >> 16);
+    std::memcpy(out + headerSize, payload, length);
+    std::uint16_t checksum = crc(out + 1, headerSize - 1 + length);
+    checksum = crcAccumulate(crcExtra(msgid), checksum);
+    out[headerSize + length] = static_cast<std::uint8_t>(checksum);
+    out[headerSize + length + 1] = static_cast<std::uint8_t>(checksum >> 8);
+    return headerSize + length + checksumSize;
+}
+
+} // namespace mavlink
+
+// Streaming decoder for an autopilot's MAVLink v2 telemetry: ATTITUDE,
+// VFR_HUD, GLOBAL_POSITION_INT, SYS_STATUS and ESC_STATUS, checked against
+// their CRC_EXTRA. Frames that arrive whole in one chunk are decoded where
+// they lie; only a frame split across chunks is copied, into a fixed buffer,
+// so there is no allocation on the ingest path.
+//
+// The messages come at different rates, so their values are merged into
+// one running sample. A sample is handed on for every ATTITUDE message, the
+// one that moves the horizon, carrying the latest of everything else; until
+// the first ATTITUDE, every decoded message hands one on.
+//
+// Follows one vehicle: the first system heard from, unless setSystemId()
+// says otherwise. Other systems' messages are counted and ignored.
+class MavlinkDecoder {
+public:
+    // 0 follows the first system heard from
+    void setSystemId(std::uint8_t id) {
+        systemId = id;
+        followedSystem = id;
+    }
+
+    // Calls onSample(const TelemetrySample &) as described above
+    template <typename SampleHandler>
+    void feed(const std::uint8_t *data, std::size_t length, std::int64_t arrivedNs, SampleHandler &&onSample) {
+        const std::uint8_t *end = data + length;
+        for (;;) {
+            if (pendingLength > 0) {
+                // A frame started in an earlier chunk: complete it in the buffer
+                std::size_t need = pendingLength < mavlink::headerSize ? mavlink::headerSize : frameSize(pending);
+                std::size_t take = std::min(need - std::min(need, pendingLength), static_cast<std::size_t>(end - data));
+                std::memcpy(pending + pendingLength, data, take);
+                pendingLength += take;
+                data += take;
+                if (pendingLength < mavlink::headerSize) return;
+                need = frameSize(pending);
+                if (pendingLength < need) {
+                    take = std::min(need - pendingLength, static_cast<std::size_t>(end - data));
+                    std::memcpy(pending + pendingLength, data, take);
+                    pendingLength += take;
+                    data += take;
+                    if (pendingLength < need) return;
+                }
+                // A bad frame may have swallowed the start of a good one
+                inSync = decodeFrame(pending, arrivedNs, onSample);
+                resync(inSync ? need : 1);
+                continue;
+            }
+
+            if (data == end) return;
+            const void *found = std::memchr(data, mavlink::stx, static_cast<std::size_t>(end - data));
+            if (!found) {
+                skip(static_cast<std::size_t>(end - data));
+                return;
+            }
+            const std::uint8_t *start = static_cast<const std::uint8_t *>(found);
+            skip(static_cast<std::size_t>(start - data));
+
+            const std::size_t available = static_cast<std::size_t>(end - start);
+            if (available >= mavlink::headerSize && available >= frameSize(start)) {
+                inSync = decodeFrame(start, arrivedNs, onSample);
+                data = inSync ? start + frameSize(start) : start + 1;
+                continue;
+            }
+            std::memcpy(pending, start, available);
+            pendingLength = available;
+            return;
+        }
+    }
+
+    void reset() {
+        pendingLength = 0;
+        haveSequence = false;
+        inSync = false;
+        haveAttitude = false;
+        haveHudHeading = false;
+        followedSystem = systemId;
+        followedComponent = 0;
+        state = TelemetrySample();
+    }
+
+    std::uint64_t messageCount() const { return messages; }            // Decoded and used
+    std::uint64_t crcErrorCount() const { return crcErrors; }
+    std::uint64_t unknownMessageCount() const { return unknownMessages; }  // Passed over whole, CRC unchecked
+    std::uint64_t otherSystemCount() const { return otherSystems; }
+    std::uint64_t sequenceGapCount() const { return sequenceGaps; }    // Frames missing between good ones
+    std::uint64_t skippedByteCount() const { return skippedBytes; }     // Outside any frame
+
+private:
+    static std::size_t frameSize(const std::uint8_t *frame) {
+        const bool isSigned = (frame[2] & mavlink::incompatSigned) != 0;
+        return mavlink::headerSize + frame[1] + mavlink::checksumSize + (isSigned ? mavlink::signatureSize : 0);
+    }
+
+    void skip(std::size_t count) {
+        if (count == 0) return;
+        skippedBytes += count;
+        inSync = false;
+    }
+
+    // Drops pending[0, from) and keeps the rest from the next start byte on
+    void resync(std::size_t from) {
+        const void *found = from < pendingLength ? std::memchr(pending + from, mavlink::stx, pendingLength - from) : nullptr;
+        if (!found) {
+            skip(pendingLength > from ? pendingLength - from : 0);
+            pendingLength = 0;
+            return;
+        }
+        const std::size_t next = static_cast<std::size_t>(static_cast<const std::uint8_t *>(found) - pending);
+        skip(next - from);
+        std::memmove(pending, pending + next, pendingLength - next);
+        pendingLength -= next;
+    }
+
+    // False when frame is not a MAVLink frame after all, so scanning
+    // resumes right after its start byte
+    template <typename SampleHandler>
+    bool decodeFrame(const std::uint8_t *frame, std::int64_t arrivedNs, SampleHandler &onSample) {
+        // Incompatible flags we don't know: the spec says drop it, and noise
+        // that happens to contain a start byte mostly ends here
+        if (frame[2] & ~mavlink::incompatSigned) return false;
+
+        const std::size_t length = frame[1];
+        const std::uint32_t msgid = frame[7] | (frame[8] << 8) | (static_cast<std::uint32_t>(frame[9]) << 16);
+        const std::uint8_t extra = mavlink::crcExtra(msgid);
+        if (extra == 0) {
+            // Without its CRC_EXTRA a message can't be checked. Right after a
+            // good frame it is almost surely real and is passed over whole;
+            // anywhere else it may be noise hiding the start of a good one.
+            if (!inSync) return false;
+            unknownMessages++;
+            countSequence(frame);
+            return true;
+        }
+
+        std::uint16_t checksum = mavlink::crc(frame + 1, mavlink::headerSize - 1 + length);
+        checksum = mavlink::crcAccumulate(extra, checksum);
+        const std::uint8_t *trailer = frame + mavlink::headerSize + length;
+        if ((trailer[0] | (trailer[1] << 8)) != checksum) {
+            crcErrors++;
+            return false;
+        }
+
+        const std::uint8_t sender = frame[5];
+        if (followedSystem == 0) followedSystem = sender;
+        if (sender != followedSystem) {
+            otherSystems++;
+            return true;
+        }
+        if (followedComponent == 0) followedComponent = frame[6];
+        countSequence(frame);
+        messages++;
+
+        const std::uint8_t *payload = frame + mavlink::headerSize;
+        switch (msgid) {
+        case mavlink::msgAttitude: decodeAttitude(payload, length); break;
+        case mavlink::msgGlobalPositionInt: decodeGlobalPosition(payload, length); break;
+        case mavlink::msgVfrHud: decodeVfrHud(payload, length); break;
+        case mavlink::msgSysStatus: decodeSysStatus(payload, length); break;
+        case mavlink::msgEscStatus: decodeEscStatus(payload, length); break;
+        }
+
+        if (msgid == mavlink::msgAttitude || !haveAttitude) {
+            state.timestampNs = arrivedNs;
+            onSample(state);
+        }
+        return true;
+    }
+
+    // Sequence numbers count per component; the autopilot sends all of ours
+    void countSequence(const std::uint8_t *frame) {
+        if (frame[5] != followedSystem || frame[6] != followedComponent) return;
+        const std::uint8_t sequence = frame[4];
+        if (haveSequence) sequenceGaps += static_cast<std::uint8_t>(sequence - lastSequence - 1);
+        lastSequence = sequence;
+        haveSequence = true;
+    }
+
+    void decodeAttitude(const std::uint8_t *p, std::size_t n) {
+        state.sensorTimeMs = mavlink::field<std::uint32_t>(p, n, 0);
+        state.roll = degrees(mavlink::field<float>(p, n, 4));
+        state.pitch = degrees(mavlink::field<float>(p, n, 8));
+        state.yaw = degrees(mavlink::field<float>(p, n, 12));
+        state.fields |= HORUS_FIELD_ATTITUDE;
+        haveAttitude = true;
+    }
+
+    void decodeGlobalPosition(const std::uint8_t *p, std::size_t n) {
+        state.altitude = mavlink::field<std::int32_t>(p, n, 12) / 1000.0f * feetPerMetre;  // mm AMSL
+        const std::uint16_t hdg = mavlink::field<std::uint16_t>(p, n, 26);                // cdeg, UINT16_MAX unknown
+        state.fields |= HORUS_FIELD_ALTITUDE;
+        // VFR_HUD's heading wins where both come
+        if (hdg != UINT16_MAX && !haveHudHeading) {
+            state.heading = hdg / 100.0f;
+            state.fields |= HORUS_FIELD_HEADING;
+        }
+    }
+
+    void decodeVfrHud(const std::uint8_t *p, std::size_t n) {
+        state.airspeed = mavlink::field<float>(p, n, 0) * knotsPerMetrePerSecond;
+        state.altitude = mavlink::field<float>(p, n, 8) * feetPerMetre;  // m AMSL
+        state.heading = mavlink::field<std::int16_t>(p, n, 16);          // deg
+        state.fields |= HORUS_FIELD_SPEED | HORUS_FIELD_ALTITUDE | HORUS_FIELD_HEADING;
+        haveHudHeading = true;
+    }
+
+    void decodeSysStatus(const std::uint8_t *p, std::size_t n) {
+        const std::uint16_t millivolts = mavlink::field<std::uint16_t>(p, n, 14);  // UINT16_MAX unknown
+        const std::int8_t remaining = mavlink::field<std::int8_t>(p, n, 30);       // %, -1 unknown
+        if (millivolts == UINT16_MAX) return;
+        state.batteryVolts = millivolts / 1000.0f;
+        if (remaining >= 0) state.batteryLevel = std::min<int>(remaining, 100) / 100.0f;
+        state.fields |= HORUS_FIELD_BATTERY;
+    }
+
+    void decodeEscStatus(const std::uint8_t *p, std::size_t n) {
+        // Four ESCs per message, starting at index
+        const std::uint8_t index = mavlink::field<std::uint8_t>(p, n, 56);
+        for (int i = 0; i < 4 && index + i < 4; i++) {
+            const std::int32_t rpm = mavlink::field<std::int32_t>(p, n, 8 + 4 * i);
+            state.rpm[index + i] = static_cast<std::uint16_t>(std::clamp<std::int32_t>(rpm, 0, UINT16_MAX));
+        }
+        state.fields |= HORUS_FIELD_RPM;
+    }
+
+    static float degrees(float radians) { return radians * (180.0f / 3.14159265358979f); }
+
+    static constexpr float feetPerMetre = 3.28084f;
+    static constexpr float knotsPerMetrePerSecond = 1.94384f;
+
+    std::uint8_t pending[mavlink::maxFrameSize];
+    std::size_t pendingLength = 0;
+
+    std::uint8_t systemId = 0;
+    std::uint8_t followedSystem = 0;
+    std::uint8_t followedComponent = 0;
+    std::uint8_t lastSequence = 0;
+    bool haveSequence = false;
+    bool inSync = false;  // The last bytes were a whole frame
+    bool haveAttitude = false;
+    bool haveHudHeading = false;
+    TelemetrySample state;  // Everything heard so far
+
+    std::uint64_t messages = 0;
+    std::uint64_t crcErrors = 0;
+    std::uint64_t unknownMessages = 0;
+    std::uint64_t otherSystems = 0;
+    std::uint64_t sequenceGaps = 0;
+    std::uint64_t skippedBytes = 0;
+};
+
+#endif // MAVLINKDECODER_H
@@ -0,0 +1,91 @@
+#ifndef PORTDISCOVERY_H
+#define PORTDISCOVERY_H
+
+#include <QList>
+#include <QSerialPortInfo>
+#include <QString>
+#include <QStringList>
+#include <algorithm>
+#include <cstdint>
+
+// A USB serial bridge by vendor and product id
+struct UsbSerialId {
+    std::uint16_t vendorId;
+    std::uint16_t productId;
+    const char *name;
+};
+
+namespace portdiscovery {
+
+// The bridges found on ESP32 boards, and the S3/C3's own USB serial
+inline const QList<UsbSerialId> &knownBridges() {
+    static const QList<UsbSerialId> bridges = {
+        {0x10C4, 0xEA60, "CP210x"},
+        {0x1A86, 0x7523, "CH340"},
+        {0x1A86, 0x55D4, "CH9102"},
+        {0x0403, 0x6001, "FT232R"},
+        {0x0403, 0x6015, "FT231X"},
+        {0x303A, 0x1001, "ESP32 USB serial"},
+    };
+    return bridges;
+}
+
+// "10c4:ea60", hex; false if malformed
+inline bool parseUsbId(const QString &text, UsbSerialId &id) {
+    const QStringList parts = text.trimmed().split(':');
+    if (parts.size() != 2) return false;
+    bool vendorOk = false, productOk = false;
+    const uint vendor = parts[0].toUInt(&vendorOk, 16);
+    const uint product = parts[1].toUInt(&productOk, 16);
+    if (!vendorOk || !productOk || vendor > 0xFFFF || product > 0xFFFF) return false;
+    id = {static_cast<std::uint16_t>(vendor), static_cast<std::uint16_t>(product), "custom"};
+    return true;
+}
+
+// The id of port's bridge among ids, or nullptr
+inline const UsbSerialId *matchBridge(const QSerialPortInfo &port, const QList<UsbSerialId> &ids) {
+    if (!port.hasVendorIdentifier() || !port.hasProductIdentifier()) return nullptr;
+#ifdef Q_OS_MACOS
+    // tty.* waits for carrier detect on open; the cu.* twin does not
+    if (port.portName().startsWith("tty.")) return nullptr;
+#endif
+    for (const UsbSerialId &id : ids) {
+        if (port.vendorIdentifier() == id.vendorId && port.productIdentifier() == id.productId) return &id;
+    }
+    return nullptr;
+}
+
+inline QList<QSerialPortInfo> portsByLocation() {
+    QList<QSerialPortInfo> ports = QSerialPortInfo::availablePorts();
+    std::sort(ports.begin(), ports.end(), [](const QSerialPortInfo &a, const QSerialPortInfo &b) {
+        return a.systemLocation() < b.systemLocation();
+    });
+    return ports;
+}
+
+// The first port, by system location, whose bridge is one of ids; empty if
+// none is plugged in. Enumeration takes milliseconds: keep it off the GUI
+// thread.
+inline QString findPort(const QList<UsbSerialId> &ids, QString *bridgeName = nullptr) {
+    for (const QSerialPortInfo &port : portsByLocation()) {
+        if (const UsbSerialId *id = matchBridge(port, ids)) {
+            if (bridgeName) *bridgeName = QString::fromLatin1(id->name);
+            return port.systemLocation();
+        }
+    }
+    return QString();
+}
+
+// Every such port, by system location; comparing two calls shows what was
+// plugged in or out in between
+inline QStringList findPorts(const QList<UsbSerialId> &ids) {
+    QStringList found;
+    for (const QSerialPortInfo &port : portsByLocation()) {
+        if (matchBridge(port, ids)) found.append(port.systemLocation());
+    }
+    return found;
+}
+
+} // namespace portdiscovery
+
+#endif // PORTDISCOVERY_H
@@ -0,0 +1,50 @@
+#ifndef READERPOOL_H
+#define READERPOOL_H
+
+#include <QObject>
+#include <QThread>
+#include <QVector>
+
+// A fixed set of ingest threads shared by many SerialReaders. A reader's port
+// notifier lives on whichever thread the reader is moved to, and one event
+// loop serves any number of ports, so a swarm costs a few threads rather
+// than one per vehicle.
+class ReaderPool {
+public:
+    explicit ReaderPool(int threadCount) {
+        for (int i = 0; i < qMax(1, threadCount); i++) {
+            QThread *thread = new QThread;
+            thread->setObjectName(QString("horus-reader-%1").arg(i));
+            thread->start();
+            threads.append(thread);
+        }
+    }
+
+    ~ReaderPool() {
+        // Readers are deleted on their own threads as the loops wind down
+        for (QThread *thread : threads) thread->quit();
+        for (QThread *thread : threads) {
+            thread->wait();
+            delete thread;
+        }
+    }
+
+    ReaderPool(const ReaderPool &) = delete;
+    ReaderPool &operator=(const ReaderPool &) = delete;
+
+    // Moves reader (parentless) onto the next thread, round robin. The pool
+    // deletes it when it shuts down.
+    void adopt(QObject *reader) {
+        QThread *thread = threads[next++ % threads.size()];
+        reader->moveToThread(thread);
+        QObject::connect(thread, &QThread::finished, reader, &QObject::deleteLater);
+    }
+
+    int threadCount() const { return threads.size(); }
+
+private:
+    QVector<QThread *> threads;
+    int next = 0;
+};
+
+#endif // READERPOOL_H
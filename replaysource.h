@@ -0,0 +1,176 @@
+#ifndef REPLAYSOURCE_H
+#define REPLAYSOURCE_H
+
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <cstring>
+#include "flightlogreader.h"
+#include "telemetrysample.h"
+
+// Plays a recorded flight log back into a SampleRing, in place of a
+// SerialReader: samples leave here re-stamped with the host clock, so the
+// display, interpolator and latency stats treat them like live ones.
+//
+// Playback follows the log's own timestamps at 0.1x..100x, can pause, seek
+// and step one sample at a time. Runs on its own QThread like the reader;
+// drive it with queued calls. For batch work without a display, call
+// emitNext() in a loop instead of play().
+class ReplaySource : public QObject {
+    Q_OBJECT
+
+public:
+    static constexpr double minSpeed = 0.1;
+    static constexpr double maxSpeed = 100.0;
+
+    explicit ReplaySource(SampleRing &ring, QObject *parent = nullptr)
+    : QObject(parent), sampleRing(ring) {
+    }
+
+    // Maps the log; call before moving to the replay thread
+    bool open(const QString &directory) {
+        if (!log.open(directory)) return false;
+        cursor = log.begin();
+        positionNs = log.startNs();
+        return true;
+    }
+
+    const QString &errorString() const { return log.errorString(); }
+    const FlightLogReader &flightLog() const { return log; }
+
+    // Which recorder channel (vehicle) to play
+    void setChannel(std::uint16_t id) { channel = id; }
+
+    // Log time of the last sample emitted
+    std::int64_t position() const { return positionNs; }
+    double speed() const { return playbackSpeed; }
+    bool isPlaying() const { return timer && timer->isActive(); }
+
+    // Emits the next sample regardless of the clock; false at the end of the log
+    bool emitNext() {
+        TelemetrySample sample;
+        if (!nextSample(sample)) return false;
+        emitSample(sample);
+        return true;
+    }
+
+public slots:
+    void play() {
+        if (!timer) {
+            timer = new QTimer(this);
+            timer->setTimerType(Qt::PreciseTimer);
+            connect(timer, &QTimer::timeout, this, &ReplaySource::tick);
+        }
+        anchor(positionNs);
+        timer->start(1);
+    }
+
+    void pause() {
+        if (timer) timer->stop();
+    }
+
+    void togglePause() {
+        if (isPlaying()) pause();
+        else play();
+    }
+
+    void setSpeed(double speed) {
+        playbackSpeed = qBound(minSpeed, speed, maxSpeed);
+        anchor(positionNs);
+    }
+
+    // Shows the last sample at or before timestampNs, then carries on from there
+    void seek(qint64 timestampNs) {
+        timestampNs = qBound<qint64>(log.startNs(), timestampNs, log.endNs());
+
+        // The index lands at most one interval early; walk the rest
+        FlightLogReader::Cursor probe = log.seek(timestampNs);
+        cursor = probe;
+        TelemetrySample candidate, shown;
+        bool found = false;
+        while (nextSample(candidate, probe) && candidate.timestampNs <= timestampNs) {
+            shown = candidate;
+            found = true;
+            cursor = probe;
+        }
+        if (found) emitSample(shown);
+        positionNs = timestampNs;
+        anchor(positionNs);
+    }
+
+    void seekBy(qint64 deltaNs) {
+        seek(positionNs + deltaNs);
+    }
+
+    // One sample forward, paused
+    void step() {
+        pause();
+        emitNext();
+    }
+
+signals:
+    void finished();
+
+private slots:
+    // Emits everything the playback clock has passed
+    void tick() {
+        const std::int64_t target = anchorLogNs +
+            static_cast<std::int64_t>((monotonicNowNs() - anchorHostNs) * playbackSpeed);
+
+        TelemetrySample sample;
+        FlightLogReader::Cursor probe = cursor;
+        while (nextSample(sample, probe)) {
+            if (sample.timestampNs > target) return;
+            cursor = probe;
+            emitSample(sample);
+        }
+        pause();
+        emit finished();
+    }
+
+private:
+    void anchor(std::int64_t logNs) {
+        anchorLogNs = logNs;
+        anchorHostNs = monotonicNowNs();
+    }
+
+    bool nextSample(TelemetrySample &sample) {
+        return nextSample(sample, cursor);
+    }
+
+    bool nextSample(TelemetrySample &sample, FlightLogReader::Cursor &at) const {
+        FlightLogRecordHeader record;
+        const std::uint8_t *payload;
+        while (log.next(at, record, payload)) {
+            if (record.type == FLIGHT_LOG_SAMPLE && record.channel == channel) {
+                std::memcpy(&sample, payload, sizeof(sample));
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void emitSample(TelemetrySample sample) {
+        positionNs = sample.timestampNs;
+        const std::int64_t now = monotonicNowNs();
+        sample.timestampNs = now;
+        sample.parsedNs = now;
+        sample.handoffNs = 0;
+        // The sender clock only matches the host at 1x; elsewhere let the
+        // interpolator use arrival spacing
+        if (playbackSpeed != 1.0) sample.sensorTimeMs = 0;
+        sampleRing.push(sample);
+    }
+
+    SampleRing &sampleRing;
+    FlightLogReader log;
+    FlightLogReader::Cursor cursor;
+    std::uint16_t channel = 0;
+    QTimer *timer = nullptr;
+    double playbackSpeed = 1.0;
+    std::int64_t positionNs = 0;
+    std::int64_t anchorLogNs = 0;
+    std::int64_t anchorHostNs = 0;
+};
+
+#endif // REPLAYSOURCE_H
@@ -0,0 +1,336 @@
+#ifndef SENSORFUSION_H
+#define SENSORFUSION_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "simdfloat4.h"
+#include "telemetrysample.h"
+
+enum class FusionAlgorithm {
+    Off,       // Keep the sender's angles
+    Madgwick,  // Gradient descent, one gain (beta)
+    Mahony,    // Complementary PI on the gravity error
+};
+
+// Quaternion attitude from raw MPU6050 accel/gyro, on the host.
+//
+// Every vehicle is a lane; lanes are stored four to a SIMD register, so one
+// filter step advances four vehicles. Samples are queued per vehicle with
+// add() and fused together by fuse(), all lanes in lock step: a vehicle
+// with fewer queued samples simply sits out the remaining steps (dt = 0).
+// Axes follow the firmware: pitch about the sensor's x axis, roll about y.
+// Without a magnetometer, yaw is integrated gyro and drifts slowly.
+class SensorFusion {
+public:
+    struct Attitude {
+        float pitch = 0.0f;    // degrees, +-90
+        float roll = 0.0f;     // degrees, +-180
+        float heading = 0.0f;  // degrees, 0..360, relative to the first sample
+    };
+
+    // Samples per vehicle between fuse() calls: one full SampleRing
+    static constexpr int maxBatch = static_cast<int>(SampleRing::capacity());
+
+    static constexpr double pi = 3.14159265358979323846;
+
+    // Longer gaps are a dropped link, not a step to integrate over
+    static constexpr float maxStepSeconds = 0.25f;
+
+    explicit SensorFusion(FusionAlgorithm algorithm = FusionAlgorithm::Madgwick)
+    : method(algorithm) {
+    }
+
+    void setAlgorithm(FusionAlgorithm algorithm) { method = algorithm; }
+    FusionAlgorithm algorithm() const { return method; }
+
+    // Madgwick's beta; 0.1 settles in a second or two and rides out vibration
+    void setMadgwickGain(float beta) { madgwickBeta = beta; }
+    void setMahonyGains(float kp, float ki) { mahonyKp = kp; mahonyKi = ki; }
+
+    // Off runs every lane through the portable kernel, for bench/fusion_bench.cpp
+    void setVectorized(bool enabled) { vectorized = enabled; }
+
+    // Returns the new vehicle's lane. Add every vehicle before queuing samples.
+    int addVehicle() {
+        const int vehicle = lanes++;
+        if (lanes > stride) {
+            stride += 4;
+            resize();
+        }
+        return vehicle;
+    }
+
+    int vehicleCount() const { return lanes; }
+
+    // Queues sample's raw IMU for vehicle. Returns the slot to read the
+    // result from after fuse(), or -1 if the sample has no raw IMU, fusion
+    // is off or the batch is full.
+    int add(int vehicle, const TelemetrySample &sample) {
+        if (method == FusionAlgorithm::Off || !sample.has(HORUS_FIELD_RAW_IMU)) return -1;
+        Lane &lane = laneState[vehicle];
+        if (lane.queued == maxBatch) return -1;
+
+        const float ax = sample.accel[0], ay = sample.accel[1], az = sample.accel[2];
+        if (!lane.started) {
+            if (ax == 0 && ay == 0 && az == 0) return -1;
+            startFromGravity(vehicle, ax, ay, az);
+            lane.started = true;
+        }
+
+        // The sender's clock when both samples carry it, arrival time otherwise
+        float dt = 0.0f;
+        if (lane.hasPrevious) {
+            if (sample.sensorTimeMs != 0 && lane.previousSensorTimeMs != 0) {
+                dt = static_cast<std::uint32_t>(sample.sensorTimeMs - lane.previousSensorTimeMs) / 1000.0f;
+            } else {
+                dt = (sample.timestampNs - lane.previousTimestampNs) / 1e9f;
+            }
+            if (dt <= 0.0f || dt > maxStepSeconds) dt = 0.0f;
+        }
+        lane.hasPrevious = true;
+        lane.previousSensorTimeMs = sample.sensorTimeMs;
+        lane.previousTimestampNs = sample.timestampNs;
+
+        const float radiansPerLsb = static_cast<float>(pi / 180.0) / HORUS_GYRO_LSB_PER_DPS;
+        const int slot = lane.queued++;
+        const std::size_t at = static_cast<std::size_t>(slot) * stride + vehicle;
+        input[Ax][at] = ax;
+        input[Ay][at] = ay;
+        input[Az][at] = az;
+        input[Gx][at] = sample.gyro[0] * radiansPerLsb;
+        input[Gy][at] = sample.gyro[1] * radiansPerLsb;
+        input[Gz][at] = sample.gyro[2] * radiansPerLsb;
+        input[Dt][at] = dt;
+        steps = std::max(steps, lane.queued);
+        return slot;
+    }
+
+    // Runs every queued sample; results stay readable until the next add()
+    void fuse() {
+        if (steps == 0) return;
+        if (vectorized) run<SimdFloat4>();
+        else run<ScalarFloat4>();
+
+        // Idle slots must read as dt = 0 next time
+        for (int channel = 0; channel < InputCount; channel++) {
+            std::fill(input[channel].begin(), input[channel].begin() + static_cast<std::size_t>(steps) * stride, 0.0f);
+        }
+        for (int vehicle = 0; vehicle < lanes; vehicle++) laneState[vehicle].queued = 0;
+        steps = 0;
+    }
+
+    // Attitude after the sample fuse() ran in slot
+    Attitude attitude(int vehicle, int slot) const {
+        const std::size_t at = static_cast<std::size_t>(slot) * stride + vehicle;
+        return toAttitude(output[0][at], output[1][at], output[2][at], output[3][at]);
+    }
+
+    // Puts the attitude fused in slot into sample, in place of the sender's.
+    // No-op for slot -1, so add()'s result can be passed straight through.
+    void apply(int vehicle, int slot, TelemetrySample &sample) const {
+        if (slot < 0) return;
+        const Attitude fused = attitude(vehicle, slot);
+        sample.pitch = fused.pitch;
+        sample.roll = fused.roll;
+        sample.yaw = fused.heading;
+        sample.fields |= HORUS_FIELD_ATTITUDE | HORUS_FIELD_FUSED;
+    }
+
+    // Latest fused attitude of vehicle
+    Attitude attitude(int vehicle) const {
+        const std::size_t at = static_cast<std::size_t>(vehicle);
+        return toAttitude(state[0][at], state[1][at], state[2][at], state[3][at]);
+    }
+
+    // Z-X-Y Euler angles of q (sensor to earth), matching the firmware's
+    // accelerometer angles: pitch = asin(ay/|a|), roll = atan2(-ax, az)
+    static Attitude toAttitude(float q0, float q1, float q2, float q3) {
+        constexpr double degrees = 180.0 / pi;
+        Attitude a;
+        const float sinPitch = std::clamp(2.0f * (q0 * q1 + q2 * q3), -1.0f, 1.0f);
+        a.pitch = static_cast<float>(std::asin(sinPitch) * degrees);
+        a.roll = static_cast<float>(std::atan2(2.0f * (q0 * q2 - q1 * q3), q0 * q0 - q1 * q1 - q2 * q2 + q3 * q3) * degrees);
+        // Yaw is counter-clockwise about the up axis, heading clockwise
+        const double yaw = std::atan2(2.0f * (q0 * q3 - q1 * q2), 1.0f - 2.0f * (q1 * q1 + q3 * q3)) * degrees;
+        a.heading = static_cast<float>(yaw <= 0.0 ? -yaw : 360.0 - yaw);
+        return a;
+    }
+
+private:
+    enum Input { Ax, Ay, Az, Gx, Gy, Gz, Dt, InputCount };
+
+    struct Lane {
+        int queued = 0;
+        bool started = false;
+        bool hasPrevious = false;
+        std::uint32_t previousSensorTimeMs = 0;
+        std::int64_t previousTimestampNs = 0;
+    };
+
+    // Storage is [slot][lane] for inputs and outputs, [lane] for the state
+    void resize() {
+        for (auto &channel : input) channel.assign(static_cast<std::size_t>(maxBatch) * stride, 0.0f);
+        for (auto &channel : output) channel.assign(static_cast<std::size_t>(maxBatch) * stride, 0.0f);
+        for (int c = 0; c < 4; c++) state[c].resize(stride, c == 0 ? 1.0f : 0.0f);
+        for (auto &channel : integral) channel.resize(stride, 0.0f);
+        laneState.resize(stride);
+    }
+
+    // Level attitude straight from the first accelerometer reading, so the
+    // filter does not spend its first seconds converging from identity
+    void startFromGravity(int vehicle, float ax, float ay, float az) {
+        const float norm = std::sqrt(ax * ax + ay * ay + az * az);
+        const float pitch = std::asin(std::clamp(ay / norm, -1.0f, 1.0f));
+        const float roll = std::atan2(-ax, az);
+        const float cp = std::cos(pitch / 2), sp = std::sin(pitch / 2);
+        const float cr = std::cos(roll / 2), sr = std::sin(roll / 2);
+        state[0][vehicle] = cp * cr;
+        state[1][vehicle] = sp * cr;
+        state[2][vehicle] = cp * sr;
+        state[3][vehicle] = sp * sr;
+    }
+
+    template <typename F>
+    void run() {
+        for (int group = 0; group < stride; group += 4) {
+            F q0 = F::load(&state[0][group]), q1 = F::load(&state[1][group]);
+            F q2 = F::load(&state[2][group]), q3 = F::load(&state[3][group]);
+            F ix = F::load(&integral[0][group]), iy = F::load(&integral[1][group]), iz = F::load(&integral[2][group]);
+
+            for (int slot = 0; slot < steps; slot++) {
+                const std::size_t at = static_cast<std::size_t>(slot) * stride + group;
+                const F ax = F::load(&input[Ax][at]), ay = F::load(&input[Ay][at]), az = F::load(&input[Az][at]);
+                const F gx = F::load(&input[Gx][at]), gy = F::load(&input[Gy][at]), gz = F::load(&input[Gz][at]);
+                const F dt = F::load(&input[Dt][at]);
+
+                if (method == FusionAlgorithm::Mahony) {
+                    mahonyStep(q0, q1, q2, q3, ix, iy, iz, ax, ay, az, gx, gy, gz, dt);
+                } else {
+                    madgwickStep(q0, q1, q2, q3, ax, ay, az, gx, gy, gz, dt);
+                }
+                q0.store(&output[0][at]);
+                q1.store(&output[1][at]);
+                q2.store(&output[2][at]);
+                q3.store(&output[3][at]);
+            }
+
+            q0.store(&state[0][group]);
+            q1.store(&state[1][group]);
+            q2.store(&state[2][group]);
+            q3.store(&state[3][group]);
+            ix.store(&integral[0][group]);
+            iy.store(&integral[1][group]);
+            iz.store(&integral[2][group]);
+        }
+    }
+
+    // Madgwick's IMU update (S. Madgwick, 2010). Lanes with no accelerometer
+    // reading integrate the gyro alone; lanes with dt = 0 stay where they are.
+    template <typename F>
+    void madgwickStep(F &q0, F &q1, F &q2, F &q3, F ax, F ay, F az, F gx, F gy, F gz, F dt) const {
+        const F half = 0.5f;
+        F qDot0 = half * (F(0.0f) - q1 * gx - q2 * gy - q3 * gz);
+        F qDot1 = half * (q0 * gx + q2 * gz - q3 * gy);
+        F qDot2 = half * (q0 * gy - q1 * gz + q3 * gx);
+        F qDot3 = half * (q0 * gz + q1 * gy - q2 * gx);
+
+        const F accelSquared = ax * ax + ay * ay + az * az;
+        const F accelNorm = inverseNorm(accelSquared);
+        ax = ax * accelNorm;
+        ay = ay * accelNorm;
+        az = az * accelNorm;
+
+        const F two = 2.0f, four = 4.0f, eight = 8.0f;
+        const F q0q0 = q0 * q0, q1q1 = q1 * q1, q2q2 = q2 * q2, q3q3 = q3 * q3;
+        const F s0 = four * q0 * q2q2 + two * q2 * ax + four * q0 * q1q1 - two * q1 * ay;
+        const F s1 = four * q1 * q3q3 - two * q3 * ax + four * q0q0 * q1 - two * q0 * ay - four * q1 +
+                     eight * q1 * q1q1 + eight * q1 * q2q2 + four * q1 * az;
+        const F s2 = four * q0q0 * q2 + two * q0 * ax + four * q2 * q3q3 - two * q3 * ay - four * q2 +
+                     eight * q2 * q1q1 + eight * q2 * q2q2 + four * q2 * az;
+        const F s3 = four * q1q1 * q3 - two * q1 * ax + four * q2q2 * q3 - two * q2 * ay;
+
+        // No correction without an accelerometer reading
+        const F stepNorm = selectPositive(accelSquared,
+                                          F(madgwickBeta) * inverseNorm(s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3),
+                                          F(0.0f));
+        qDot0 = qDot0 - stepNorm * s0;
+        qDot1 = qDot1 - stepNorm * s1;
+        qDot2 = qDot2 - stepNorm * s2;
+        qDot3 = qDot3 - stepNorm * s3;
+
+        q0 = q0 + qDot0 * dt;
+        q1 = q1 + qDot1 * dt;
+        q2 = q2 + qDot2 * dt;
+        q3 = q3 + qDot3 * dt;
+        normalise(q0, q1, q2, q3);
+    }
+
+    // Mahony's explicit complementary filter (R. Mahony et al., 2008)
+    template <typename F>
+    void mahonyStep(F &q0, F &q1, F &q2, F &q3, F &ix, F &iy, F &iz,
+                    F ax, F ay, F az, F gx, F gy, F gz, F dt) const {
+        const F accelSquared = ax * ax + ay * ay + az * az;
+        const F accelNorm = inverseNorm(accelSquared);
+        ax = ax * accelNorm;
+        ay = ay * accelNorm;
+        az = az * accelNorm;
+
+        // Gravity the attitude predicts, halved, and its error to the reading
+        const F halfVx = q1 * q3 - q0 * q2;
+        const F halfVy = q0 * q1 + q2 * q3;
+        const F halfVz = q0 * q0 - F(0.5f) + q3 * q3;
+        const F zero = 0.0f;
+        const F ex = selectPositive(accelSquared, ay * halfVz - az * halfVy, zero);
+        const F ey = selectPositive(accelSquared, az * halfVx - ax * halfVz, zero);
+        const F ez = selectPositive(accelSquared, ax * halfVy - ay * halfVx, zero);
+
+        const F twoKi = 2.0f * mahonyKi;
+        const F twoKp = 2.0f * mahonyKp;
+        ix = ix + twoKi * ex * dt;
+        iy = iy + twoKi * ey * dt;
+        iz = iz + twoKi * ez * dt;
+        gx = gx + ix + twoKp * ex;
+        gy = gy + iy + twoKp * ey;
+        gz = gz + iz + twoKp * ez;
+
+        const F halfDt = F(0.5f) * dt;
+        gx = gx * halfDt;
+        gy = gy * halfDt;
+        gz = gz * halfDt;
+        const F qa = q0, qb = q1, qc = q2;
+        q0 = q0 + (F(0.0f) - qb * gx - qc * gy - q3 * gz);
+        q1 = q1 + (qa * gx + qc * gz - q3 * gy);
+        q2 = q2 + (qa * gy - qb * gz + q3 * gx);
+        q3 = q3 + (qa * gz + qb * gy - qc * gx);
+        normalise(q0, q1, q2, q3);
+    }
+
+    template <typename F>
+    static void normalise(F &q0, F &q1, F &q2, F &q3) {
+        const F norm = inverseNorm(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
+        q0 = q0 * norm;
+        q1 = q1 * norm;
+        q2 = q2 * norm;
+        q3 = q3 * norm;
+    }
+
+    FusionAlgorithm method;
+    float madgwickBeta = 0.1f;
+    float mahonyKp = 0.5f;
+    float mahonyKi = 0.0f;
+    bool vectorized = true;
+
+    int lanes = 0;
+    int stride = 0;   // Lanes rounded up to whole registers
+    int steps = 0;    // Slots queued in the busiest lane
+    std::vector<float> input[InputCount];
+    std::vector<float> output[4];
+    std::vector<float> state[4];
+    std::vector<float> integral[3];
+    std::vector<Lane> laneState;
+};
+
+#endif // SENSORFUSION_H
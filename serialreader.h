@@ -0,0 +1,456 @@
+#ifndef SERIALREADER_H
+#define SERIALREADER_H
+
+#include <QObject>
+#include <QIODevice>
+#include <QSerialPort>
+#include <QString>
+#include <QTimer>
+#include <QDebug>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include "flightrecorder.h"
+#include "framedecoder.h"
+#include "lineparser.h"
+#include "mavlinkdecoder.h"
+#include "portdiscovery.h"
+#include "telemetrysample.h"
+#include "telemetryserver.h"
+
+// Owns the QSerialPort and runs on its own QThread, so a slow paint can't
+// stall ingest and a burst of serial data can't stall painting.
+// Parsed samples are pushed into a SampleRing that the display drains.
+//
+// The link survives the port going away: on an error the port is closed and
+// reopened, retrying every minRetryIntervalMs, backing off to
+// maxRetryIntervalMs, so a replugged bridge is back within about a second
+// without the display thread ever waiting on it.
+//
+// A discovered port is also watched for hotplug, every hotplugPollMs: one
+// unplugged without an error from the driver is let go within that time, and
+// a matching bridge plugged in while it is connected takes over once it has
+// been silent for silentLinkMs.
+class SerialReader : public QObject {
+    Q_OBJECT
+
+public:
+    // Most comma-separated fields accepted on one line
+    static constexpr int maxFields = 16;
+
+    static constexpr int minRetryIntervalMs = 100;
+    static constexpr int maxRetryIntervalMs = 1000;  // Bounds the recovery time after a replug
+    static constexpr int hotplugPollMs = 1000;
+    static constexpr int silentLinkMs = 2000;
+
+    explicit SerialReader(SampleRing &ring, QObject *parent = nullptr)
+    : QObject(parent), sampleRing(ring), usbIds(portdiscovery::knownBridges()) {
+    }
+
+    // CSV text lines, binary frames (firmware/horus_protocol.h) or an
+    // autopilot's MAVLink v2. Auto leaves CSV on the first byte text never
+    // has (0x00 or the MAVLink start byte), then takes whichever decoder
+    // accepts a frame first. If neither has within textFallbackBytes while
+    // complete CSV lines keep parsing, the byte was line noise and Auto goes
+    // back to CSV. Every new link starts over from the format set.
+    enum class WireFormat { Auto, Csv, Binary, Mavlink };
+
+    static constexpr std::size_t textFallbackBytes = 512;
+    static constexpr int minTextLines = 2;
+
+    // Call before openPort(). Empty, the default, takes the first port with
+    // one of the USB bridges in setUsbIds(), whichever is plugged in now.
+    void setPortName(const QString &name) {
+        portName = name;
+    }
+
+    void setUsbIds(const QList<UsbSerialId> &ids) {
+        usbIds = ids;
+    }
+
+    // Call before openPort(); 115200 by default
+    void setBaudRate(qint32 baud) {
+        baudRate = baud;
+    }
+
+    void setWireFormat(WireFormat format) {
+        configuredFormat = wireFormat = format;
+        detecting = false;
+    }
+
+    // Copies every sample, and the raw bytes if the channel asks for them,
+    // to the flight recorder. Call before openPort(); nullptr turns it off.
+    void setRecorder(FlightRecorder::Channel *channel) {
+        recorder = channel;
+    }
+
+    // Republishes every sample to other displays and tools (telemetryserver.h).
+    // Call before openPort(); nullptr turns it off.
+    void setServer(TelemetryServer *telemetryServer) {
+        server = telemetryServer;
+    }
+
+    // Binary link health; only meaningful on the reader thread
+    const FrameDecoder &decoder() const { return frameDecoder; }
+    const MavlinkDecoder &mavlink() const { return mavlinkDecoder; }
+
+    // Text link health; only meaningful on the reader thread
+    std::uint64_t badLineCount() const { return badLines; }
+    std::uint64_t lineOverflowCount() const { return lineBuffer.overflowCount(); }
+
+    // Link recovery; any thread. Time to data runs from opening the port to
+    // the first sample decoded from it; the outage from losing the previous
+    // link to that same sample.
+    std::uint32_t reconnectCount() const { return reconnects.load(std::memory_order_relaxed); }
+    std::int64_t lastTimeToDataNs() const { return timeToDataNs.load(std::memory_order_relaxed); }
+    std::int64_t lastOutageNs() const { return outageNs.load(std::memory_order_relaxed); }
+
+    // Decodes everything device has buffered. readyRead lands here; the
+    // ingest benchmark and fuzzer drive it with their own devices.
+    void ingest(QIODevice *device) {
+        const std::int64_t arrivedNs = monotonicNowNs();
+
+        for (;;) {
+            if (wireFormat != WireFormat::Auto && wireFormat != WireFormat::Csv) {
+                qint64 bytesRead = device->read(reinterpret_cast<char *>(readChunk), sizeof(readChunk));
+                if (bytesRead <= 0) break;
+                recordRaw(readChunk, bytesRead, arrivedNs);
+                if (detecting) scanText(reinterpret_cast<const char *>(readChunk), static_cast<std::size_t>(bytesRead));
+                decodeBinary(readChunk, static_cast<std::size_t>(bytesRead), arrivedNs);
+                continue;
+            }
+
+            // Read straight into the ring; lines are parsed in place
+            std::size_t available;
+            char *span = lineBuffer.writeSpan(available);
+            qint64 bytesRead = device->read(span, static_cast<qint64>(available));
+            if (bytesRead <= 0) break;
+            recordRaw(span, bytesRead, arrivedNs);
+
+            if (wireFormat == WireFormat::Auto && !isText(span, static_cast<std::size_t>(bytesRead))) {
+                // Both binary formats from here on, until one of them decodes a
+                // frame or the text carries on regardless
+                wireFormat = WireFormat::Binary;
+                detecting = true;
+                detectedBytes = 0;
+                detectedTextLines = 0;
+                framesBeforeDetecting = frameDecoder.frameCount();
+                messagesBeforeDetecting = mavlinkDecoder.messageCount();
+                frameDecoder.reset();
+                mavlinkDecoder.reset();
+                lineBuffer.clear();
+                lineBuffer.commitWrite(static_cast<std::size_t>(bytesRead));
+                countTextLines(static_cast<std::size_t>(bytesRead));
+                decodeBinary(reinterpret_cast<const std::uint8_t *>(span), static_cast<std::size_t>(bytesRead), arrivedNs);
+                continue;
+            }
+
+            lineBuffer.commitWrite(static_cast<std::size_t>(bytesRead));
+            lineBuffer.consumeLines([&](const char *begin, const char *end) {
+                parseSerialLine(begin, end, arrivedNs);
+            });
+        }
+    }
+
+public slots:
+    // Must run on the reader thread so the port's notifier lives there too.
+    // Keeps the link up from then on; linkChanged() reports the first
+    // attempt either way, then every change.
+    void openPort() {
+        if (!retryTimer) {
+            retryTimer = new QTimer(this);
+            retryTimer->setSingleShot(true);
+            connect(retryTimer, &QTimer::timeout, this, &SerialReader::connectPort);
+            hotplugTimer = new QTimer(this);
+            connect(hotplugTimer, &QTimer::timeout, this, &SerialReader::watchPorts);
+        }
+        linkLostNs = 0;
+        reported = false;
+        retryIntervalMs = minRetryIntervalMs;
+        connectPort();
+    }
+
+    // Stops retrying, and reading
+    void closePort() {
+        if (retryTimer) retryTimer->stop();
+        releasePort();
+    }
+
+signals:
+    // port is the device opened or lost; empty when none was found
+    void linkChanged(bool up, const QString &port);
+
+    // The first sample from a newly opened port; outageNs is 0 on the first link
+    void dataResumed(qint64 timeToDataNs, qint64 outageNs);
+
+private slots:
+    void readSerialData() {
+        ingest(serialPort);
+    }
+
+    void connectPort() {
+        const QString name = portName.isEmpty() ? portdiscovery::findPort(usbIds) : portName;
+        if (!name.isEmpty() && openDevice(name)) {
+            linkEstablished();
+            return;
+        }
+        if (!reported) {
+            reported = true;
+            emit linkChanged(false, name);
+        }
+        retryTimer->start(retryIntervalMs);
+        retryIntervalMs = std::min(2 * retryIntervalMs, maxRetryIntervalMs);
+    }
+
+    void onPortError(QSerialPort::SerialPortError error) {
+        // Timeouts only concern blocking calls, which the reader never makes
+        if (error == QSerialPort::NoError || error == QSerialPort::TimeoutError || !serialPort) return;
+        qWarning() << "Lost" << openedPort << "-" << serialPort->errorString();
+        loseLink();
+        retryTimer->start(retryIntervalMs);
+    }
+
+    // Discovered ports only; see the class comment
+    void watchPorts() {
+        if (!serialPort) return;
+        const QStringList present = portdiscovery::findPorts(usbIds);
+        for (const QString &port : present) {
+            if (port != openedPort && !knownPorts.contains(port)) {
+                qDebug() << "Serial bridge plugged in at" << port;
+                pluggedIn.append(port);
+            }
+        }
+        pluggedIn.erase(std::remove_if(pluggedIn.begin(), pluggedIn.end(),
+                                       [&present](const QString &port) { return !present.contains(port); }),
+                        pluggedIn.end());
+        knownPorts = present;
+
+        if (!present.contains(openedPort)) {
+            qWarning() << "Lost" << openedPort << "- unplugged";
+            loseLink();
+            connectPort();
+            return;
+        }
+
+        // Only to a bridge plugged in since this link came up, newest first,
+        // so two silent ones are not taken in turns
+        if (pluggedIn.isEmpty() || monotonicNowNs() - lastDataNs < silentLinkMs * 1'000'000LL) return;
+        const QString next = pluggedIn.takeLast();
+        qWarning() << "No data from" << openedPort << "for" << silentLinkMs << "ms - trying" << next;
+        loseLink();
+        if (openDevice(next)) linkEstablished();
+        else retryTimer->start(retryIntervalMs);
+    }
+
+private:
+    void linkEstablished() {
+        retryIntervalMs = minRetryIntervalMs;
+        reported = true;
+        if (portName.isEmpty()) {
+            knownPorts = portdiscovery::findPorts(usbIds);
+            pluggedIn.clear();
+            hotplugTimer->start(hotplugPollMs);
+        }
+        emit linkChanged(true, openedPort);
+    }
+
+    void loseLink() {
+        releasePort();
+        linkLostNs = monotonicNowNs();
+        emit linkChanged(false, openedPort);
+        retryIntervalMs = minRetryIntervalMs;
+    }
+
+    bool openDevice(const QString &name) {
+        serialPort = new QSerialPort(this);
+        serialPort->setPortName(name);
+        serialPort->setBaudRate(baudRate);
+        serialPort->setDataBits(QSerialPort::Data8);
+        serialPort->setParity(QSerialPort::NoParity);
+        serialPort->setStopBits(QSerialPort::OneStop);
+        serialPort->setFlowControl(QSerialPort::NoFlowControl);
+
+        if (!serialPort->open(QIODevice::ReadOnly)) {
+            delete serialPort;
+            serialPort = nullptr;
+            return false;
+        }
+        // A new link starts mid-line or mid-frame, with a new sequence, and
+        // maybe other firmware
+        lineBuffer.clear();
+        frameDecoder.reset();
+        mavlinkDecoder.reset();
+        wireFormat = configuredFormat;
+        detecting = false;
+        openedPort = name;
+        openedNs = monotonicNowNs();
+        lastDataNs = openedNs;
+        awaitingData = true;
+        connect(serialPort, &QSerialPort::readyRead, this, &SerialReader::readSerialData);
+        connect(serialPort, &QSerialPort::errorOccurred, this, &SerialReader::onPortError);
+        return true;
+    }
+
+    void releasePort() {
+        if (hotplugTimer) hotplugTimer->stop();
+        if (!serialPort) return;
+        // May be inside one of the port's own signals
+        serialPort->disconnect(this);
+        serialPort->close();
+        serialPort->deleteLater();
+        serialPort = nullptr;
+        awaitingData = false;
+    }
+
+    // First sample off a newly opened port
+    void noteDataResumed(std::int64_t nowNs) {
+        awaitingData = false;
+        const std::int64_t toData = nowNs - openedNs;
+        const std::int64_t outage = linkLostNs ? nowNs - linkLostNs : 0;
+        timeToDataNs.store(toData, std::memory_order_relaxed);
+        if (linkLostNs) {
+            outageNs.store(outage, std::memory_order_relaxed);
+            reconnects.fetch_add(1, std::memory_order_relaxed);
+        }
+        emit dataResumed(toData, outage);
+    }
+
+    // CSV columns: pitch,roll[,more fields...]
+    void parseSerialLine(const char *begin, const char *end, std::int64_t arrivedNs) {
+        while (begin != end && lineparser::isSpace(*begin)) ++begin;
+        if (begin == end) return;
+
+        float fields[maxFields];
+        int count = lineparser::parseFields(begin, end, fields, maxFields);
+
+        if (count >= 2) {
+            TelemetrySample sample;
+            sample.timestampNs = arrivedNs;
+            sample.pitch = fields[0];  // REAL pitch from MPU6050
+            sample.roll = fields[1];   // REAL roll from MPU6050
+            sample.fields = HORUS_FIELD_ATTITUDE;
+            sample.parsedNs = monotonicNowNs();
+            publish(sample);
+        } else {
+            badLines++;
+            // A noisy link must not turn into a log flood
+            if (badLines <= 10 || badLines % 1000 == 0) {
+                qWarning() << "Invalid data format:" << QLatin1String(begin, end - begin)
+                           << "(" << badLines << "bad lines so far)";
+            }
+        }
+    }
+
+    // Text never contains 0x00, Horus frames always end with it, and every
+    // MAVLink v2 frame starts with 0xFD
+    static bool isText(const char *data, std::size_t length) {
+        return !std::memchr(data, 0, length) && !std::memchr(data, mavlink::stx, length);
+    }
+
+    // While detecting: the same bytes as text, so a CSV link that merely had
+    // a stray byte can be told from a binary one
+    void scanText(const char *data, std::size_t length) {
+        while (length > 0) {
+            std::size_t available;
+            char *span = lineBuffer.writeSpan(available);
+            const std::size_t bytes = std::min(available, length);
+            std::memcpy(span, data, bytes);
+            lineBuffer.commitWrite(bytes);
+            countTextLines(bytes);
+            data += bytes;
+            length -= bytes;
+        }
+    }
+
+    // Lines parsed here are only counted, not published
+    void countTextLines(std::size_t bytes) {
+        detectedBytes += bytes;
+        lineBuffer.consumeLines([this](const char *begin, const char *end) {
+            float fields[maxFields];
+            if (lineparser::parseFields(begin, end, fields, maxFields) >= 2) detectedTextLines++;
+        });
+    }
+
+    void decodeBinary(const std::uint8_t *data, std::size_t length, std::int64_t arrivedNs) {
+        const auto stamp = [this](const TelemetrySample &sample) {
+            TelemetrySample stamped = sample;
+            stamped.parsedNs = monotonicNowNs();
+            publish(stamped);
+        };
+        if (!detecting) {
+            if (wireFormat == WireFormat::Mavlink) mavlinkDecoder.feed(data, length, arrivedNs, stamp);
+            else frameDecoder.feed(data, length, arrivedNs, stamp);
+            return;
+        }
+        // A good frame in either format settles it: a CRC of random bytes
+        // passes once in 65536
+        mavlinkDecoder.feed(data, length, arrivedNs, stamp);
+        if (mavlinkDecoder.messageCount() > messagesBeforeDetecting) {
+            wireFormat = WireFormat::Mavlink;
+            detecting = false;
+            lineBuffer.clear();
+            return;
+        }
+        frameDecoder.feed(data, length, arrivedNs, stamp);
+        if (frameDecoder.frameCount() > framesBeforeDetecting) {
+            detecting = false;
+            lineBuffer.clear();
+        } else if (detectedBytes >= textFallbackBytes && detectedTextLines >= minTextLines) {
+            // No frame, but lines: text after all
+            wireFormat = WireFormat::Auto;
+            detecting = false;
+        }
+    }
+
+    void publish(const TelemetrySample &sample) {
+        if (awaitingData) noteDataResumed(sample.parsedNs);
+        lastDataNs = sample.parsedNs;
+        sampleRing.push(sample);
+        if (recorder) recorder->record(sample);
+        if (server) server->publish(sample);
+    }
+
+    void recordRaw(const void *data, qint64 length, std::int64_t arrivedNs) {
+        if (recorder && recorder->recordsRawBytes()) {
+            recorder->recordRaw(data, static_cast<std::size_t>(length), arrivedNs);
+        }
+    }
+
+    SampleRing &sampleRing;
+    FlightRecorder::Channel *recorder = nullptr;
+    TelemetryServer *server = nullptr;
+    QString portName;  // Empty: discover, see portdiscovery.h
+    QList<UsbSerialId> usbIds;
+    qint32 baudRate = QSerialPort::Baud115200;
+    WireFormat configuredFormat = WireFormat::Auto;
+    WireFormat wireFormat = WireFormat::Auto;  // Settled by Auto as the link goes
+    QSerialPort *serialPort = nullptr;
+
+    // Reconnection, see connectPort()
+    QTimer *retryTimer = nullptr;
+    QTimer *hotplugTimer = nullptr;
+    QStringList knownPorts;       // Matching bridges at the last watchPorts()
+    QStringList pluggedIn;        // Of those, the ones that arrived since the link came up
+    std::int64_t lastDataNs = 0;  // Last sample from the open port
+    int retryIntervalMs = minRetryIntervalMs;
+    bool reported = false;        // linkChanged() sent for the first attempt
+    bool awaitingData = false;    // Opened, no sample yet
+    QString openedPort;
+    std::int64_t openedNs = 0;
+    std::int64_t linkLostNs = 0;  // 0 until a link has been lost
+    std::atomic<std::uint32_t> reconnects{0};
+    std::atomic<std::int64_t> timeToDataNs{0};
+    std::atomic<std::int64_t> outageNs{0};
+    LineBuffer lineBuffer;
+    FrameDecoder frameDecoder;
+    MavlinkDecoder mavlinkDecoder;
+    bool detecting = false;  // Auto: binary, but which kind is not known yet
+    std::size_t detectedBytes = 0;
+    int detectedTextLines = 0;
+    std::uint64_t framesBeforeDetecting = 0;  // The counts are per reader, not per link
+    std::uint64_t messagesBeforeDetecting = 0;
+    std::uint8_t readChunk[1024];
+    std::uint64_t badLines = 0;
+};
+
+#endif // SERIALREADER_H
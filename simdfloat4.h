@@ -0,0 +1,192 @@
+#ifndef SIMDFLOAT4_H
+#define SIMDFLOAT4_H
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if !defined(HORUS_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define HORUS_SIMD_SSE 1
+#include <emmintrin.h>
+#elif !defined(HORUS_NO_SIMD) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#define HORUS_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+// Four floats, one per lane: a vehicle in sensorfusion.h, a sample in
+// airdata.h. The portable version is what the SIMD ones compute, lane by lane.
+struct ScalarFloat4 {
+    float v[4];
+
+    ScalarFloat4() = default;
+    ScalarFloat4(float x) { v[0] = v[1] = v[2] = v[3] = x; }
+
+    static ScalarFloat4 load(const float *p) { ScalarFloat4 r; std::memcpy(r.v, p, sizeof(r.v)); return r; }
+    void store(float *p) const { std::memcpy(p, v, sizeof(v)); }
+
+    friend ScalarFloat4 operator+(ScalarFloat4 a, ScalarFloat4 b) { for (int i = 0; i < 4; i++) a.v[i] += b.v[i]; return a; }
+    friend ScalarFloat4 operator-(ScalarFloat4 a, ScalarFloat4 b) { for (int i = 0; i < 4; i++) a.v[i] -= b.v[i]; return a; }
+    friend ScalarFloat4 operator*(ScalarFloat4 a, ScalarFloat4 b) { for (int i = 0; i < 4; i++) a.v[i] *= b.v[i]; return a; }
+    friend ScalarFloat4 operator/(ScalarFloat4 a, ScalarFloat4 b) { for (int i = 0; i < 4; i++) a.v[i] /= b.v[i]; return a; }
+
+    // 1/sqrt(x) where x > 0, otherwise 0
+    friend ScalarFloat4 inverseNorm(ScalarFloat4 a) {
+        for (int i = 0; i < 4; i++) a.v[i] = a.v[i] > 0.0f ? 1.0f / std::sqrt(a.v[i]) : 0.0f;
+        return a;
+    }
+
+    // Lanes where cond > 0 take a, the rest b
+    friend ScalarFloat4 selectPositive(ScalarFloat4 cond, ScalarFloat4 a, ScalarFloat4 b) {
+        for (int i = 0; i < 4; i++) a.v[i] = cond.v[i] > 0.0f ? a.v[i] : b.v[i];
+        return a;
+    }
+
+    // Normal x > 0 as mantissa * 2^exponent, mantissa in [1, 2)
+    friend void splitExponent(ScalarFloat4 x, ScalarFloat4 &mantissa, ScalarFloat4 &exponent) {
+        for (int i = 0; i < 4; i++) {
+            std::int32_t bits;
+            std::memcpy(&bits, &x.v[i], sizeof(bits));
+            exponent.v[i] = static_cast<float>((bits >> 23) - 127);
+            bits = (bits & 0x7FFFFF) | 0x3F800000;
+            std::memcpy(&mantissa.v[i], &bits, sizeof(bits));
+        }
+    }
+
+    // x * 2^n for whole n, where the result stays a normal float
+    friend ScalarFloat4 scaleByPowerOfTwo(ScalarFloat4 x, ScalarFloat4 n) {
+        for (int i = 0; i < 4; i++) {
+            std::int32_t bits;
+            std::memcpy(&bits, &x.v[i], sizeof(bits));
+            bits += static_cast<std::int32_t>(n.v[i]) * (1 << 23);
+            std::memcpy(&x.v[i], &bits, sizeof(bits));
+        }
+        return x;
+    }
+};
+
+#if HORUS_SIMD_SSE
+struct SimdFloat4 {
+    __m128 v;
+
+    SimdFloat4() = default;
+    SimdFloat4(__m128 x) : v(x) {}
+    SimdFloat4(float x) : v(_mm_set1_ps(x)) {}
+
+    static SimdFloat4 load(const float *p) { return _mm_loadu_ps(p); }
+    void store(float *p) const { _mm_storeu_ps(p, v); }
+
+    friend SimdFloat4 operator+(SimdFloat4 a, SimdFloat4 b) { return _mm_add_ps(a.v, b.v); }
+    friend SimdFloat4 operator-(SimdFloat4 a, SimdFloat4 b) { return _mm_sub_ps(a.v, b.v); }
+    friend SimdFloat4 operator*(SimdFloat4 a, SimdFloat4 b) { return _mm_mul_ps(a.v, b.v); }
+    friend SimdFloat4 operator/(SimdFloat4 a, SimdFloat4 b) { return _mm_div_ps(a.v, b.v); }
+
+    // Exact division rather than _mm_rsqrt_ps: 12 bits are not enough to
+    // keep a quaternion on the unit sphere over thousands of steps
+    friend SimdFloat4 inverseNorm(SimdFloat4 a) {
+        const __m128 positive = _mm_cmpgt_ps(a.v, _mm_setzero_ps());
+        const __m128 inverse = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(a.v));
+        return _mm_and_ps(positive, inverse);
+    }
+
+    friend SimdFloat4 selectPositive(SimdFloat4 cond, SimdFloat4 a, SimdFloat4 b) {
+        const __m128 mask = _mm_cmpgt_ps(cond.v, _mm_setzero_ps());
+        return _mm_or_ps(_mm_and_ps(mask, a.v), _mm_andnot_ps(mask, b.v));
+    }
+
+    friend void splitExponent(SimdFloat4 x, SimdFloat4 &mantissa, SimdFloat4 &exponent) {
+        const __m128i bits = _mm_castps_si128(x.v);
+        exponent = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127)));
+        mantissa = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x7FFFFF)),
+                                                 _mm_set1_epi32(0x3F800000)));
+    }
+
+    friend SimdFloat4 scaleByPowerOfTwo(SimdFloat4 x, SimdFloat4 n) {
+        const __m128i shift = _mm_slli_epi32(_mm_cvttps_epi32(n.v), 23);
+        return _mm_castsi128_ps(_mm_add_epi32(_mm_castps_si128(x.v), shift));
+    }
+};
+#elif HORUS_SIMD_NEON
+struct SimdFloat4 {
+    float32x4_t v;
+
+    SimdFloat4() = default;
+    SimdFloat4(float32x4_t x) : v(x) {}
+    SimdFloat4(float x) : v(vdupq_n_f32(x)) {}
+
+    static SimdFloat4 load(const float *p) { return vld1q_f32(p); }
+    void store(float *p) const { vst1q_f32(p, v); }
+
+    friend SimdFloat4 operator+(SimdFloat4 a, SimdFloat4 b) { return vaddq_f32(a.v, b.v); }
+    friend SimdFloat4 operator-(SimdFloat4 a, SimdFloat4 b) { return vsubq_f32(a.v, b.v); }
+    friend SimdFloat4 operator*(SimdFloat4 a, SimdFloat4 b) { return vmulq_f32(a.v, b.v); }
+
+    // ARMv7 NEON has no divide: estimate plus two Newton-Raphson steps
+    friend SimdFloat4 operator/(SimdFloat4 a, SimdFloat4 b) {
+#if defined(__aarch64__)
+        return vdivq_f32(a.v, b.v);
+#else
+        float32x4_t inverse = vrecpeq_f32(b.v);
+        inverse = vmulq_f32(inverse, vrecpsq_f32(b.v, inverse));
+        inverse = vmulq_f32(inverse, vrecpsq_f32(b.v, inverse));
+        return vmulq_f32(a.v, inverse);
+#endif
+    }
+
+    // Estimate plus two Newton-Raphson steps: full float precision
+    friend SimdFloat4 inverseNorm(SimdFloat4 a) {
+        float32x4_t estimate = vrsqrteq_f32(a.v);
+        estimate = vmulq_f32(estimate, vrsqrtsq_f32(vmulq_f32(a.v, estimate), estimate));
+        estimate = vmulq_f32(estimate, vrsqrtsq_f32(vmulq_f32(a.v, estimate), estimate));
+        const uint32x4_t positive = vcgtq_f32(a.v, vdupq_n_f32(0.0f));
+        return vreinterpretq_f32_u32(vandq_u32(positive, vreinterpretq_u32_f32(estimate)));
+    }
+
+    friend SimdFloat4 selectPositive(SimdFloat4 cond, SimdFloat4 a, SimdFloat4 b) {
+        return vbslq_f32(vcgtq_f32(cond.v, vdupq_n_f32(0.0f)), a.v, b.v);
+    }
+
+    friend void splitExponent(SimdFloat4 x, SimdFloat4 &mantissa, SimdFloat4 &exponent) {
+        const int32x4_t bits = vreinterpretq_s32_f32(x.v);
+        exponent = vcvtq_f32_s32(vsubq_s32(vshrq_n_s32(bits, 23), vdupq_n_s32(127)));
+        mantissa = vreinterpretq_f32_s32(vorrq_s32(vandq_s32(bits, vdupq_n_s32(0x7FFFFF)),
+                                                   vdupq_n_s32(0x3F800000)));
+    }
+
+    friend SimdFloat4 scaleByPowerOfTwo(SimdFloat4 x, SimdFloat4 n) {
+        const int32x4_t shift = vshlq_n_s32(vcvtq_s32_f32(n.v), 23);
+        return vreinterpretq_f32_s32(vaddq_s32(vreinterpretq_s32_f32(x.v), shift));
+    }
+};
+#else
+using SimdFloat4 = ScalarFloat4;
+#endif
+
+// log2(x) for normal x > 0, to about 1e-7. The mantissa is taken into
+// [sqrt(1/2), sqrt(2)), where five terms of the atanh series suffice.
+template <typename F>
+F laneLog2(F x) {
+    F mantissa, exponent;
+    splitExponent(x, mantissa, exponent);
+    const F high = mantissa - F(1.41421356f);
+    mantissa = selectPositive(high, mantissa * F(0.5f), mantissa);
+    exponent = selectPositive(high, exponent + F(1.0f), exponent);
+
+    const F t = (mantissa - F(1.0f)) / (mantissa + F(1.0f));
+    const F t2 = t * t;
+    const F series = F(1.0f) + t2 * (F(1.0f / 3) + t2 * (F(1.0f / 5) + t2 * (F(1.0f / 7) + t2 * F(1.0f / 9))));
+    return exponent + t * series * F(2.88539008f);  // 2 / ln 2
+}
+
+// 2^y for |y| < 126, to about 1e-7: a whole power of two times a Taylor
+// series over the remainder in [-1/2, 1/2]
+template <typename F>
+F laneExp2(F y) {
+    // Adding and taking away 1.5 * 2^23 rounds to the nearest whole number
+    const F whole = (y + F(12582912.0f)) - F(12582912.0f);
+    const F x = (y - whole) * F(0.693147181f);  // ln 2
+    const F series = F(1.0f) + x * (F(1.0f) + x * (F(1.0f / 2) + x * (F(1.0f / 6) + x * (F(1.0f / 24) +
+                     x * (F(1.0f / 120) + x * (F(1.0f / 720) + x * F(1.0f / 5040)))))));
+    return scaleByPowerOfTwo(series, whole);
+}
+
+#endif // SIMDFLOAT4_H
@@ -0,0 +1,86 @@
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Bounded single-producer/single-consumer ring.
+// The producer never blocks: when the ring is full it evicts the oldest entry,
+// so the newest sample always gets through and memory stays fixed.
+template <typename T, std::size_t Capacity>
+class SpscRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "SpscRing capacity must be a power of two");
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "SpscRing entries are copied with memcpy");
+
+public:
+    // Producer side
+    void push(const T &value) {
+        std::size_t h = head.load(std::memory_order_relaxed);
+        std::size_t t = tail.load(std::memory_order_acquire);
+
+        if (h - t == Capacity) {
+            // Full: claim the oldest slot. If the consumer took it first the CAS
+            // fails and the slot is free anyway.
+            if (tail.compare_exchange_strong(t, t + 1, std::memory_order_acq_rel,
+                                             std::memory_order_acquire)) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        std::memcpy(&cells[h & Mask], &value, sizeof(T));
+        head.store(h + 1, std::memory_order_release);
+    }
+
+    // Consumer side
+    bool pop(T &out) {
+        std::size_t t = tail.load(std::memory_order_acquire);
+        for (;;) {
+            std::size_t h = head.load(std::memory_order_acquire);
+            if (t == h) return false;
+
+            // The producer may be overwriting this slot after an eviction; the
+            // copy only counts if tail is still ours afterwards.
+            T value;
+            std::memcpy(&value, &cells[t & Mask], sizeof(T));
+            if (tail.compare_exchange_weak(t, t + 1, std::memory_order_acq_rel,
+                                           std::memory_order_acquire)) {
+                out = value;
+                return true;
+            }
+        }
+    }
+
+    // Pops everything queued and keeps only the newest entry.
+    // Returns how many entries were popped (0 if the ring was empty).
+    std::size_t drainLatest(T &out) {
+        std::size_t count = 0;
+        while (pop(out)) count++;
+        return count;
+    }
+
+    std::size_t size() const {
+        std::size_t t = tail.load(std::memory_order_acquire);
+        std::size_t h = head.load(std::memory_order_acquire);
+        return h - t;
+    }
+
+    static constexpr std::size_t capacity() { return Capacity; }
+
+    // Entries evicted by the producer because the consumer fell behind
+    std::uint64_t droppedCount() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr std::size_t Mask = Capacity - 1;
+
+    alignas(64) std::atomic<std::size_t> head{0};
+    alignas(64) std::atomic<std::size_t> tail{0};
+    alignas(64) std::atomic<std::uint64_t> dropped{0};
+    T cells[Capacity];
+};
+
+#endif // SPSCRING_H
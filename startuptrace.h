@@ -0,0 +1,138 @@
+#ifndef STARTUPTRACE_H
+#define STARTUPTRACE_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include "telemetrysample.h"
+#ifdef __linux__
+#include <ctime>
+#include <unistd.h>
+#endif
+
+// Where a launch spends its time before the PFD shows anything. Each phase
+// is marked once, the first time it is reached, on the steady clock of
+// monotonicNowNs(); times are reported from process start. On Linux that is
+// the exec() of the process, from /proc/self/stat at clock tick resolution
+// (10 ms), so loading the Qt libraries counts; elsewhere it is static
+// initialisation. Any thread may mark a phase.
+class StartupTrace {
+public:
+    enum Phase {
+        ProcessStart,
+        ApplicationReady,  // QApplication constructed, options parsed
+        WindowShown,       // Constructed and shown, not yet painted
+        FirstFrame,        // First PFD paintEvent() finished
+        FontsLoaded,       // Instrument fonts from the resources
+        CachesWarm,        // Glyph atlases, static layer and ladder for those fonts
+        PortOpened,        // Serial port open
+        FirstSample,       // First sample decoded from it
+        PhaseCount
+    };
+
+    static const char *phaseName(int phase) {
+        static const char *const names[PhaseCount] = {
+            "process start", "application ready", "window shown", "first frame",
+            "fonts loaded", "caches warm", "port opened", "first sample"
+        };
+        return names[phase];
+    }
+
+    static StartupTrace &instance() {
+        static StartupTrace trace;
+        return trace;
+    }
+
+    // False if the phase was already reached; the first time counts
+    bool mark(Phase phase, std::int64_t nowNs = monotonicNowNs()) {
+        std::int64_t expected = 0;
+        return reachedNs[phase].compare_exchange_strong(expected, nowNs, std::memory_order_relaxed);
+    }
+
+    // -1 until the phase is reached
+    std::int64_t sinceStartNs(Phase phase) const {
+        const std::int64_t at = reachedNs[phase].load(std::memory_order_relaxed);
+        return at ? at - reachedNs[ProcessStart].load(std::memory_order_relaxed) : -1;
+    }
+
+    // One line per phase, in the order they were reached; the ones not
+    // reached last, as "-"
+    void writeReport(std::FILE *file) const {
+        for (int phase : orderReached()) {
+            const std::int64_t ns = sinceStartNs(static_cast<Phase>(phase));
+            if (ns < 0) std::fprintf(file, "%-18s        -\n", phaseName(phase));
+            else std::fprintf(file, "%-18s %8.1f ms\n", phaseName(phase), ns / 1e6);
+        }
+    }
+
+    // "application ready 41.2 ms, window shown 63.0 ms, ...", reached phases only
+    std::string summary() const {
+        std::string text;
+        char item[64];
+        for (int phase : orderReached()) {
+            const std::int64_t ns = sinceStartNs(static_cast<Phase>(phase));
+            if (phase == ProcessStart || ns < 0) continue;
+            std::snprintf(item, sizeof(item), "%s%s %.1f ms", text.empty() ? "" : ", ", phaseName(phase), ns / 1e6);
+            text += item;
+        }
+        return text;
+    }
+
+private:
+    StartupTrace() {
+        const std::int64_t nowNs = monotonicNowNs();
+        reachedNs[ProcessStart].store(nowNs - processAgeNs(), std::memory_order_relaxed);
+    }
+
+    std::array<int, PhaseCount> orderReached() const {
+        std::array<int, PhaseCount> order;
+        for (int i = 0; i < PhaseCount; i++) order[i] = i;
+        std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+            const std::int64_t atA = reachedNs[a].load(std::memory_order_relaxed);
+            const std::int64_t atB = reachedNs[b].load(std::memory_order_relaxed);
+            if (!atA || !atB) return atA && !atB;
+            return atA < atB;
+        });
+        return order;
+    }
+
+    // How long ago exec() was; 0 where that is not known
+    static std::int64_t processAgeNs() {
+#ifdef __linux__
+        std::FILE *file = std::fopen("/proc/self/stat", "r");
+        if (!file) return 0;
+        char stat[1024];
+        const std::size_t length = std::fread(stat, 1, sizeof(stat) - 1, file);
+        std::fclose(file);
+        stat[length] = '\0';
+
+        // Field 22, starttime, in clock ticks after boot. The command name
+        // before it is in parentheses and may hold spaces.
+        const char *fields = std::strrchr(stat, ')');
+        unsigned long long startTicks = 0;
+        if (!fields || std::sscanf(fields + 1, " %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %*u %*u"
+                                   " %*d %*d %*d %*d %*d %*d %llu", &startTicks) != 1) {
+            return 0;
+        }
+        timespec boot;
+        const long ticksPerSecond = sysconf(_SC_CLK_TCK);
+        if (ticksPerSecond <= 0 || clock_gettime(CLOCK_BOOTTIME, &boot) != 0) return 0;
+        const std::int64_t bootNs = boot.tv_sec * 1'000'000'000LL + boot.tv_nsec;
+        const std::int64_t startNs = static_cast<std::int64_t>(startTicks * (1e9 / ticksPerSecond));
+        return std::max<std::int64_t>(0, bootNs - startNs);
+#else
+        return 0;
+#endif
+    }
+
+    std::array<std::atomic<std::int64_t>, PhaseCount> reachedNs{};
+};
+
+// Takes the process start before main() runs
+inline StartupTrace &startupTraceAtLoad = StartupTrace::instance();
+
+#endif // STARTUPTRACE_H
@@ -0,0 +1,136 @@
+#ifndef TAPE_H
+#define TAPE_H
+
+#include <QStaticText>
+#include <QString>
+#include <array>
+#include <cmath>
+
+// Layout and scale of one scrolling tape (altitude, speed, heading).
+// Offsets are in the widget's logical units along the tape axis, measured
+// from the current-value pointer.
+struct TapeConfig {
+    int step;              // Value units between ticks
+    int labelStep;         // Value units between labels (multiple of step)
+    float tickSpacing;     // Logical units between ticks
+    float halfExtent;      // Visible logical units either side of the pointer
+    float direction;       // +1: values grow along +axis, -1: toward -axis
+    int minValue;          // Linear scales: first and last tick
+    int maxValue;
+    int modulus;           // Wrapping scales (heading): 360; 0 for linear
+    QString (*labelText)(int value);  // value is already wrapped
+};
+
+// Scrolling tape that only ever touches the ticks in view.
+// setValue() works out the visible tick range directly from the value, so
+// the per-frame cost is O(visible ticks), and tick labels are cached as
+// QStaticText that is only re-created for ticks scrolling into view.
+class Tape {
+public:
+    struct Tick {
+        int value;                   // Wrapped for modular tapes
+        float offset;                // Logical units from the pointer
+        const QStaticText *label;    // nullptr between labels
+    };
+
+    static constexpr int maxTicks = 32;
+
+    explicit Tape(const TapeConfig &config)
+    : cfg(config) {
+    }
+
+    const TapeConfig &config() const { return cfg; }
+
+    void setValue(float value) {
+        const float valuePerUnit = cfg.step / cfg.tickSpacing;
+        const float reach = cfg.halfExtent * valuePerUnit;
+
+        int first = static_cast<int>(std::ceil((value - reach) / cfg.step));
+        int last = static_cast<int>(std::floor((value + reach) / cfg.step));
+        if (cfg.modulus == 0) {
+            first = qMax(first, ceilDiv(cfg.minValue, cfg.step));
+            last = qMin(last, floorDiv(cfg.maxValue, cfg.step));
+        }
+        if (last - first + 1 > maxTicks) last = first + maxTicks - 1;
+
+        if (first != firstIndex || last != lastIndex) {
+            scrollLabels(first, last);
+        }
+
+        tickCount = 0;
+        for (int index = first; index <= last; index++) {
+            Tick &tick = ticks[tickCount++];
+            tick.value = wrapped(index * cfg.step);
+            tick.offset = cfg.direction * (index * cfg.step - value) / valuePerUnit;
+            tick.label = labelFor(index);
+        }
+    }
+
+    const Tick *begin() const { return ticks.data(); }
+    const Tick *end() const { return ticks.data() + tickCount; }
+
+private:
+    struct CachedLabel {
+        int index = 0;
+        QStaticText text;
+    };
+
+    static int floorDiv(int a, int b) { return a / b - ((a % b != 0) && ((a < 0) != (b < 0))); }
+    static int ceilDiv(int a, int b) { return -floorDiv(-a, b); }
+
+    int wrapped(int value) const {
+        if (cfg.modulus == 0) return value;
+        value %= cfg.modulus;
+        return value < 0 ? value + cfg.modulus : value;
+    }
+
+    bool isLabelled(int index) const {
+        return (index * cfg.step) % cfg.labelStep == 0;
+    }
+
+    // Keep the labels still in view, create only the ones that scrolled in.
+    // The new set is built in the other buffer, whose QStaticTexts persist,
+    // so only labels scrolling into view allocate.
+    void scrollLabels(int first, int last) {
+        std::array<CachedLabel, maxTicks> &next = labelBuffers[1 - current];
+        int nextCount = 0;
+        for (int index = first; index <= last; index++) {
+            if (!isLabelled(index)) continue;
+
+            CachedLabel &entry = next[nextCount++];
+            entry.index = index;
+            const QStaticText *existing = labelFor(index);
+            if (existing) {
+                entry.text = *existing;  // Implicitly shared, no re-layout
+            } else {
+                entry.text.setText(cfg.labelText(wrapped(index * cfg.step)));
+                entry.text.setTextFormat(Qt::PlainText);
+                entry.text.setPerformanceHint(QStaticText::AggressiveCaching);
+            }
+        }
+
+        current = 1 - current;
+        labelCount = nextCount;
+        firstIndex = first;
+        lastIndex = last;
+    }
+
+    const QStaticText *labelFor(int index) const {
+        const std::array<CachedLabel, maxTicks> &labels = labelBuffers[current];
+        for (int i = 0; i < labelCount; i++) {
+            if (labels[i].index == index) return &labels[i].text;
+        }
+        return nullptr;
+    }
+
+    TapeConfig cfg;
+    std::array<Tick, maxTicks> ticks;
+    int tickCount = 0;
+    std::array<std::array<CachedLabel, maxTicks>, 2> labelBuffers;
+    int current = 0;     // labelBuffers[current] holds the labels in view
+    int labelCount = 0;
+    int firstIndex = 1;  // Empty window until the first setValue()
+    int lastIndex = 0;
+};
+
+#endif // TAPE_H
@@ -0,0 +1,136 @@
+#ifndef TELEMETRYCLIENT_H
+#define TELEMETRYCLIENT_H
+
+#include <QObject>
+#include <QLocalSocket>
+#include <QNetworkDatagram>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QUdpSocket>
+#include "framedecoder.h"
+#include "telemetryserver.h"
+#include "telemetrysample.h"
+
+// Follows a TelemetryServer instead of a serial port: the viewer side of
+// --connect. Decoded samples go into a SampleRing exactly as SerialReader's
+// do, so the display doesn't know the difference. Reconnects every
+// retryIntervalMs while the server is away.
+//
+// Lives on its own QThread; connectToServer() must run there.
+class TelemetryClient : public QObject {
+    Q_OBJECT
+
+public:
+    static constexpr int retryIntervalMs = 1000;
+
+    explicit TelemetryClient(SampleRing &ring, QObject *parent = nullptr)
+    : QObject(parent), sampleRing(ring) {
+    }
+
+    // Call before connectToServer()
+    void setEndpoint(const TelemetryEndpoint &target) { endpoint = target; }
+
+    // Link health; only meaningful on the client thread
+    const FrameDecoder &decoder() const { return frameDecoder; }
+
+public slots:
+    void connectToServer() {
+        if (!retryTimer) {
+            retryTimer = new QTimer(this);
+            retryTimer->setSingleShot(true);
+            retryTimer->setInterval(retryIntervalMs);
+            connect(retryTimer, &QTimer::timeout, this, &TelemetryClient::connectToServer);
+        }
+
+        switch (endpoint.kind) {
+        case TelemetryEndpoint::Udp: {
+            // Datagrams have no connection; bind once and wait for them
+            QUdpSocket *socket = new QUdpSocket(this);
+            const bool multicast = endpoint.address.isMulticast();
+            const QHostAddress any(endpoint.address.protocol() == QAbstractSocket::IPv6Protocol
+                                       ? QHostAddress::AnyIPv6 : QHostAddress::AnyIPv4);
+            // Several viewers on one host share the group's port
+            if (!socket->bind(multicast ? any : endpoint.address, endpoint.port,
+                              QAbstractSocket::ShareAddress | QAbstractSocket::ReuseAddressHint)
+                || (multicast && !socket->joinMulticastGroup(endpoint.address))) {
+                delete socket;
+                emit linkChanged(false);
+                retryTimer->start();
+                return;
+            }
+            connect(socket, &QUdpSocket::readyRead, this, [this, socket]() {
+                while (socket->hasPendingDatagrams()) {
+                    const QNetworkDatagram datagram = socket->receiveDatagram();
+                    const QByteArray data = datagram.data();
+                    decode(data.constData(), data.size(), monotonicNowNs());
+                }
+            });
+            emit linkChanged(true);
+            return;
+        }
+        case TelemetryEndpoint::Tcp: {
+            QTcpSocket *socket = new QTcpSocket(this);
+            socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+            follow(socket, &QTcpSocket::connected, &QTcpSocket::disconnected, &QTcpSocket::errorOccurred);
+            socket->connectToHost(endpoint.address, endpoint.port, QIODevice::ReadOnly);
+            return;
+        }
+        case TelemetryEndpoint::Local: {
+            QLocalSocket *socket = new QLocalSocket(this);
+            follow(socket, &QLocalSocket::connected, &QLocalSocket::disconnected, &QLocalSocket::errorOccurred);
+            socket->connectToServer(endpoint.name, QIODevice::ReadOnly);
+            return;
+        }
+        }
+    }
+
+signals:
+    // Connected to (or bound for) the server, or lost it
+    void linkChanged(bool up);
+
+private:
+    template <typename Socket, typename Connected, typename Disconnected, typename Error>
+    void follow(Socket *socket, Connected connected, Disconnected disconnected, Error error) {
+        connect(socket, connected, this, [this]() {
+            // A new stream starts mid-frame and with a new sequence
+            frameDecoder.reset();
+            emit linkChanged(true);
+        });
+        connect(socket, &QIODevice::readyRead, this, [this, socket]() {
+            const std::int64_t arrivedNs = monotonicNowNs();
+            for (;;) {
+                const qint64 bytesRead = socket->read(readChunk, sizeof(readChunk));
+                if (bytesRead <= 0) break;
+                decode(readChunk, bytesRead, arrivedNs);
+            }
+        });
+        // Either signal, or both, end this attempt. Queued to the socket
+        // itself, so a second one dies with it.
+        auto retry = [this, socket]() {
+            if (socket->property("retrying").toBool()) return;
+            socket->setProperty("retrying", true);
+            socket->deleteLater();
+            emit linkChanged(false);
+            retryTimer->start();
+        };
+        connect(socket, disconnected, socket, retry, Qt::QueuedConnection);
+        connect(socket, error, socket, retry, Qt::QueuedConnection);
+    }
+
+    void decode(const char *data, qint64 length, std::int64_t arrivedNs) {
+        frameDecoder.feed(reinterpret_cast<const std::uint8_t *>(data), static_cast<std::size_t>(length), arrivedNs,
+                          [this](const TelemetrySample &sample) {
+            TelemetrySample stamped = sample;
+            stamped.parsedNs = monotonicNowNs();
+            sampleRing.push(stamped);
+        });
+    }
+
+    SampleRing &sampleRing;
+    TelemetryEndpoint endpoint;
+    QTimer *retryTimer = nullptr;
+    FrameDecoder frameDecoder;
+    char readChunk[1024];
+};
+
+#endif // TELEMETRYCLIENT_H
@@ -0,0 +1,69 @@
+#ifndef TELEMETRYSAMPLE_H
+#define TELEMETRYSAMPLE_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include "firmware/horus_protocol.h"
+#include "spscring.h"
+
+// Host-only TelemetrySample::fields bit: the attitude was fused on the host
+// from the raw IMU (sensorfusion.h) rather than sent by the vehicle
+#define HORUS_FIELD_FUSED (1u << 15)
+
+// One decoded sensor sample as it leaves the ingest thread.
+// CSV lines only fill the attitude; binary frames can fill everything.
+struct TelemetrySample {
+    std::int64_t timestampNs = 0;  // Host steady clock, when the bytes arrived
+    std::int64_t parsedNs = 0;     // Host steady clock, when parsing finished
+    std::int64_t handoffNs = 0;    // Host steady clock, when the display took it
+    std::uint32_t sensorTimeMs = 0; // Sender's millis(), binary frames only
+    std::uint16_t fields = 0;      // HORUS_FIELD_* - which values below are real
+    float pitch = 0.0f;            // degrees
+    float roll = 0.0f;             // degrees
+    float yaw = 0.0f;              // degrees; a 0..360 heading when HORUS_FIELD_FUSED
+    std::int16_t accel[3] = {};    // raw LSB, HORUS_ACCEL_LSB_PER_G
+    std::int16_t gyro[3] = {};     // raw LSB, HORUS_GYRO_LSB_PER_DPS
+    float altitude = 0.0f;         // feet
+    float airspeed = 0.0f;         // knots
+    float heading = 0.0f;          // degrees
+    float batteryVolts = 0.0f;
+    float batteryLevel = 0.0f;     // 0..1
+    std::uint16_t rpm[4] = {};
+
+    bool has(std::uint16_t field) const { return (fields & field) != 0; }
+};
+
+// The binary frame that carries sample, for anything that sends samples on
+// in the vehicle's format (host-only fields are dropped)
+inline HorusTelemetry toHorusTelemetry(const TelemetrySample &sample, std::uint16_t sequence) {
+    HorusTelemetry t = {};
+    t.sequence = sequence;
+    t.sensorTimeMs = sample.sensorTimeMs;
+    t.flags = static_cast<std::uint16_t>(sample.fields & ~HORUS_FIELD_FUSED);
+    t.pitch = sample.pitch;
+    t.roll = sample.roll;
+    t.yaw = sample.yaw;
+    for (int i = 0; i < 3; i++) {
+        t.accel[i] = sample.accel[i];
+        t.gyro[i] = sample.gyro[i];
+    }
+    t.altitude = sample.altitude;
+    t.airspeed = sample.airspeed;
+    t.heading = sample.heading;
+    t.batteryVolts = sample.batteryVolts;
+    t.batteryPercent = static_cast<std::uint8_t>(std::clamp(std::lround(sample.batteryLevel * 100.0f), 0l, 255l));
+    for (int i = 0; i < 4; i++) t.rpm[i] = sample.rpm[i];
+    return t;
+}
+
+// Ingest -> display handoff (about 5 s of headroom at 50 Hz)
+using SampleRing = SpscRing<TelemetrySample, 256>;
+
+inline std::int64_t monotonicNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#endif // TELEMETRYSAMPLE_H
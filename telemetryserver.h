@@ -0,0 +1,261 @@
+#ifndef TELEMETRYSERVER_H
+#define TELEMETRYSERVER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QHostAddress>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QQueue>
+#include <QString>
+#include <QStringList>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QUdpSocket>
+#include <QUrl>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "firmware/horus_protocol.h"
+#include "telemetrysample.h"
+
+// Where a telemetry stream is served or read, as given to --serve and --connect:
+//   udp://239.255.72.79:7279   multicast group (or a unicast address) and port
+//   tcp://127.0.0.1:7280       TCP listener / server
+//   local:horus                QLocalServer name (Unix socket, named pipe on Windows)
+struct TelemetryEndpoint {
+    enum Kind { Udp, Tcp, Local };
+
+    Kind kind = Tcp;
+    QHostAddress address;
+    quint16 port = 0;
+    QString name;  // Local only
+
+    static bool parse(const QString &text, TelemetryEndpoint &endpoint, QString &error) {
+        const QUrl url(text.trimmed());
+        const QString scheme = url.scheme().toLower();
+        if (scheme == "local") {
+            endpoint.kind = Local;
+            endpoint.name = url.path();
+            if (endpoint.name.isEmpty()) {
+                error = QString("%1: missing socket name").arg(text);
+                return false;
+            }
+            return true;
+        }
+        if (scheme != "udp" && scheme != "tcp") {
+            error = QString("%1: expected udp://, tcp:// or local:").arg(text);
+            return false;
+        }
+        endpoint.kind = scheme == "udp" ? Udp : Tcp;
+        endpoint.address = QHostAddress(url.host());
+        endpoint.port = static_cast<quint16>(url.port(0));
+        if (endpoint.address.isNull() || endpoint.port == 0) {
+            error = QString("%1: expected a numeric address and a port").arg(text);
+            return false;
+        }
+        return true;
+    }
+
+    QString toString() const {
+        if (kind == Local) return "local:" + name;
+        return QString("%1://%2:%3").arg(kind == Udp ? "udp" : "tcp", address.toString()).arg(port);
+    }
+};
+
+// Republishes decoded samples to any number of displays and tools, so they
+// can follow a vehicle without owning its serial port.
+//
+// The wire format is the vehicle's own (firmware/horus_protocol.h): COBS
+// frames that end in 0x00, so a subscriber decodes the stream with the same
+// FrameDecoder as a serial link, and the sequence number counts frames the
+// subscriber lost. Each sample is encoded once into an implicitly shared
+// QByteArray that every subscriber queues by reference. UDP gets one datagram
+// per frame. A stream subscriber that falls behind keeps at most
+// maxQueuedFrames; beyond that its oldest frames are dropped, so a stalled
+// tool sees fresh data when it recovers and never holds up the others.
+//
+// Lives on its own QThread. publish() is the producer side, for one thread
+// (the serial reader); everything else runs on the server thread.
+class TelemetryServer : public QObject {
+    Q_OBJECT
+
+public:
+    static constexpr int maxQueuedFrames = 256;             // Per stream subscriber
+    static constexpr qint64 maxSocketBacklog = 16 * 1024;   // Bytes handed to a socket, not yet sent
+
+    explicit TelemetryServer(QObject *parent = nullptr)
+    : QObject(parent) {
+    }
+
+    // Call before start()
+    void addEndpoint(const TelemetryEndpoint &endpoint) { endpoints.push_back(endpoint); }
+
+    // Producer side: queues sample and wakes the server thread if it sleeps
+    void publish(const TelemetrySample &sample) {
+        samples.push(sample);
+        if (!wakeQueued.exchange(true, std::memory_order_acq_rel)) {
+            QMetaObject::invokeMethod(this, &TelemetryServer::drain, Qt::QueuedConnection);
+        }
+    }
+
+    // Any thread
+    int subscriberCount() const { return subscribers.load(std::memory_order_relaxed); }
+    std::uint64_t framesPublished() const { return published.load(std::memory_order_relaxed); }
+    std::uint64_t framesDropped() const { return dropped.load(std::memory_order_relaxed); }  // Slow subscribers
+    std::uint64_t samplesDropped() const { return samples.droppedCount(); }  // Server thread fell behind
+
+    // The frame subscribers receive for sample
+    static QByteArray encodeFrame(const TelemetrySample &sample, std::uint16_t sequence) {
+        QByteArray frame(HORUS_MAX_FRAME_SIZE, Qt::Uninitialized);
+        const std::size_t length = horusEncodeTelemetry(toHorusTelemetry(sample, sequence),
+                                                        reinterpret_cast<std::uint8_t *>(frame.data()));
+        frame.truncate(static_cast<int>(length));
+        return frame;
+    }
+
+public slots:
+    // Opens every endpoint; run on the server thread
+    void start() {
+        QStringList errors;
+        for (const TelemetryEndpoint &endpoint : endpoints) {
+            QString error;
+            if (!open(endpoint, error)) errors << endpoint.toString() + ": " + error;
+        }
+        emit started(errors.isEmpty(), errors.join("; "));
+    }
+
+signals:
+    void started(bool ok, const QString &error);
+
+private slots:
+    void drain() {
+        // Cleared first: a sample pushed from here on queues another drain
+        wakeQueued.store(false, std::memory_order_release);
+
+        TelemetrySample sample;
+        while (samples.pop(sample)) {
+            const QByteArray frame = encodeFrame(sample, sequence++);
+            for (const Datagrams &target : datagrams) {
+                target.socket->writeDatagram(frame, target.address, target.port);
+            }
+            for (const auto &subscriber : streams) enqueue(*subscriber, frame);
+            published.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    struct Datagrams {
+        QUdpSocket *socket;
+        QHostAddress address;
+        quint16 port;
+    };
+
+    struct Subscriber {
+        QIODevice *socket;
+        QQueue<QByteArray> queue;  // Shares the encoded frames
+    };
+
+    bool open(const TelemetryEndpoint &endpoint, QString &error) {
+        switch (endpoint.kind) {
+        case TelemetryEndpoint::Udp: {
+            QUdpSocket *socket = new QUdpSocket(this);
+            if (!socket->bind(QHostAddress(endpoint.address.protocol() == QAbstractSocket::IPv6Protocol
+                                               ? QHostAddress::AnyIPv6 : QHostAddress::AnyIPv4), 0)) {
+                error = socket->errorString();
+                return false;
+            }
+            if (endpoint.address.isMulticast()) {
+                // Stay on this link, and reach displays on this host too
+                socket->setSocketOption(QAbstractSocket::MulticastTtlOption, 1);
+                socket->setSocketOption(QAbstractSocket::MulticastLoopbackOption, 1);
+            }
+            datagrams.push_back({socket, endpoint.address, endpoint.port});
+            return true;
+        }
+        case TelemetryEndpoint::Tcp: {
+            QTcpServer *listener = new QTcpServer(this);
+            if (!listener->listen(endpoint.address, endpoint.port)) {
+                error = listener->errorString();
+                return false;
+            }
+            connect(listener, &QTcpServer::newConnection, this, [this, listener]() {
+                while (QTcpSocket *socket = listener->nextPendingConnection()) {
+                    socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+                    // Frames wait in our queue, where they can be dropped, not in the kernel's
+                    socket->setSocketOption(QAbstractSocket::SendBufferSizeSocketOption, static_cast<int>(maxSocketBacklog));
+                    addSubscriber(socket);
+                }
+            });
+            return true;
+        }
+        case TelemetryEndpoint::Local: {
+            QLocalServer *listener = new QLocalServer(this);
+            QLocalServer::removeServer(endpoint.name);  // A stale socket from a crashed run
+            if (!listener->listen(endpoint.name)) {
+                error = listener->errorString();
+                return false;
+            }
+            connect(listener, &QLocalServer::newConnection, this, [this, listener]() {
+                while (QLocalSocket *socket = listener->nextPendingConnection()) addSubscriber(socket);
+            });
+            return true;
+        }
+        }
+        return false;
+    }
+
+    template <typename Socket>
+    void addSubscriber(Socket *socket) {
+        auto subscriber = std::unique_ptr<Subscriber>(new Subscriber{socket, {}});
+        Subscriber *s = subscriber.get();
+        connect(socket, &QIODevice::bytesWritten, this, [this, s]() { flush(*s); });
+        // Queued: a socket can disconnect from inside write(), while drain() walks streams
+        connect(socket, &Socket::disconnected, this, [this, s]() { removeSubscriber(s); }, Qt::QueuedConnection);
+        connect(socket, &QIODevice::readyRead, socket, [socket]() { socket->readAll(); });  // Subscribers have nothing to say
+        streams.push_back(std::move(subscriber));
+        subscribers.store(static_cast<int>(streams.size()), std::memory_order_relaxed);
+    }
+
+    void removeSubscriber(Subscriber *subscriber) {
+        auto it = std::find_if(streams.begin(), streams.end(),
+                               [subscriber](const std::unique_ptr<Subscriber> &s) { return s.get() == subscriber; });
+        if (it == streams.end()) return;
+        (*it)->socket->deleteLater();
+        streams.erase(it);
+        subscribers.store(static_cast<int>(streams.size()), std::memory_order_relaxed);
+    }
+
+    void enqueue(Subscriber &subscriber, const QByteArray &frame) {
+        if (subscriber.queue.size() == maxQueuedFrames) {
+            subscriber.queue.dequeue();
+            dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+        subscriber.queue.enqueue(frame);
+        flush(subscriber);
+    }
+
+    // Hands queued frames to the socket while its backlog is small
+    void flush(Subscriber &subscriber) {
+        while (!subscriber.queue.isEmpty() && subscriber.socket->bytesToWrite() < maxSocketBacklog) {
+            subscriber.socket->write(subscriber.queue.dequeue());
+        }
+    }
+
+    std::vector<TelemetryEndpoint> endpoints;
+    std::vector<Datagrams> datagrams;
+    std::vector<std::unique_ptr<Subscriber>> streams;
+    std::uint16_t sequence = 0;
+
+    // Producer -> server thread
+    SpscRing<TelemetrySample, 1024> samples;
+    std::atomic<bool> wakeQueued{false};
+
+    std::atomic<int> subscribers{0};
+    std::atomic<std::uint64_t> published{0};
+    std::atomic<std::uint64_t> dropped{0};
+};
+
+#endif // TELEMETRYSERVER_H
@@ -0,0 +1,55 @@
+#ifndef TELEMETRYSNAPSHOT_H
+#define TELEMETRYSNAPSHOT_H
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+// Everything the PFD renders, in one place. The owner keeps one of these
+// around and updates fields in place, so a steady state tick allocates nothing.
+struct TelemetrySnapshot {
+    float pitch = 0.0f;         // degrees, nose up positive
+    float roll = 0.0f;          // degrees, right wing down positive
+    float altitude = 0.0f;      // feet
+    float speed = 0.0f;         // knots
+    float heading = 0.0f;       // degrees
+    float qnh = 29.92f;         // inHg
+    float oat = 15.0f;          // outside air temperature, deg C
+
+    // Derived per sample by AirData (airdata.h); the PFD only reads them
+    float qnhHpa = 1013.25f;    // qnh in hPa
+    float baroAltitude = 0.0f;  // feet, at the QNH set
+    float densityAltitude = 0.0f;  // feet
+    float verticalSpeed = 0.0f; // feet per minute, climb positive
+    float turnRate = 0.0f;      // degrees per second, clockwise positive
+
+    int rpm[4] = {};
+    int propQuantity = 0;       // How many of rpm[] are shown
+    float batteryVolts = 0.0f;
+    float batteryLevel = 0.0f;  // 0..1
+    std::string flightMode;
+    char clock[9] = "00:00:00"; // HH:MM:SS
+
+    // Newest real sample behind these values, for latency measurement.
+    // Host steady clock; all zero when simulated.
+    std::int64_t sampleArrivedNs = 0;
+    std::int64_t sampleHandoffNs = 0;
+    std::uint32_t sampleSensorTimeMs = 0;
+
+    // Age of the newest data once it is too old to trust, see staleAgeMs();
+    // 0 while the link is live
+    std::int32_t staleMs = 0;
+};
+
+// Data older than this is flagged on the PFD: 25 samples at 50 Hz
+constexpr std::int64_t staleAfterNs = 500'000'000;
+
+// For TelemetrySnapshot::staleMs: lastDataNs is the newest sample's arrival,
+// or when the wait for one began
+inline std::int32_t staleAgeMs(std::int64_t lastDataNs, std::int64_t nowNs) {
+    const std::int64_t age = nowNs - lastDataNs;
+    if (age <= staleAfterNs) return 0;
+    return static_cast<std::int32_t>(std::min<std::int64_t>(age / 1'000'000, 99'999'000));
+}
+
+#endif // TELEMETRYSNAPSHOT_H